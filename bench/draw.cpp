@@ -0,0 +1,720 @@
+/***********************************************************************************************
+Draw benchmark
+--------------
+Measures the CPU side of drawing each module's panel the way Rack v1 does it, for the
+original artwork in res/ and for the flattened copies in res/flat (see
+scripts/flatten_svg.py), at several zoom levels.
+
+There is no GPU or NanoVG here, so the drawing is modelled on what runs on the UI thread
+every time a panel's framebuffer is redrawn:
+
+- Rack's svgDraw: one fill and/or stroke per shape, and per sub-path of a filled shape a
+  crossing test against every other sub-path to decide between solid and hole
+- NanoVG: curves flattened to line segments at device resolution (tessTol 0.25 px), then
+  expanded to triangle vertices (fill with antialiased fringe, or stroke)
+
+Reported per module: shapes, draw calls, vertices and microseconds per panel draw.
+
+    ./draw                  # all panels, zoom 1, 2 and 4
+    ./draw -z 1.5 mv_dark   # selected panels and zoom
+
+See ./readme.md
+************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <dirent.h>
+
+/* #svg
+======================================================================================== */
+// Just the SVG subset used by the artwork in res/: groups, path, circle, ellipse, rect,
+// line, polyline, polygon and affine transforms. Like nanosvg, every segment is stored as a
+// cubic: a path is its start point followed by three points per segment.
+
+struct Path {
+    std::vector<float> pts;
+    bool closed = false;
+    float bounds[4];
+
+    int numPoints() const { return pts.size() / 2; }
+};
+
+struct Shape {
+    bool hasFill = false;
+    bool hasStroke = false;
+    float strokeWidth = 1.f;
+    std::vector<Path> paths;
+};
+
+typedef std::map<std::string, std::string> Style;
+
+struct Matrix {
+    float m[6] = { 1.f, 0.f, 0.f, 1.f, 0.f, 0.f };
+
+    Matrix multiply(const Matrix& b) const
+    {
+        Matrix r;
+        r.m[0] = m[0] * b.m[0] + m[2] * b.m[1];
+        r.m[1] = m[1] * b.m[0] + m[3] * b.m[1];
+        r.m[2] = m[0] * b.m[2] + m[2] * b.m[3];
+        r.m[3] = m[1] * b.m[2] + m[3] * b.m[3];
+        r.m[4] = m[0] * b.m[4] + m[2] * b.m[5] + m[4];
+        r.m[5] = m[1] * b.m[4] + m[3] * b.m[5] + m[5];
+        return r;
+    }
+
+    void apply(float& x, float& y) const
+    {
+        float tx = m[0] * x + m[2] * y + m[4];
+        y = m[1] * x + m[3] * y + m[5];
+        x = tx;
+    }
+
+    float averageScale() const
+    {
+        return sqrtf(fabsf(m[0] * m[3] - m[1] * m[2]));
+    }
+};
+
+static std::vector<float> parseNumbers(const std::string& text)
+{
+    std::vector<float> numbers;
+    const char* s = text.c_str();
+    while (*s) {
+        char* end;
+        float value = strtof(s, &end);
+        if (end == s) {
+            s++;
+        } else {
+            numbers.push_back(value);
+            s = end;
+        }
+    }
+    return numbers;
+}
+
+static Matrix parseTransform(const std::string& text)
+{
+    Matrix matrix;
+    size_t pos = 0;
+    while ((pos = text.find('(', pos)) != std::string::npos) {
+        size_t nameStart = text.find_last_of(" ,)", pos - 1);
+        nameStart = nameStart == std::string::npos ? 0 : nameStart + 1;
+        std::string name = text.substr(nameStart, pos - nameStart);
+        size_t close = text.find(')', pos);
+        std::vector<float> v = parseNumbers(text.substr(pos + 1, close - pos - 1));
+        Matrix step;
+        if (name == "matrix" && v.size() == 6) {
+            for (int i = 0; i < 6; i++)
+                step.m[i] = v[i];
+        } else if (name == "translate" && v.size() >= 1) {
+            step.m[4] = v[0];
+            step.m[5] = v.size() > 1 ? v[1] : 0.f;
+        } else if (name == "scale" && v.size() >= 1) {
+            step.m[0] = v[0];
+            step.m[3] = v.size() > 1 ? v[1] : v[0];
+        }
+        matrix = matrix.multiply(step);
+        pos = close;
+    }
+    return matrix;
+}
+
+struct PathBuilder {
+    std::vector<Path> paths;
+    Path current;
+    float x = 0.f, y = 0.f;
+    float startX = 0.f, startY = 0.f;
+
+    void finish()
+    {
+        if (current.numPoints() > 1) {
+            paths.push_back(current);
+        }
+        current = Path();
+    }
+
+    void moveTo(float px, float py)
+    {
+        finish();
+        current.pts.push_back(px);
+        current.pts.push_back(py);
+        x = startX = px;
+        y = startY = py;
+    }
+
+    void cubicTo(float c1x, float c1y, float c2x, float c2y, float px, float py)
+    {
+        if (current.pts.empty()) {
+            current.pts.push_back(x);
+            current.pts.push_back(y);
+        }
+        float p[6] = { c1x, c1y, c2x, c2y, px, py };
+        current.pts.insert(current.pts.end(), p, p + 6);
+        x = px;
+        y = py;
+    }
+
+    void lineTo(float px, float py)
+    {
+        cubicTo(x + (px - x) / 3.f, y + (py - y) / 3.f, px + (x - px) / 3.f, py + (y - py) / 3.f, px, py);
+    }
+
+    void close()
+    {
+        current.closed = true;
+        finish();
+        x = startX;
+        y = startY;
+    }
+};
+
+static void parsePathData(const std::string& d, PathBuilder& b)
+{
+    const char* s = d.c_str();
+    char command = 0;
+    float lastC2x = 0.f, lastC2y = 0.f;
+    bool hasLastC2 = false;
+
+    while (*s) {
+        if (isspace(*s) || *s == ',') {
+            s++;
+            continue;
+        }
+        if (isalpha(*s)) {
+            command = *s++;
+            if (command == 'z' || command == 'Z') {
+                b.close();
+                hasLastC2 = false;
+            }
+            continue;
+        }
+        bool relative = islower(command);
+        float dx = relative ? b.x : 0.f;
+        float dy = relative ? b.y : 0.f;
+        int numArgs = 0;
+        switch (toupper(command)) {
+        case 'M':
+        case 'L':
+        case 'T':
+            numArgs = 2;
+            break;
+        case 'H':
+        case 'V':
+            numArgs = 1;
+            break;
+        case 'C':
+            numArgs = 6;
+            break;
+        case 'S':
+        case 'Q':
+            numArgs = 4;
+            break;
+        default:
+            // arcs aren't used by the artwork
+            return;
+        }
+        float a[6];
+        for (int i = 0; i < numArgs; i++) {
+            char* end;
+            a[i] = strtof(s, &end);
+            if (end == s)
+                return;
+            s = end;
+            while (isspace(*s) || *s == ',')
+                s++;
+        }
+        switch (toupper(command)) {
+        case 'M':
+            b.moveTo(a[0] + dx, a[1] + dy);
+            command = relative ? 'l' : 'L';
+            hasLastC2 = false;
+            break;
+        case 'L':
+            b.lineTo(a[0] + dx, a[1] + dy);
+            hasLastC2 = false;
+            break;
+        case 'H':
+            b.lineTo(a[0] + dx, b.y);
+            hasLastC2 = false;
+            break;
+        case 'V':
+            b.lineTo(b.x, a[0] + dy);
+            hasLastC2 = false;
+            break;
+        case 'C':
+            b.cubicTo(a[0] + dx, a[1] + dy, a[2] + dx, a[3] + dy, a[4] + dx, a[5] + dy);
+            lastC2x = a[2] + dx;
+            lastC2y = a[3] + dy;
+            hasLastC2 = true;
+            break;
+        case 'S': {
+            float c1x = hasLastC2 ? 2.f * b.x - lastC2x : b.x;
+            float c1y = hasLastC2 ? 2.f * b.y - lastC2y : b.y;
+            b.cubicTo(c1x, c1y, a[0] + dx, a[1] + dy, a[2] + dx, a[3] + dy);
+            lastC2x = a[0] + dx;
+            lastC2y = a[1] + dy;
+            hasLastC2 = true;
+        } break;
+        default: {
+            // quadratic, raised to a cubic
+            float qx = a[0] + dx, qy = a[1] + dy;
+            float px = a[numArgs - 2] + dx, py = a[numArgs - 1] + dy;
+            if (toupper(command) == 'T') {
+                qx = hasLastC2 ? 2.f * b.x - lastC2x : b.x;
+                qy = hasLastC2 ? 2.f * b.y - lastC2y : b.y;
+            }
+            b.cubicTo(b.x + 2.f / 3.f * (qx - b.x), b.y + 2.f / 3.f * (qy - b.y), px + 2.f / 3.f * (qx - px), py + 2.f / 3.f * (qy - py), px, py);
+            lastC2x = qx;
+            lastC2y = qy;
+            hasLastC2 = true;
+        } break;
+        }
+    }
+}
+
+static void ellipse(PathBuilder& b, float cx, float cy, float rx, float ry)
+{
+    const float k = 0.5522847493f;
+    b.moveTo(cx + rx, cy);
+    b.cubicTo(cx + rx, cy + ry * k, cx + rx * k, cy + ry, cx, cy + ry);
+    b.cubicTo(cx - rx * k, cy + ry, cx - rx, cy + ry * k, cx - rx, cy);
+    b.cubicTo(cx - rx, cy - ry * k, cx - rx * k, cy - ry, cx, cy - ry);
+    b.cubicTo(cx + rx * k, cy - ry, cx + rx, cy - ry * k, cx + rx, cy);
+    b.close();
+}
+
+struct SvgParser {
+    std::vector<Shape> shapes;
+
+    struct Element {
+        std::string name;
+        std::map<std::string, std::string> attributes;
+        bool isClosing = false;
+        bool isSelfClosing = false;
+    };
+
+    struct State {
+        Style style;
+        Matrix matrix;
+        bool isHidden = false;
+    };
+
+    static float number(const std::map<std::string, std::string>& a, const char* name)
+    {
+        auto it = a.find(name);
+        return it == a.end() ? 0.f : strtof(it->second.c_str(), NULL);
+    }
+
+    void addShape(const Element& e, const State& state)
+    {
+        const std::map<std::string, std::string>& a = e.attributes;
+        PathBuilder b;
+        if (e.name == "path") {
+            auto it = a.find("d");
+            if (it != a.end())
+                parsePathData(it->second, b);
+        } else if (e.name == "circle") {
+            ellipse(b, number(a, "cx"), number(a, "cy"), number(a, "r"), number(a, "r"));
+        } else if (e.name == "ellipse") {
+            ellipse(b, number(a, "cx"), number(a, "cy"), number(a, "rx"), number(a, "ry"));
+        } else if (e.name == "rect") {
+            float x = number(a, "x"), y = number(a, "y"), w = number(a, "width"), h = number(a, "height");
+            b.moveTo(x, y);
+            b.lineTo(x + w, y);
+            b.lineTo(x + w, y + h);
+            b.lineTo(x, y + h);
+            b.close();
+        } else if (e.name == "line") {
+            b.moveTo(number(a, "x1"), number(a, "y1"));
+            b.lineTo(number(a, "x2"), number(a, "y2"));
+        } else if (e.name == "polyline" || e.name == "polygon") {
+            auto it = a.find("points");
+            std::vector<float> v = parseNumbers(it == a.end() ? "" : it->second);
+            for (size_t i = 0; i + 1 < v.size(); i += 2) {
+                if (i == 0)
+                    b.moveTo(v[0], v[1]);
+                else
+                    b.lineTo(v[i], v[i + 1]);
+            }
+            if (e.name == "polygon")
+                b.close();
+        } else {
+            return;
+        }
+        b.finish();
+
+        const Style& style = state.style;
+        auto get = [&](const char* name, const char* fallback) {
+            auto it = style.find(name);
+            return it == style.end() ? std::string(fallback) : it->second;
+        };
+        Shape shape;
+        shape.hasFill = get("fill", "black") != "none" && strtof(get("fill-opacity", "1").c_str(), NULL) > 0.f;
+        shape.hasStroke = get("stroke", "none") != "none" && strtof(get("stroke-opacity", "1").c_str(), NULL) > 0.f;
+        shape.strokeWidth = strtof(get("stroke-width", "1").c_str(), NULL) * state.matrix.averageScale();
+        if (get("display", "inline") == "none" || strtof(get("opacity", "1").c_str(), NULL) <= 0.f) {
+            return;
+        }
+        if (!shape.hasFill && !shape.hasStroke) {
+            return;
+        }
+
+        for (Path& path : b.paths) {
+            for (size_t i = 0; i < path.pts.size(); i += 2) {
+                state.matrix.apply(path.pts[i], path.pts[i + 1]);
+            }
+            path.bounds[0] = path.bounds[2] = path.pts[0];
+            path.bounds[1] = path.bounds[3] = path.pts[1];
+            for (size_t i = 0; i < path.pts.size(); i += 2) {
+                path.bounds[0] = std::min(path.bounds[0], path.pts[i]);
+                path.bounds[1] = std::min(path.bounds[1], path.pts[i + 1]);
+                path.bounds[2] = std::max(path.bounds[2], path.pts[i]);
+                path.bounds[3] = std::max(path.bounds[3], path.pts[i + 1]);
+            }
+            shape.paths.push_back(path);
+        }
+        if (!shape.paths.empty()) {
+            shapes.push_back(shape);
+        }
+    }
+
+    static void parseStyle(const std::map<std::string, std::string>& a, Style& style)
+    {
+        static const char* properties[] = { "fill", "fill-opacity", "stroke", "stroke-width", "stroke-opacity", "opacity", "display" };
+        for (const char* p : properties) {
+            auto it = a.find(p);
+            if (it != a.end())
+                style[p] = it->second;
+        }
+        auto it = a.find("style");
+        if (it == a.end())
+            return;
+        std::stringstream items(it->second);
+        std::string item;
+        while (std::getline(items, item, ';')) {
+            size_t colon = item.find(':');
+            if (colon == std::string::npos)
+                continue;
+            std::string name = item.substr(0, colon), value = item.substr(colon + 1);
+            name.erase(0, name.find_first_not_of(" \t\r\n"));
+            name.erase(name.find_last_not_of(" \t\r\n") + 1);
+            value.erase(0, value.find_first_not_of(" \t\r\n"));
+            value.erase(value.find_last_not_of(" \t\r\n") + 1);
+            style[name] = value;
+        }
+    }
+
+    bool parse(const std::string& text)
+    {
+        std::vector<State> stack(1);
+        size_t pos = 0;
+        while ((pos = text.find('<', pos)) != std::string::npos) {
+            if (text.compare(pos, 4, "<!--") == 0) {
+                pos = text.find("-->", pos);
+                continue;
+            }
+            if (text[pos + 1] == '?' || text[pos + 1] == '!') {
+                pos = text.find('>', pos);
+                continue;
+            }
+            Element e;
+            size_t i = pos + 1;
+            if (text[i] == '/') {
+                e.isClosing = true;
+                i++;
+            }
+            size_t nameEnd = text.find_first_of(" \t\r\n/>", i);
+            e.name = text.substr(i, nameEnd - i);
+            i = nameEnd;
+            while (i < text.size() && text[i] != '>') {
+                if (text[i] == '/') {
+                    e.isSelfClosing = true;
+                    i++;
+                    continue;
+                }
+                if (isspace(text[i])) {
+                    i++;
+                    continue;
+                }
+                size_t eq = text.find('=', i);
+                std::string name = text.substr(i, eq - i);
+                char quote = text[eq + 1];
+                size_t valueEnd = text.find(quote, eq + 2);
+                e.attributes[name] = text.substr(eq + 2, valueEnd - eq - 2);
+                i = valueEnd + 1;
+            }
+            pos = i;
+
+            if (e.isClosing) {
+                if (stack.size() > 1)
+                    stack.pop_back();
+                continue;
+            }
+
+            State state = stack.back();
+            // opacity and display aren't inherited (nested group opacity is ignored here)
+            state.style.erase("opacity");
+            state.style.erase("display");
+            parseStyle(e.attributes, state.style);
+            auto transform = e.attributes.find("transform");
+            if (transform != e.attributes.end())
+                state.matrix = state.matrix.multiply(parseTransform(transform->second));
+            bool isContainer = e.name == "svg" || e.name == "g";
+            bool isSkipped = e.name == "defs" || e.name == "clipPath" || e.name == "metadata" || e.name.find(':') != std::string::npos;
+            state.isHidden = state.isHidden || isSkipped || state.style["display"] == "none";
+
+            if (!state.isHidden && !isContainer) {
+                addShape(e, state);
+            }
+            if (!e.isSelfClosing) {
+                stack.push_back(state);
+            }
+        }
+        return !shapes.empty();
+    }
+};
+
+/* #draw
+======================================================================================== */
+// CPU work of one panel redraw, modelled on Rack v1's svgDraw and NanoVG's path stage
+
+struct DrawStats {
+    int calls = 0;
+    int holes = 0;
+    long vertices = 0;
+};
+
+struct Renderer {
+    float scale = 1.f;
+    float tessTol = 0.25f;
+    float distTol = 0.01f;
+    std::vector<float> points;
+    std::vector<float> vertices;
+
+    void addPoint(float x, float y)
+    {
+        size_t n = points.size();
+        if (n >= 2) {
+            float dx = x - points[n - 2], dy = y - points[n - 1];
+            if (dx * dx + dy * dy < distTol * distTol)
+                return;
+        }
+        points.push_back(x);
+        points.push_back(y);
+    }
+
+    // nvg__tesselateBezier
+    void tesselateBezier(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, int level)
+    {
+        if (level > 10)
+            return;
+        float dx = x4 - x1, dy = y4 - y1;
+        float d2 = fabsf((x2 - x4) * dy - (y2 - y4) * dx);
+        float d3 = fabsf((x3 - x4) * dy - (y3 - y4) * dx);
+        if ((d2 + d3) * (d2 + d3) < tessTol * (dx * dx + dy * dy)) {
+            addPoint(x4, y4);
+            return;
+        }
+        float x12 = (x1 + x2) * 0.5f, y12 = (y1 + y2) * 0.5f;
+        float x23 = (x2 + x3) * 0.5f, y23 = (y2 + y3) * 0.5f;
+        float x34 = (x3 + x4) * 0.5f, y34 = (y3 + y4) * 0.5f;
+        float x123 = (x12 + x23) * 0.5f, y123 = (y12 + y23) * 0.5f;
+        float x234 = (x23 + x34) * 0.5f, y234 = (y23 + y34) * 0.5f;
+        float x1234 = (x123 + x234) * 0.5f, y1234 = (y123 + y234) * 0.5f;
+        tesselateBezier(x1, y1, x12, y12, x123, y123, x1234, y1234, level + 1);
+        tesselateBezier(x1234, y1234, x234, y234, x34, y34, x4, y4, level + 1);
+    }
+
+    static bool linesCross(const float* a0, const float* a1, const float* b0, const float* b1)
+    {
+        float dx = a1[0] - a0[0], dy = a1[1] - a0[1];
+        float ex = b1[0] - b0[0], ey = b1[1] - b0[1];
+        float d = dx * ey - dy * ex;
+        if (fabsf(d) < 1e-9f)
+            return false;
+        float fx = b0[0] - a0[0], fy = b0[1] - a0[1];
+        float t = (fx * ey - fy * ex) / d;
+        float u = (fx * dy - fy * dx) / d;
+        return t >= 0.f && t <= 1.f && u >= 0.f && u <= 1.f;
+    }
+
+    // Rack's svgDraw: a sub-path is a hole if a line from it to just outside its bounds crosses
+    // the other sub-paths of the shape an odd number of times
+    static bool isHole(const Shape& shape, const Path& path)
+    {
+        int crossings = 0;
+        float p0[2] = { path.pts[0], path.pts[1] };
+        float p1[2] = { path.bounds[0] - 1.f, path.bounds[1] - 1.f };
+        for (const Path& other : shape.paths) {
+            if (&other == &path || other.numPoints() < 4)
+                continue;
+            for (int i = 1; i < other.numPoints(); i++) {
+                if (linesCross(p0, p1, &other.pts[2 * (i - 1)], &other.pts[2 * i]))
+                    crossings++;
+            }
+        }
+        return crossings % 2 == 1;
+    }
+
+    DrawStats draw(const std::vector<Shape>& shapes)
+    {
+        DrawStats stats;
+        vertices.clear();
+        for (const Shape& shape : shapes) {
+            points.clear();
+            for (const Path& path : shape.paths) {
+                const float* p = path.pts.data();
+                addPoint(p[0] * scale, p[1] * scale);
+                for (int i = 1; i + 2 < path.numPoints(); i += 3) {
+                    const float* c = &p[2 * (i - 1)];
+                    tesselateBezier(c[0] * scale, c[1] * scale, c[2] * scale, c[3] * scale, c[4] * scale, c[5] * scale, c[6] * scale, c[7] * scale, 0);
+                }
+                if (shape.hasFill && isHole(shape, path))
+                    stats.holes++;
+            }
+            size_t numPoints = points.size() / 2;
+            if (shape.hasFill) {
+                // fill fan plus an antialiased fringe of two vertices per point
+                for (size_t i = 0; i < numPoints; i++) {
+                    float x = points[2 * i], y = points[2 * i + 1];
+                    float v[6] = { x, y, x - 0.5f, y - 0.5f, x + 0.5f, y + 0.5f };
+                    vertices.insert(vertices.end(), v, v + 6);
+                }
+                stats.calls++;
+            }
+            if (shape.hasStroke) {
+                float w = shape.strokeWidth * scale * 0.5f;
+                for (size_t i = 0; i < numPoints; i++) {
+                    float x = points[2 * i], y = points[2 * i + 1];
+                    float v[4] = { x - w, y - w, x + w, y + w };
+                    vertices.insert(vertices.end(), v, v + 4);
+                }
+                stats.calls++;
+            }
+        }
+        stats.vertices = vertices.size() / 2;
+        return stats;
+    }
+};
+
+/* #main
+======================================================================================== */
+static bool loadShapes(const std::string& filename, std::vector<Shape>& shapes)
+{
+    std::ifstream file(filename.c_str());
+    if (!file)
+        return false;
+    std::stringstream text;
+    text << file.rdbuf();
+    SvgParser parser;
+    if (!parser.parse(text.str()))
+        return false;
+    shapes = parser.shapes;
+    return true;
+}
+
+static double drawMicroseconds(Renderer& renderer, const std::vector<Shape>& shapes, DrawStats& stats)
+{
+    // best of 5 batches of at least 5 ms each
+    double best = 1e9;
+    for (int batch = 0; batch < 5; batch++) {
+        int repeats = 0;
+        auto start = std::chrono::steady_clock::now();
+        double elapsed = 0.0;
+        while (elapsed < 0.005) {
+            stats = renderer.draw(shapes);
+            repeats++;
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        best = std::min(best, elapsed * 1e6 / repeats);
+    }
+    return best;
+}
+
+static void usage()
+{
+    printf("usage: draw [--res dir] [-z zoom]... [panel...]\n");
+}
+
+int main(int argc, char** argv)
+{
+    std::string resDir = "../res";
+    std::vector<float> zooms;
+    std::vector<std::string> names;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--res" && i + 1 < argc) {
+            resDir = argv[++i];
+        } else if (arg == "-z" && i + 1 < argc) {
+            zooms.push_back(atof(argv[++i]));
+        } else if (arg[0] == '-') {
+            usage();
+            return 2;
+        } else {
+            names.push_back(arg);
+        }
+    }
+    if (zooms.empty()) {
+        zooms = { 1.f, 2.f, 4.f };
+    }
+    if (names.empty()) {
+        DIR* dir = opendir(resDir.c_str());
+        if (!dir) {
+            fprintf(stderr, "can't open %s\n", resDir.c_str());
+            return 1;
+        }
+        while (struct dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".svg") == 0)
+                names.push_back(name.substr(0, name.size() - 4));
+        }
+        closedir(dir);
+        std::sort(names.begin(), names.end());
+    }
+
+    bool hasFlat = false;
+    Renderer renderer;
+    printf("%-22s %5s %13s %9s %17s %19s\n", "panel", "zoom", "shapes", "calls", "vertices", "us per draw");
+    double totals[2] = { 0.0, 0.0 };
+    for (const std::string& name : names) {
+        std::vector<Shape> shapes[2];
+        if (!loadShapes(resDir + "/" + name + ".svg", shapes[0])) {
+            fprintf(stderr, "can't read %s.svg\n", name.c_str());
+            continue;
+        }
+        bool flat = loadShapes(resDir + "/flat/" + name + ".svg", shapes[1]);
+        hasFlat = hasFlat || flat;
+
+        for (float zoom : zooms) {
+            renderer.scale = zoom;
+            DrawStats stats[2];
+            double us[2];
+            us[0] = drawMicroseconds(renderer, shapes[0], stats[0]);
+            totals[0] += us[0];
+            if (flat) {
+                us[1] = drawMicroseconds(renderer, shapes[1], stats[1]);
+                totals[1] += us[1];
+                printf("%-22s %5.2g %6zu -> %-4zu %4d -> %-4d %7ld -> %-7ld %8.1f -> %-8.1f\n", name.c_str(), zoom, shapes[0].size(), shapes[1].size(), stats[0].calls, stats[1].calls, stats[0].vertices, stats[1].vertices, us[0], us[1]);
+            } else {
+                printf("%-22s %5.2g %6zu %14d %15ld %17.1f\n", name.c_str(), zoom, shapes[0].size(), stats[0].calls, stats[0].vertices, us[0]);
+            }
+        }
+    }
+    if (hasFlat) {
+        printf("\ntotal: %.1f us -> %.1f us\n", totals[0], totals[1]);
+    } else {
+        printf("\ntotal: %.1f us (no flattened panels in %s/flat, run `make panels` in the repository root)\n", totals[0], resDir.c_str());
+    }
+    return 0;
+}
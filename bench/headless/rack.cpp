@@ -0,0 +1,230 @@
+// Definitions for the headless Rack stand-in (see rack.hpp)
+
+#include "rack.hpp"
+#include <stdarg.h>
+#include <fstream>
+#include <iterator>
+#include <sys/stat.h>
+
+/* #jansson
+======================================================================================== */
+// just enough json for the plugin to build and save its settings, nothing is ever parsed
+struct json_t {
+    enum Type { OBJECT, ARRAY, INTEGER, REAL, BOOLEAN, STRING } type;
+    long long integer = 0;
+    double real = 0.0;
+    bool boolean = false;
+    std::string string;
+    std::vector<std::pair<std::string, json_t*>> object;
+    std::vector<json_t*> array;
+    int refcount = 1;
+
+    json_t(Type type) : type(type) {}
+};
+
+json_t* json_object() { return new json_t(json_t::OBJECT); }
+json_t* json_array() { return new json_t(json_t::ARRAY); }
+
+json_t* json_integer(long long value)
+{
+    json_t* j = new json_t(json_t::INTEGER);
+    j->integer = value;
+    return j;
+}
+
+json_t* json_real(double value)
+{
+    json_t* j = new json_t(json_t::REAL);
+    j->real = value;
+    return j;
+}
+
+json_t* json_boolean(bool value)
+{
+    json_t* j = new json_t(json_t::BOOLEAN);
+    j->boolean = value;
+    return j;
+}
+
+json_t* json_string(const char* value)
+{
+    json_t* j = new json_t(json_t::STRING);
+    j->string = value;
+    return j;
+}
+
+json_t* json_true() { return json_boolean(true); }
+json_t* json_false() { return json_boolean(false); }
+
+void json_decref(json_t* j)
+{
+    if (!j || --j->refcount > 0) {
+        return;
+    }
+    for (auto& item : j->object) {
+        json_decref(item.second);
+    }
+    for (json_t* item : j->array) {
+        json_decref(item);
+    }
+    delete j;
+}
+
+int json_object_set_new(json_t* j, const char* key, json_t* value)
+{
+    for (auto& item : j->object) {
+        if (item.first == key) {
+            json_decref(item.second);
+            item.second = value;
+            return 0;
+        }
+    }
+    j->object.push_back(std::make_pair(std::string(key), value));
+    return 0;
+}
+
+int json_array_append_new(json_t* j, json_t* value)
+{
+    j->array.push_back(value);
+    return 0;
+}
+
+json_t* json_object_get(const json_t* j, const char* key)
+{
+    if (!j || j->type != json_t::OBJECT) {
+        return NULL;
+    }
+    for (auto& item : j->object) {
+        if (item.first == key) {
+            return item.second;
+        }
+    }
+    return NULL;
+}
+
+long long json_integer_value(const json_t* j) { return j && j->type == json_t::INTEGER ? j->integer : 0; }
+double json_real_value(const json_t* j) { return j && j->type == json_t::REAL ? j->real : 0.0; }
+double json_number_value(const json_t* j) { return j && j->type == json_t::INTEGER ? j->integer : json_real_value(j); }
+bool json_boolean_value(const json_t* j) { return j && j->type == json_t::BOOLEAN && j->boolean; }
+bool json_is_true(const json_t* j) { return json_boolean_value(j); }
+bool json_is_object(const json_t* j) { return j && j->type == json_t::OBJECT; }
+size_t json_array_size(const json_t* j) { return j && j->type == json_t::ARRAY ? j->array.size() : 0; }
+json_t* json_array_get(const json_t* j, size_t i) { return i < json_array_size(j) ? j->array[i] : NULL; }
+
+json_t* json_loadf(FILE* file, size_t flags, json_error_t* error)
+{
+    // settings files are never parsed headless, modules fall back to their defaults
+    return NULL;
+}
+
+int json_dumpf(const json_t* j, FILE* file, size_t flags)
+{
+    return fputs("{}\n", file) < 0 ? -1 : 0;
+}
+
+namespace rack {
+
+/* #string
+======================================================================================== */
+std::string string::f(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    char buffer[1024];
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    return buffer;
+}
+
+/* #dsp
+======================================================================================== */
+float dsp::VuMeter2::getBrightness(float dbMin, float dbMax)
+{
+    float db = 20.f * std::log10(v);
+    return math::clamp(math::rescale(db, dbMin, dbMax, 0.f, 1.f), 0.f, 1.f);
+}
+
+/* #context
+======================================================================================== */
+float Engine::getSampleRate() { return sampleRate; }
+float Engine::getSampleTime() { return 1.f / sampleRate; }
+
+std::shared_ptr<Svg> Window::loadSvg(const std::string& filename)
+{
+    auto it = svgCache.find(filename);
+    if (it != svgCache.end()) {
+        return it->second;
+    }
+    std::shared_ptr<Svg> svg = std::make_shared<Svg>();
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    if (file) {
+        std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        svg->size = bytes.size();
+    } else {
+        WARN("headless: failed to load %s", filename.c_str());
+    }
+    svgCache[filename] = svg;
+    svgLoads++;
+    svgBytes += svg->size;
+    return svg;
+}
+
+static Engine headlessEngine;
+static Window headlessWindow;
+static Context context = { &headlessEngine, &headlessWindow };
+
+Context* appGet()
+{
+    return &context;
+}
+
+/* #asset
+======================================================================================== */
+std::string asset::userDir = ".";
+
+std::string asset::plugin(Plugin* plugin, std::string filename)
+{
+    return plugin->path + "/" + filename;
+}
+
+std::string asset::user(std::string filename)
+{
+    return userDir + "/" + filename;
+}
+
+std::string asset::system(std::string filename)
+{
+    return filename;
+}
+
+/* #system
+======================================================================================== */
+bool system::isFile(const std::string& path)
+{
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+}
+
+/* #random
+======================================================================================== */
+float random::uniform()
+{
+    return (float)rand() / RAND_MAX;
+}
+
+uint32_t random::u32()
+{
+    return (uint32_t)rand();
+}
+
+/* #widgets
+======================================================================================== */
+void app::ModuleWidget::setPanel(std::shared_ptr<Svg> svg)
+{
+    app::SvgPanel* svgPanel = new app::SvgPanel;
+    svgPanel->setBackground(svg);
+    addChild(svgPanel);
+    panel = svgPanel;
+}
+
+} /* end namespace rack */
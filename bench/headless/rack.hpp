@@ -0,0 +1,731 @@
+// Headless stand-in for the parts of the Rack v1 API the plugin uses, so the modules can be
+// built and driven by the benchmarks without Rack, a window or an audio device. Names and
+// behaviour follow Rack v1 closely enough for the dsp and the widget constructors; drawing,
+// events and the patch format are not implemented. Definitions are in rack.cpp.
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <x86intrin.h>
+
+// ---- jansson ----
+struct json_t;
+struct json_error_t { int line; char text[160]; };
+#define JSON_INDENT(n) ((n) & 0x1F)
+#define JSON_REAL_PRECISION(n) (((n) & 0x1F) << 11)
+json_t* json_object();
+json_t* json_array();
+json_t* json_integer(long long);
+json_t* json_real(double);
+json_t* json_boolean(bool);
+json_t* json_string(const char*);
+json_t* json_true();
+json_t* json_false();
+int json_object_set_new(json_t*, const char*, json_t*);
+int json_array_append_new(json_t*, json_t*);
+json_t* json_object_get(const json_t*, const char*);
+long long json_integer_value(const json_t*);
+double json_real_value(const json_t*);
+double json_number_value(const json_t*);
+bool json_boolean_value(const json_t*);
+bool json_is_true(const json_t*);
+bool json_is_object(const json_t*);
+void json_decref(json_t*);
+json_t* json_loadf(FILE*, size_t, json_error_t*);
+int json_dumpf(const json_t*, FILE*, size_t);
+char* json_dumps(const json_t*, size_t);
+json_t* json_deep_copy(const json_t*);
+size_t json_array_size(const json_t*);
+json_t* json_array_get(const json_t*, size_t);
+
+#define INFO(format, ...) fprintf(stderr, "[info] " format "\n", ##__VA_ARGS__)
+#define WARN(format, ...) fprintf(stderr, "[warn] " format "\n", ##__VA_ARGS__)
+#define DEBUG(format, ...) fprintf(stderr, "[debug] " format "\n", ##__VA_ARGS__)
+
+#define RACK_GRID_WIDTH 15
+#define RACK_GRID_HEIGHT 380
+#define CHECKMARK_STRING "✔"
+#define CHECKMARK(_cond) ((_cond) ? CHECKMARK_STRING : "")
+#define RIGHT_ARROW "▸"
+#define PORT_MAX_CHANNELS 16
+#define ENUMS(name, count) name, name##_LAST = name + (count)-1
+
+namespace rack {
+
+namespace string {
+std::string f(const char* format, ...);
+}
+
+namespace math {
+inline float clamp(float x, float a, float b) { return std::fmax(std::fmin(x, b), a); }
+inline int clamp(int x, int a, int b) { return std::max(std::min(x, b), a); }
+inline float rescale(float x, float a, float b, float yMin, float yMax) { return yMin + (x - a) / (b - a) * (yMax - yMin); }
+struct Vec {
+    float x = 0, y = 0;
+    Vec() {}
+    Vec(float x, float y) : x(x), y(y) {}
+    Vec plus(Vec b) const { return Vec(x + b.x, y + b.y); }
+    Vec minus(Vec b) const { return Vec(x - b.x, y - b.y); }
+    Vec mult(float s) const { return Vec(x * s, y * s); }
+};
+struct Rect {
+    Vec pos, size;
+};
+}
+using namespace math;
+
+namespace simd {
+template <typename T, int N>
+struct Vector;
+
+template <>
+struct Vector<int32_t, 4>;
+
+template <>
+struct Vector<float, 4> {
+    using type = float;
+    constexpr static int size = 4;
+    union {
+        __m128 v;
+        float s[4];
+    };
+    Vector() = default;
+    Vector(__m128 v) : v(v) {}
+    Vector(float x) { v = _mm_set1_ps(x); }
+    Vector(float x1, float x2, float x3, float x4) { v = _mm_setr_ps(x1, x2, x3, x4); }
+    static Vector zero() { return Vector(_mm_setzero_ps()); }
+    static Vector mask() { return Vector(_mm_castsi128_ps(_mm_set1_epi32(-1))); }
+    static Vector load(const float* x) { return Vector(_mm_loadu_ps(x)); }
+    void store(float* x) { _mm_storeu_ps(x, v); }
+    float& operator[](int i) { return s[i]; }
+    const float& operator[](int i) const { return s[i]; }
+    static Vector cast(Vector<int32_t, 4> a);
+    Vector(Vector<int32_t, 4> a);
+};
+
+template <>
+struct Vector<int32_t, 4> {
+    using type = int32_t;
+    constexpr static int size = 4;
+    union {
+        __m128i v;
+        int32_t s[4];
+    };
+    Vector() = default;
+    Vector(__m128i v) : v(v) {}
+    Vector(int32_t x) { v = _mm_set1_epi32(x); }
+    Vector(int32_t x1, int32_t x2, int32_t x3, int32_t x4) { v = _mm_setr_epi32(x1, x2, x3, x4); }
+    static Vector zero() { return Vector(_mm_setzero_si128()); }
+    static Vector load(const int32_t* x) { return Vector(_mm_loadu_si128((const __m128i*)x)); }
+    void store(int32_t* x) { _mm_storeu_si128((__m128i*)x, v); }
+    int32_t& operator[](int i) { return s[i]; }
+    const int32_t& operator[](int i) const { return s[i]; }
+    static Vector cast(Vector<float, 4> a) { return Vector(_mm_castps_si128(a.v)); }
+    Vector(Vector<float, 4> a) { v = _mm_cvttps_epi32(a.v); }
+};
+inline Vector<float, 4> Vector<float, 4>::cast(Vector<int32_t, 4> a) { return Vector(_mm_castsi128_ps(a.v)); }
+inline Vector<float, 4>::Vector(Vector<int32_t, 4> a) { v = _mm_cvtepi32_ps(a.v); }
+
+typedef Vector<float, 4> float_4;
+typedef Vector<int32_t, 4> int32_4;
+
+#define DECLARE_OP(op, fn)                                                                      \
+    inline float_4 operator op(const float_4& a, const float_4& b) { return float_4(fn(a.v, b.v)); } \
+    inline float_4& operator op##=(float_4& a, const float_4& b) { a = a op b; return a; }
+DECLARE_OP(+, _mm_add_ps)
+DECLARE_OP(-, _mm_sub_ps)
+DECLARE_OP(*, _mm_mul_ps)
+DECLARE_OP(/, _mm_div_ps)
+DECLARE_OP(&, _mm_and_ps)
+DECLARE_OP(|, _mm_or_ps)
+DECLARE_OP(^, _mm_xor_ps)
+#undef DECLARE_OP
+inline float_4 operator+(const float_4& a, float b) { return a + float_4(b); }
+inline float_4 operator-(const float_4& a, float b) { return a - float_4(b); }
+inline float_4 operator*(const float_4& a, float b) { return a * float_4(b); }
+inline float_4 operator/(const float_4& a, float b) { return a / float_4(b); }
+inline float_4 operator+(float a, const float_4& b) { return float_4(a) + b; }
+inline float_4 operator-(float a, const float_4& b) { return float_4(a) - b; }
+inline float_4 operator*(float a, const float_4& b) { return float_4(a) * b; }
+inline float_4 operator/(float a, const float_4& b) { return float_4(a) / b; }
+inline float_4 operator-(const float_4& a) { return 0.f - a; }
+inline float_4 operator~(const float_4& a) { return a ^ float_4::mask(); }
+inline float_4 operator==(const float_4& a, const float_4& b) { return float_4(_mm_cmpeq_ps(a.v, b.v)); }
+inline float_4 operator!=(const float_4& a, const float_4& b) { return float_4(_mm_cmpneq_ps(a.v, b.v)); }
+inline float_4 operator<(const float_4& a, const float_4& b) { return float_4(_mm_cmplt_ps(a.v, b.v)); }
+inline float_4 operator>(const float_4& a, const float_4& b) { return float_4(_mm_cmpgt_ps(a.v, b.v)); }
+inline float_4 operator<=(const float_4& a, const float_4& b) { return float_4(_mm_cmple_ps(a.v, b.v)); }
+inline float_4 operator>=(const float_4& a, const float_4& b) { return float_4(_mm_cmpge_ps(a.v, b.v)); }
+
+inline int32_4 operator+(const int32_4& a, const int32_4& b) { return int32_4(_mm_add_epi32(a.v, b.v)); }
+inline int32_4 operator-(const int32_4& a, const int32_4& b) { return int32_4(_mm_sub_epi32(a.v, b.v)); }
+inline int32_4 operator&(const int32_4& a, const int32_4& b) { return int32_4(_mm_and_si128(a.v, b.v)); }
+inline int32_4 operator|(const int32_4& a, const int32_4& b) { return int32_4(_mm_or_si128(a.v, b.v)); }
+inline int32_4 operator^(const int32_4& a, const int32_4& b) { return int32_4(_mm_xor_si128(a.v, b.v)); }
+inline int32_4 operator<<(const int32_4& a, const int& b) { return int32_4(_mm_sll_epi32(a.v, _mm_cvtsi32_si128(b))); }
+inline int32_4 operator>>(const int32_4& a, const int& b) { return int32_4(_mm_srl_epi32(a.v, _mm_cvtsi32_si128(b))); }
+inline int32_4& operator+=(int32_4& a, const int32_4& b) { return a = a + b; }
+inline int32_4& operator^=(int32_4& a, const int32_4& b) { return a = a ^ b; }
+
+inline float_4 ifelse(float_4 mask, float_4 a, float_4 b) { return (mask & a) | float_4(_mm_andnot_ps(mask.v, b.v)); }
+inline float ifelse(bool cond, float a, float b) { return cond ? a : b; }
+inline float_4 fmax(float_4 a, float_4 b) { return float_4(_mm_max_ps(a.v, b.v)); }
+inline float_4 fmin(float_4 a, float_4 b) { return float_4(_mm_min_ps(a.v, b.v)); }
+inline float_4 sqrt(float_4 a) { return float_4(_mm_sqrt_ps(a.v)); }
+inline float_4 fabs(float_4 a) { return a & float_4::cast(int32_4(0x7fffffff)); }
+inline float_4 clamp(float_4 x, float_4 a, float_4 b) { return fmin(fmax(x, a), b); }
+inline float_4 floor(float_4 a) { return float_4(_mm_floor_ps(a.v)); }
+inline float_4 round(float_4 a) { return float_4(_mm_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT)); }
+inline float_4 trunc(float_4 a) { return float_4(_mm_round_ps(a.v, _MM_FROUND_TO_ZERO)); }
+// polynomial, as in Rack (sse_mathfun's sin_ps with the Cephes coefficients)
+inline float_4 sin(float_4 x)
+{
+    float_4 sign = x & -0.f;
+    x = fabs(x);
+    // octant, rounded up to even: j & 4 flips the sign, j & 2 picks the cosine polynomial
+    int32_4 j = int32_4(x * 1.27323954473516f);
+    j = (j + int32_4(1)) & int32_4(~1);
+    float_4 y = float_4(j);
+    sign = sign ^ float_4::cast((j & int32_4(4)) << 29);
+    float_4 isSinPoly = float_4::cast(int32_4(_mm_cmpeq_epi32((j & int32_4(2)).v, _mm_setzero_si128())));
+    x = ((x - y * 0.78515625f) - y * 2.4187564849853515625e-4f) - y * 3.77489497744594108e-8f;
+    float_4 z = x * x;
+    float_4 cosPoly = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z - 0.5f * z + 1.f;
+    float_4 sinPoly = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * x + x;
+    return ifelse(isSinPoly, sinPoly, cosPoly) ^ sign;
+}
+inline float_4 cos(float_4 a) { return float_4(std::cos(a[0]), std::cos(a[1]), std::cos(a[2]), std::cos(a[3])); }
+inline float_4 exp(float_4 a) { return float_4(std::exp(a[0]), std::exp(a[1]), std::exp(a[2]), std::exp(a[3])); }
+inline float_4 pow(float_4 a, float_4 b) { return float_4(std::pow(a[0], b[0]), std::pow(a[1], b[1]), std::pow(a[2], b[2]), std::pow(a[3], b[3])); }
+inline float_4 pow(float_4 a, float b) { return pow(a, float_4(b)); }
+inline float_4 sgn(float_4 x) { float_4 signbit = x & -0.f; float_4 nonzero = (x != 0.f); return signbit | (nonzero & 1.f); }
+inline int movemask(float_4 a) { return _mm_movemask_ps(a.v); }
+inline float_4 rcp(float_4 a) { return float_4(_mm_rcp_ps(a.v)); }
+inline float_4 rsqrt(float_4 a) { return float_4(_mm_rsqrt_ps(a.v)); }
+inline float_4 crossfade(float_4 a, float_4 b, float_4 p) { return a + (b - a) * p; }
+}
+
+namespace dsp {
+struct VuMeter2 {
+    enum Mode { AVERAGE, PEAK, RMS };
+    Mode mode = PEAK;
+    float v = 0.f;
+    float lambda = 30.f;
+    void reset() { v = 0.f; }
+    void process(float deltaTime, float value)
+    {
+        if (mode == AVERAGE) {
+            value = std::fabs(value);
+            v += (value - v) * lambda * deltaTime;
+        } else if (mode == RMS) {
+            value = value * value;
+            v += (value - v) * lambda * deltaTime;
+        } else {
+            value = std::fabs(value);
+            if (value >= v)
+                v = value;
+            else
+                v += (value - v) * lambda * deltaTime;
+        }
+    }
+    float getBrightness(float dbMin, float dbMax);
+};
+struct ClockDivider {
+    uint32_t clock = 0;
+    uint32_t division = 1;
+    void reset() { clock = 0; }
+    void setDivision(uint32_t d) { division = d; }
+    uint32_t getDivision() { return division; }
+    uint32_t getClock() { return clock; }
+    bool process()
+    {
+        clock++;
+        if (clock >= division) {
+            clock = 0;
+            return true;
+        }
+        return false;
+    }
+};
+struct PulseGenerator {
+    float remaining = 0.f;
+    void reset() { remaining = 0.f; }
+    bool process(float deltaTime)
+    {
+        if (remaining > 0.f) {
+            remaining -= deltaTime;
+            return true;
+        }
+        return false;
+    }
+    void trigger(float duration = 1e-3f)
+    {
+        if (duration > remaining)
+            remaining = duration;
+    }
+};
+}
+
+namespace event {
+struct Action {};
+struct Change {};
+}
+
+struct Plugin;
+struct Model;
+
+namespace engine {
+struct Param {
+    float value = 0.f;
+    float getValue() { return value; }
+    void setValue(float v) { value = v; }
+};
+struct Light {
+    float value = 0.f;
+    void setBrightness(float b) { value = b; }
+    float getBrightness() { return value; }
+    void setSmoothBrightness(float b, float dt) { value += (b - value) * std::fmin(dt * 60.f, 1.f); }
+};
+struct Port {
+    union {
+        float voltages[PORT_MAX_CHANNELS] = {};
+        float value;
+    };
+    union {
+        uint8_t channels = 0;
+        uint8_t active;
+    };
+    void setVoltage(float voltage, int channel = 0) { voltages[channel] = voltage; }
+    float getVoltage(int channel = 0) { return voltages[channel]; }
+    float getPolyVoltage(int channel) { return isMonophonic() ? getVoltage(0) : getVoltage(channel); }
+    float getNormalVoltage(float n, int channel = 0) { return isConnected() ? getVoltage(channel) : n; }
+    float getNormalPolyVoltage(float n, int channel) { return isConnected() ? getPolyVoltage(channel) : n; }
+    float* getVoltages(int firstChannel = 0) { return &voltages[firstChannel]; }
+    void readVoltages(float* v)
+    {
+        for (int c = 0; c < channels; c++)
+            v[c] = voltages[c];
+    }
+    void writeVoltages(const float* v)
+    {
+        for (int c = 0; c < channels; c++)
+            voltages[c] = v[c];
+    }
+    void clearVoltages()
+    {
+        for (int c = 0; c < channels; c++)
+            voltages[c] = 0.f;
+    }
+    float getVoltageSum()
+    {
+        float sum = 0.f;
+        for (int c = 0; c < channels; c++)
+            sum += voltages[c];
+        return sum;
+    }
+    template <typename T>
+    T getVoltageSimd(int firstChannel) { return T::load(&voltages[firstChannel]); }
+    template <typename T>
+    T getPolyVoltageSimd(int firstChannel) { return isMonophonic() ? getVoltage(0) : getVoltageSimd<T>(firstChannel); }
+    template <typename T>
+    void setVoltageSimd(T voltage, int firstChannel) { voltage.store(&voltages[firstChannel]); }
+    void setChannels(int c)
+    {
+        if (channels == 0)
+            return;
+        for (int cc = c; cc < channels; cc++)
+            voltages[cc] = 0.f;
+        if (c == 0)
+            c = 1;
+        channels = c;
+    }
+    int getChannels() { return channels; }
+    bool isConnected() { return channels > 0; }
+    bool isMonophonic() { return channels == 1; }
+    bool isPolyphonic() { return channels > 1; }
+};
+struct Output : Port {};
+struct Input : Port {};
+
+struct ParamQuantity {
+    virtual ~ParamQuantity() {}
+    virtual std::string getDisplayValueString() { return ""; }
+    float getValue() { return 0.f; }
+    float minValue = 0.f;
+    float maxValue = 1.f;
+    float defaultValue = 0.f;
+    std::string label, unit;
+};
+
+struct Module {
+    Model* model = NULL;
+    int64_t id = -1;
+    std::vector<Param> params;
+    std::vector<Input> inputs;
+    std::vector<Output> outputs;
+    std::vector<Light> lights;
+    std::vector<ParamQuantity*> paramQuantities;
+    struct Expander {
+        int64_t moduleId = -1;
+        Module* module = NULL;
+        void* producerMessage = NULL;
+        void* consumerMessage = NULL;
+        bool messageFlipRequested = false;
+    };
+    Expander leftExpander;
+    Expander rightExpander;
+    float cpuTime = 0.f;
+    bool bypass = false;
+
+    Module() {}
+    virtual ~Module()
+    {
+        for (ParamQuantity* paramQuantity : paramQuantities)
+            delete paramQuantity;
+    }
+    void config(int numParams, int numInputs, int numOutputs, int numLights = 0)
+    {
+        params.resize(numParams);
+        inputs.resize(numInputs);
+        outputs.resize(numOutputs);
+        lights.resize(numLights);
+        paramQuantities.resize(numParams);
+    }
+    template <class TParamQuantity = ParamQuantity>
+    void configParam(int paramId, float minValue, float maxValue, float defaultValue, std::string label = "", std::string unit = "", float displayBase = 0.f, float displayMultiplier = 1.f, float displayOffset = 0.f)
+    {
+        params[paramId].value = defaultValue;
+        delete paramQuantities[paramId];
+        ParamQuantity* q = new TParamQuantity;
+        q->minValue = minValue;
+        q->maxValue = maxValue;
+        q->defaultValue = defaultValue;
+        q->label = label;
+        q->unit = unit;
+        paramQuantities[paramId] = q;
+    }
+    struct ProcessArgs {
+        float sampleRate;
+        float sampleTime;
+    };
+    virtual void process(const ProcessArgs& args) {}
+    virtual void step() {}
+    virtual json_t* dataToJson() { return NULL; }
+    virtual void dataFromJson(json_t* rootJ) {}
+    virtual void onAdd() {}
+    virtual void onRemove() {}
+    virtual void onReset() {}
+    virtual void onRandomize() {}
+    virtual void onSampleRateChange() {}
+};
+}
+using namespace engine;
+
+namespace window {
+struct Svg {
+    void* handle = NULL;
+    size_t size = 0; // bytes read from the file, the headless loader doesn't parse it
+};
+}
+using window::Svg;
+
+struct Engine {
+    float sampleRate = 48000.f;
+    float getSampleRate();
+    float getSampleTime();
+};
+// like Rack, each file is read once and then served from a cache
+struct Window {
+    std::map<std::string, std::shared_ptr<Svg>> svgCache;
+    size_t svgLoads = 0;
+    size_t svgBytes = 0;
+    std::shared_ptr<Svg> loadSvg(const std::string& filename);
+};
+struct Context {
+    Engine* engine;
+    Window* window;
+};
+Context* appGet();
+#define APP rack::appGet()
+
+namespace asset {
+// headless only: where asset::user() points, set by the harness
+extern std::string userDir;
+std::string plugin(Plugin* plugin, std::string filename);
+std::string user(std::string filename);
+std::string system(std::string filename);
+}
+
+namespace system {
+bool isFile(const std::string& path);
+}
+
+namespace random {
+float uniform();
+uint32_t u32();
+}
+
+namespace widget {
+struct Widget {
+    math::Rect box;
+    Widget* parent = NULL;
+    std::vector<Widget*> children;
+    bool visible = true;
+    virtual ~Widget()
+    {
+        for (Widget* child : children)
+            delete child;
+    }
+    void addChild(Widget* child) { children.push_back(child); }
+    void removeChild(Widget* child) {}
+    virtual void step() {}
+    struct DrawArgs {
+        void* vg;
+        math::Rect clipBox;
+        void* fb = NULL;
+    };
+    virtual void draw(const DrawArgs& args) {}
+    virtual void onAction(const event::Action& e) {}
+    void show() { visible = true; }
+    void hide() { visible = false; }
+};
+struct TransparentWidget : Widget {};
+struct OpaqueWidget : Widget {};
+struct FramebufferWidget : Widget {
+    bool dirty = true;
+};
+struct SvgWidget : Widget {
+    std::shared_ptr<Svg> svg;
+    void setSvg(std::shared_ptr<Svg> svg) { this->svg = svg; }
+};
+}
+using namespace widget;
+
+namespace ui {
+struct MenuEntry : OpaqueWidget {};
+struct Menu;
+struct MenuItem : MenuEntry {
+    std::string text;
+    std::string rightText;
+    bool disabled = false;
+    virtual Menu* createChildMenu() { return NULL; }
+};
+struct MenuLabel : MenuEntry {
+    std::string text;
+};
+struct MenuSeparator : MenuEntry {};
+struct Menu : OpaqueWidget {};
+struct Label : Widget {
+    std::string text;
+};
+}
+using namespace ui;
+
+namespace app {
+struct ModuleWidget;
+struct SvgPanel : FramebufferWidget {
+    void setBackground(std::shared_ptr<Svg> svg) {}
+};
+struct CircularShadow : TransparentWidget {
+    float blurRadius = 0, opacity = 0.15;
+};
+struct ParamWidget : OpaqueWidget {
+    int paramId = 0;
+    ParamQuantity* paramQuantity = NULL;
+};
+struct Knob : ParamWidget {
+    bool horizontal = false;
+    bool snap = false;
+    float speed = 1.f;
+};
+struct SvgKnob : Knob {
+    CircularShadow* shadow = new CircularShadow;
+    SvgKnob() { addChild(shadow); }
+    float minAngle = 0.f, maxAngle = M_PI;
+    void setSvg(std::shared_ptr<Svg> svg) {}
+};
+struct Switch : ParamWidget {
+    bool momentary = false;
+};
+struct SvgSwitch : Switch {
+    CircularShadow* shadow = new CircularShadow;
+    SvgSwitch() { addChild(shadow); }
+    std::vector<std::shared_ptr<Svg>> frames;
+    void addFrame(std::shared_ptr<Svg> svg) { frames.push_back(svg); }
+};
+struct SvgScrew : Widget {
+    void setSvg(std::shared_ptr<Svg> svg) {}
+};
+struct PortWidget : OpaqueWidget {
+    Module* module = NULL;
+    int type = 0;
+    int portId = 0;
+};
+struct SvgPort : PortWidget {
+    CircularShadow* shadow = new CircularShadow;
+    SvgPort() { addChild(shadow); }
+    void setSvg(std::shared_ptr<Svg> svg) {}
+};
+struct LightWidget : TransparentWidget {};
+struct ModuleLightWidget : LightWidget {
+    Module* module = NULL;
+    int firstLightId = 0;
+    void addBaseColor(int) {}
+};
+struct ModuleWidget : OpaqueWidget {
+    Model* model = NULL;
+    Widget* panel = NULL;
+    Module* module = NULL;
+    void setModule(Module* m) { module = m; }
+    void setPanel(std::shared_ptr<Svg> svg);
+    void addParam(ParamWidget* w) { addChild(w); }
+    void addInput(PortWidget* w) { addChild(w); }
+    void addOutput(PortWidget* w) { addChild(w); }
+    virtual void appendContextMenu(Menu* menu) {}
+};
+}
+using namespace app;
+
+namespace componentlibrary {
+struct ScrewBlack : app::SvgScrew {};
+struct ScrewSilver : app::SvgScrew {};
+struct SmallLight_ : ModuleLightWidget {};
+template <typename T>
+struct SmallLight : ModuleLightWidget {};
+template <typename T>
+struct MediumLight : ModuleLightWidget {};
+template <typename T>
+struct TinyLight : ModuleLightWidget {};
+struct GrayModuleLightWidget : ModuleLightWidget {};
+struct GreenLight : GrayModuleLightWidget {};
+struct RedLight : GrayModuleLightWidget {};
+struct YellowLight : GrayModuleLightWidget {};
+struct BlueLight : GrayModuleLightWidget {};
+struct GreenRedLight : GrayModuleLightWidget {};
+struct WhiteLight : GrayModuleLightWidget {};
+}
+using namespace componentlibrary;
+
+template <class TWidget>
+TWidget* createWidget(math::Vec pos)
+{
+    TWidget* o = new TWidget;
+    o->box.pos = pos;
+    return o;
+}
+template <class TWidget>
+TWidget* createWidgetCentered(math::Vec pos) { return createWidget<TWidget>(pos); }
+template <class TParamWidget>
+TParamWidget* createParam(math::Vec pos, engine::Module* module, int paramId)
+{
+    TParamWidget* o = new TParamWidget;
+    o->box.pos = pos;
+    o->paramId = paramId;
+    return o;
+}
+template <class TParamWidget>
+TParamWidget* createParamCentered(math::Vec pos, engine::Module* module, int paramId) { return createParam<TParamWidget>(pos, module, paramId); }
+template <class TPortWidget>
+TPortWidget* createInput(math::Vec pos, engine::Module* module, int inputId)
+{
+    TPortWidget* o = new TPortWidget;
+    o->box.pos = pos;
+    o->module = module;
+    o->portId = inputId;
+    return o;
+}
+template <class TPortWidget>
+TPortWidget* createInputCentered(math::Vec pos, engine::Module* module, int inputId) { return createInput<TPortWidget>(pos, module, inputId); }
+template <class TPortWidget>
+TPortWidget* createOutput(math::Vec pos, engine::Module* module, int outputId) { return createInput<TPortWidget>(pos, module, outputId); }
+template <class TPortWidget>
+TPortWidget* createOutputCentered(math::Vec pos, engine::Module* module, int outputId) { return createInput<TPortWidget>(pos, module, outputId); }
+template <class TModuleLightWidget>
+TModuleLightWidget* createLight(math::Vec pos, engine::Module* module, int firstLightId)
+{
+    TModuleLightWidget* o = new TModuleLightWidget;
+    o->box.pos = pos;
+    o->module = module;
+    o->firstLightId = firstLightId;
+    return o;
+}
+template <class TModuleLightWidget>
+TModuleLightWidget* createLightCentered(math::Vec pos, engine::Module* module, int firstLightId) { return createLight<TModuleLightWidget>(pos, module, firstLightId); }
+template <class TMenuItem = ui::MenuItem>
+TMenuItem* createMenuItem(std::string text, std::string rightText = "")
+{
+    TMenuItem* o = new TMenuItem;
+    o->text = text;
+    o->rightText = rightText;
+    return o;
+}
+inline ui::MenuLabel* createMenuLabel(std::string text)
+{
+    ui::MenuLabel* o = new ui::MenuLabel;
+    o->text = text;
+    return o;
+}
+
+struct Model {
+    Plugin* plugin = NULL;
+    std::string slug;
+    virtual ~Model() {}
+    virtual engine::Module* createModule() { return NULL; }
+    virtual app::ModuleWidget* createModuleWidget() { return NULL; }
+    virtual app::ModuleWidget* createModuleWidgetNull() { return NULL; }
+};
+template <class TModule, class TModuleWidget>
+Model* createModel(std::string slug)
+{
+    struct TModel : Model {
+        engine::Module* createModule() override
+        {
+            TModule* m = new TModule;
+            m->model = this;
+            return m;
+        }
+        app::ModuleWidget* createModuleWidget() override
+        {
+            TModule* m = new TModule;
+            m->model = this;
+            TModuleWidget* mw = new TModuleWidget(m);
+            mw->model = this;
+            return mw;
+        }
+        app::ModuleWidget* createModuleWidgetNull() override
+        {
+            TModuleWidget* mw = new TModuleWidget(NULL);
+            mw->model = this;
+            return mw;
+        }
+    };
+    TModel* o = new TModel;
+    o->slug = slug;
+    return o;
+}
+
+struct Plugin {
+    std::vector<Model*> models;
+    std::string path;
+    void addModel(Model* model)
+    {
+        model->plugin = this;
+        models.push_back(model);
+    }
+};
+
+}
+
+using namespace rack;
+
+// defined by the plugin
+extern "C" void init(rack::Plugin* plugin);
@@ -0,0 +1,356 @@
+/***********************************************************************************************
+Load test
+---------
+How many instances of one module, in one configuration, fit in real time? Instances are
+added until the 99.9th percentile of the block time exceeds the budget (by default the
+whole block period, 64 samples at 48 kHz = 1333 us), once on a single thread and once with
+N threads.
+
+The engine is modelled on Rack v1's: every sample, the threads take modules off a shared
+counter and process them, then meet at a spinning barrier before the next sample. Each
+instance has all its inputs fed with a test signal (as cables would) and its outputs
+connected.
+
+    ./loadtest tape                                   # 16 voices, high quality
+    ./loadtest reseq --voices 16 --quality eco --threads 4
+    ./loadtest chorus --block 128 --budget 80 --csv capacity.csv
+
+See ./readme.md
+************************************************************************************************/
+
+#include <rack.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+struct Config {
+    int quality = 1;
+    int voices = 16;
+    int oversampling = 1;
+    float sampleRate = 48000.f;
+    int blockSize = 64;
+    double seconds = 3.0; // audio per trial
+    double budget = 1.0; // share of the block period
+};
+
+struct Trial {
+    int numInstances;
+    double p999Us; // 99.9th percentile block time
+    double meanUs;
+};
+
+static double now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* #engine
+======================================================================================== */
+// like Rack v1's HybridBarrier: the last thread to arrive releases the others, which spin for
+// a while and then yield, so more threads than cores still make progress
+struct SpinBarrier {
+    std::atomic<int> count{ 0 };
+    std::atomic<int> generation{ 0 };
+    int total = 1;
+
+    void wait()
+    {
+        int g = generation.load(std::memory_order_acquire);
+        if (count.fetch_add(1, std::memory_order_acq_rel) + 1 == total) {
+            count.store(0, std::memory_order_relaxed);
+            generation.fetch_add(1, std::memory_order_release);
+            return;
+        }
+        for (int spins = 0; generation.load(std::memory_order_acquire) == g; spins++) {
+            if (spins > 10000) {
+                std::this_thread::yield();
+            }
+        }
+    }
+};
+
+struct TestEngine {
+    std::vector<Module*> modules;
+    std::vector<std::thread> workers;
+    SpinBarrier startBarrier;
+    SpinBarrier doneBarrier;
+    std::atomic<int> nextModule{ 0 };
+    std::atomic<bool> isRunning{ true };
+    Module::ProcessArgs args;
+    const float* signal = NULL; // one sample per voice
+    int voices = 1;
+
+    TestEngine(int numThreads, const Config& config)
+    {
+        args.sampleRate = config.sampleRate;
+        args.sampleTime = 1.f / config.sampleRate;
+        voices = config.voices;
+        startBarrier.total = doneBarrier.total = numThreads;
+        for (int i = 1; i < numThreads; i++) {
+            workers.push_back(std::thread([this] {
+                while (true) {
+                    startBarrier.wait();
+                    if (!isRunning) {
+                        break;
+                    }
+                    stepModules();
+                    doneBarrier.wait();
+                }
+            }));
+        }
+    }
+
+    ~TestEngine()
+    {
+        isRunning = false;
+        startBarrier.wait();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void stepModules()
+    {
+        while (true) {
+            int i = nextModule.fetch_add(1, std::memory_order_relaxed);
+            if (i >= (int)modules.size()) {
+                break;
+            }
+            Module* module = modules[i];
+            for (Input& input : module->inputs) {
+                std::memcpy(input.voltages, signal, voices * sizeof(float));
+            }
+            module->process(args);
+        }
+    }
+
+    // one sample of every module, the calling thread works too
+    void step(const float* signal)
+    {
+        this->signal = signal;
+        nextModule.store(0, std::memory_order_relaxed);
+        startBarrier.wait();
+        stepModules();
+        doneBarrier.wait();
+    }
+};
+
+/* #trial
+======================================================================================== */
+static Module* createInstance(Model* model, const Config& config)
+{
+    Module* module = model->createModule();
+    json_t* rootJ = json_object();
+    json_object_set_new(rootJ, "quality", json_integer(config.quality));
+    json_object_set_new(rootJ, "oversampling", json_integer(config.oversampling));
+    module->dataFromJson(rootJ);
+    json_decref(rootJ);
+
+    for (Input& input : module->inputs) {
+        input.channels = config.voices;
+    }
+    for (Output& output : module->outputs) {
+        output.channels = 1;
+    }
+    return module;
+}
+
+static Trial runTrial(Model* model, const Config& config, int numInstances, int numThreads)
+{
+    TestEngine engine(numThreads, config);
+    for (int i = 0; i < numInstances; i++) {
+        engine.modules.push_back(createInstance(model, config));
+    }
+
+    // test signal, one detuned sine per voice
+    const int signalLength = 4096;
+    std::vector<float> signal(signalLength * PORT_MAX_CHANNELS);
+    for (int i = 0; i < signalLength; i++) {
+        for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
+            signal[i * PORT_MAX_CHANNELS + c] = 5.f * std::sin(2.f * M_PI * i * (7 + c) / signalLength);
+        }
+    }
+
+    int numBlocks = std::max(1, (int)(config.seconds * config.sampleRate / config.blockSize));
+    int numWarmupBlocks = numBlocks / 10;
+    std::vector<double> blockTimes;
+    blockTimes.reserve(numBlocks);
+    int t = 0;
+    for (int b = 0; b < numWarmupBlocks + numBlocks; b++) {
+        double start = now();
+        for (int i = 0; i < config.blockSize; i++) {
+            engine.step(&signal[t * PORT_MAX_CHANNELS]);
+            t = (t + 1) % signalLength;
+        }
+        if (b >= numWarmupBlocks) {
+            blockTimes.push_back(now() - start);
+        }
+    }
+
+    for (Module* module : engine.modules) {
+        delete module;
+    }
+
+    Trial trial;
+    trial.numInstances = numInstances;
+    double sum = 0.0;
+    for (double time : blockTimes) {
+        sum += time;
+    }
+    trial.meanUs = sum / blockTimes.size() * 1e6;
+    size_t rank = std::min(blockTimes.size() - 1, (size_t)std::ceil(blockTimes.size() * 0.999) - 1);
+    std::nth_element(blockTimes.begin(), blockTimes.begin() + rank, blockTimes.end());
+    trial.p999Us = blockTimes[rank] * 1e6;
+    return trial;
+}
+
+// doubles the instance count until the budget is exceeded, then bisects
+static Trial findCapacity(Model* model, const Config& config, int numThreads, double budgetUs, int maxInstances)
+{
+    Trial best = { 0, 0.0, 0.0 };
+    int low = 0; // fits
+    int high = 0; // doesn't fit, 0 while unknown
+    int n = 1;
+    while (high == 0 || high - low > 1) {
+        Trial trial = runTrial(model, config, n, numThreads);
+        bool fits = trial.p999Us <= budgetUs;
+        printf("  %2d thread%s %5d instances: p99.9 %8.1f us, mean %8.1f us%s\n", numThreads, numThreads > 1 ? "s" : " ", n, trial.p999Us, trial.meanUs, fits ? "" : "  over budget");
+        fflush(stdout);
+        if (fits) {
+            low = n;
+            best = trial;
+            if (n >= maxInstances) {
+                break;
+            }
+        } else {
+            high = n;
+        }
+        n = (high == 0) ? std::min(n * 2, maxInstances) : (low + high) / 2;
+    }
+    return best;
+}
+
+static void usage()
+{
+    printf("usage: loadtest slug [--quality eco|high] [--voices n] [--oversampling factor] [--rate hz] [--block samples]\n");
+    printf("                     [--budget percent] [--seconds s] [--threads n] [--max n] [--plugin-dir dir] [--csv file]\n");
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    std::string slug;
+    int numThreads = std::max(2, std::min(4, (int)std::thread::hardware_concurrency()));
+    int maxInstances = 4096;
+    std::string pluginDir = "..";
+    std::string csvFilename;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--quality" && hasValue) {
+            config.quality = std::string(argv[++i]) == "eco" ? 0 : 1;
+        } else if (arg == "--voices" && hasValue) {
+            config.voices = clamp(atoi(argv[++i]), 1, PORT_MAX_CHANNELS);
+        } else if (arg == "--oversampling" && hasValue) {
+            config.oversampling = atoi(argv[++i]);
+        } else if (arg == "--rate" && hasValue) {
+            config.sampleRate = atof(argv[++i]);
+        } else if (arg == "--block" && hasValue) {
+            config.blockSize = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--budget" && hasValue) {
+            config.budget = atof(argv[++i]) / 100.0;
+        } else if (arg == "--seconds" && hasValue) {
+            config.seconds = std::max(0.1, atof(argv[++i]));
+        } else if (arg == "--threads" && hasValue) {
+            numThreads = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--max" && hasValue) {
+            maxInstances = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--plugin-dir" && hasValue) {
+            pluginDir = argv[++i];
+        } else if (arg == "--csv" && hasValue) {
+            csvFilename = argv[++i];
+        } else if (arg[0] == '-' || !slug.empty()) {
+            usage();
+            return 2;
+        } else {
+            slug = arg;
+        }
+    }
+    if (slug.empty()) {
+        usage();
+        return 2;
+    }
+
+    // keep the settings file away from the real Rack user folder
+    char userDir[] = "/tmp/rackwindows-bench-XXXXXX";
+    if (!mkdtemp(userDir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    asset::userDir = userDir;
+    APP->engine->sampleRate = config.sampleRate;
+
+    Plugin plugin;
+    plugin.path = pluginDir;
+    init(&plugin);
+
+    Model* model = NULL;
+    for (Model* m : plugin.models) {
+        if (m->slug == slug) {
+            model = m;
+        }
+    }
+    if (!model) {
+        fprintf(stderr, "no module %s\n", slug.c_str());
+        return 2;
+    }
+
+    double periodUs = config.blockSize / config.sampleRate * 1e6;
+    double budgetUs = periodUs * config.budget;
+    std::string configName = string::f("%s %dv %dx", config.quality ? "high" : "eco", config.voices, config.oversampling);
+    printf("%s, %s, %d samples at %.0f Hz: block period %.1f us, budget %.1f us\n\n", slug.c_str(), configName.c_str(), config.blockSize, config.sampleRate, periodUs, budgetUs);
+
+    if (numThreads > (int)std::thread::hardware_concurrency()) {
+        printf("note: %d threads on %u cores, the threaded result will be pessimistic\n\n", numThreads, std::thread::hardware_concurrency());
+    }
+
+    std::vector<int> threadCounts = { 1 };
+    if (numThreads > 1) {
+        threadCounts.push_back(numThreads);
+    }
+    std::vector<Trial> results;
+    for (int threads : threadCounts) {
+        results.push_back(findCapacity(model, config, threads, budgetUs, maxInstances));
+    }
+
+    printf("\n%-8s %10s %12s %14s\n", "threads", "instances", "p99.9 us", "us/instance");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Trial& r = results[i];
+        printf("%-8d %10d %12.1f %14.2f\n", threadCounts[i], r.numInstances, r.p999Us, r.numInstances ? r.meanUs / r.numInstances : 0.0);
+    }
+
+    std::string settingsFilename = asset::user("Rackwindows.json");
+    remove(settingsFilename.c_str());
+    rmdir(userDir);
+
+    if (!csvFilename.empty()) {
+        // appended, one line per thread count, so runs of several modules end up in one file
+        std::ifstream existing(csvFilename.c_str());
+        bool hasHeader = existing.good() && existing.peek() != std::ifstream::traits_type::eof();
+        existing.close();
+        std::ofstream file(csvFilename.c_str(), std::ios::app);
+        if (!hasHeader) {
+            file << "slug,config,rate,block,budget_us,threads,instances,p999_us,mean_us\n";
+        }
+        for (size_t i = 0; i < results.size(); i++) {
+            const Trial& r = results[i];
+            file << slug << "," << configName << "," << config.sampleRate << "," << config.blockSize << "," << budgetUs << "," << threadCounts[i] << "," << r.numInstances << "," << r.p999Us << "," << r.meanUs << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,379 @@
+/***********************************************************************************************
+Process benchmark
+-----------------
+Runs every module's process() against the headless Rack in ./headless and reports, per module
+and configuration, the time per sample. Every input carries a test signal (a few detuned
+sines, one per voice) and every output is connected, so no module sleeps.
+
+Configurations are taken from what the module stores with the patch: eco and high quality
+when it has a quality setting, 1 and 16 voices, and an oversampled run when it can oversample.
+
+With --counters, Linux hardware performance counters are read around each processing loop
+(perf_event_open, user space only): cycles, instructions, L1 data cache read misses,
+last level cache misses and branch misses, all per sample. Few instructions per cycle with
+many cache misses point at memory layout, many instructions at the arithmetic.
+
+    ./process                          # all modules
+    ./process --counters mv chorus     # selected modules, with counters
+    ./process -s 2 --csv process.csv
+
+See ./readme.md
+************************************************************************************************/
+
+#include <rack.hpp>
+#include <chrono>
+#include <fstream>
+#include <unistd.h>
+
+#if defined __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+/* #counters
+======================================================================================== */
+// Hardware counters of this thread, opened as one group so they are scheduled together
+struct Counters {
+    enum Counter {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        NUM_COUNTERS
+    };
+
+    int fds[NUM_COUNTERS];
+    int leader = -1;
+    int numOpen = 0;
+    int groupIndex[NUM_COUNTERS]; // position of each counter in the group read, -1 if missing
+
+    Counters()
+    {
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            fds[i] = -1;
+            groupIndex[i] = -1;
+        }
+    }
+
+    ~Counters()
+    {
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            if (fds[i] >= 0) {
+                close(fds[i]);
+            }
+        }
+    }
+
+#if defined __linux__
+    static int openEvent(uint32_t type, uint64_t config, int groupFd)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = groupFd < 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
+    }
+
+    // false if not even the cycle counter is available (no PMU, or perf_event_paranoid > 2)
+    bool open()
+    {
+        const uint32_t types[NUM_COUNTERS] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE };
+        const uint64_t configs[NUM_COUNTERS] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES
+        };
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            fds[i] = openEvent(types[i], configs[i], leader);
+            if (fds[i] < 0) {
+                if (i == CYCLES) {
+                    return false;
+                }
+                continue;
+            }
+            if (i == CYCLES) {
+                leader = fds[i];
+            }
+            groupIndex[i] = numOpen++;
+        }
+        return true;
+    }
+
+    void start()
+    {
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    // counts since start(), scaled up if the group was multiplexed with other users
+    void stop(double values[NUM_COUNTERS])
+    {
+        ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        uint64_t data[3 + NUM_COUNTERS];
+        ssize_t size = read(leader, data, sizeof(data));
+        double scale = (size > 0 && data[2] > 0) ? (double)data[1] / data[2] : 0.0;
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            values[i] = (size > 0 && groupIndex[i] >= 0) ? data[3 + groupIndex[i]] * scale : -1.0;
+        }
+    }
+#else
+    bool open()
+    {
+        return false;
+    }
+
+    void start() {}
+
+    void stop(double values[NUM_COUNTERS])
+    {
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            values[i] = -1.0;
+        }
+    }
+#endif
+};
+
+/* #benchmark
+======================================================================================== */
+struct Config {
+    std::string name;
+    int quality;
+    int voices;
+    int oversampling;
+};
+
+struct Result {
+    std::string slug;
+    std::string config;
+    double nsPerSample;
+    double counters[Counters::NUM_COUNTERS]; // per sample, -1 if not measured
+};
+
+static const float sampleRate = 48000.f;
+static const int signalLength = 4096;
+
+static double now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// the configurations a module supports, judged by what it saves with the patch
+static std::vector<Config> configsFor(Module* module, int oversampling)
+{
+    json_t* rootJ = module->dataToJson();
+    bool hasQuality = rootJ && json_object_get(rootJ, "quality");
+    bool hasOversampling = rootJ && json_object_get(rootJ, "oversampling");
+    json_decref(rootJ);
+
+    std::vector<Config> configs;
+    if (hasQuality) {
+        configs.push_back({ "eco 1v", 0, 1, 1 });
+        configs.push_back({ "high 1v", 1, 1, 1 });
+        configs.push_back({ "high 16v", 1, 16, 1 });
+    } else {
+        configs.push_back({ "1v", -1, 1, 1 });
+        configs.push_back({ "16v", -1, 16, 1 });
+    }
+    if (hasOversampling && oversampling > 1) {
+        configs.push_back({ string::f("high 16v %dx", oversampling), 1, 16, oversampling });
+    }
+    return configs;
+}
+
+static Result measure(Model* model, const Config& config, int numSamples, Counters* counters)
+{
+    Result result;
+    result.slug = model->slug;
+    result.config = config.name;
+
+    Module* module = model->createModule();
+    json_t* rootJ = json_object();
+    if (config.quality >= 0) {
+        json_object_set_new(rootJ, "quality", json_integer(config.quality));
+    }
+    json_object_set_new(rootJ, "oversampling", json_integer(config.oversampling));
+    module->dataFromJson(rootJ);
+    json_decref(rootJ);
+
+    // test signal: per voice a sine pair, detuned so the voices differ
+    static float signal[PORT_MAX_CHANNELS][signalLength];
+    for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
+        for (int i = 0; i < signalLength; i++) {
+            float phase = 2.f * M_PI * i / signalLength;
+            signal[c][i] = 4.f * std::sin(phase * (5 + c)) + 1.f * std::sin(phase * (67 + 3 * c));
+        }
+    }
+    for (Input& input : module->inputs) {
+        input.channels = config.voices;
+    }
+    for (Output& output : module->outputs) {
+        output.channels = 1;
+    }
+
+    Module::ProcessArgs args = { sampleRate, 1.f / sampleRate };
+    auto run = [&](int from, int count) {
+        for (int i = from; i < from + count; i++) {
+            int t = i % signalLength;
+            for (Input& input : module->inputs) {
+                for (int c = 0; c < config.voices; c++) {
+                    input.voltages[c] = signal[c][t];
+                }
+            }
+            module->process(args);
+        }
+    };
+
+    // warm up the caches and let the modules settle on their kernels
+    run(0, (int)sampleRate / 10);
+
+    double values[Counters::NUM_COUNTERS];
+    double start = now();
+    if (counters) {
+        counters->start();
+    }
+    run(0, numSamples);
+    if (counters) {
+        counters->stop(values);
+    }
+    result.nsPerSample = (now() - start) * 1e9 / numSamples;
+
+    for (int i = 0; i < Counters::NUM_COUNTERS; i++) {
+        result.counters[i] = (counters && values[i] >= 0.0) ? values[i] / numSamples : -1.0;
+    }
+
+    delete module;
+    return result;
+}
+
+static void printResult(const Result& r, bool hasCounters)
+{
+    printf("%-20s %-16s %10.1f", r.slug.c_str(), r.config.c_str(), r.nsPerSample);
+    if (hasCounters) {
+        const double* c = r.counters;
+        double ipc = (c[Counters::CYCLES] > 0.0 && c[Counters::INSTRUCTIONS] >= 0.0) ? c[Counters::INSTRUCTIONS] / c[Counters::CYCLES] : -1.0;
+        double shown[] = { c[Counters::CYCLES], c[Counters::INSTRUCTIONS], ipc, c[Counters::L1D_MISSES], c[Counters::LLC_MISSES], c[Counters::BRANCH_MISSES] };
+        const char* formats[] = { " %10.0f", " %10.0f", " %6.2f", " %10.2f", " %10.3f", " %10.2f" };
+        for (int i = 0; i < 6; i++) {
+            if (shown[i] < 0.0) {
+                printf(" %*s", i == 2 ? 6 : 10, "-");
+            } else {
+                printf(formats[i], shown[i]);
+            }
+        }
+    }
+    printf("\n");
+}
+
+static void writeCsv(const std::string& filename, const std::vector<Result>& results)
+{
+    std::ofstream file(filename.c_str());
+    file << "slug,config,ns_per_sample,cycles,instructions,l1d_misses,llc_misses,branch_misses\n";
+    for (const Result& r : results) {
+        file << r.slug << "," << r.config << "," << r.nsPerSample;
+        for (int i = 0; i < Counters::NUM_COUNTERS; i++) {
+            file << ",";
+            if (r.counters[i] >= 0.0) {
+                file << r.counters[i];
+            }
+        }
+        file << "\n";
+    }
+}
+
+static void usage()
+{
+    printf("usage: process [-s seconds] [--oversampling factor] [--counters] [--plugin-dir dir] [--csv file] [slug...]\n");
+}
+
+int main(int argc, char** argv)
+{
+    double seconds = 1.0;
+    int oversampling = 4;
+    bool useCounters = false;
+    std::string pluginDir = "..";
+    std::string csvFilename;
+    std::vector<std::string> slugs;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-s" && hasValue) {
+            seconds = std::max(0.01, atof(argv[++i]));
+        } else if (arg == "--oversampling" && hasValue) {
+            oversampling = atoi(argv[++i]);
+        } else if (arg == "--counters") {
+            useCounters = true;
+        } else if (arg == "--plugin-dir" && hasValue) {
+            pluginDir = argv[++i];
+        } else if (arg == "--csv" && hasValue) {
+            csvFilename = argv[++i];
+        } else if (arg[0] == '-') {
+            usage();
+            return 2;
+        } else {
+            slugs.push_back(arg);
+        }
+    }
+
+    // keep the settings file away from the real Rack user folder
+    char userDir[] = "/tmp/rackwindows-bench-XXXXXX";
+    if (!mkdtemp(userDir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    asset::userDir = userDir;
+    APP->engine->sampleRate = sampleRate;
+
+    Plugin plugin;
+    plugin.path = pluginDir;
+    init(&plugin);
+
+    Counters counters;
+    if (useCounters && !counters.open()) {
+        fprintf(stderr, "hardware counters not available (see /proc/sys/kernel/perf_event_paranoid), timing only\n");
+        useCounters = false;
+    }
+
+    int numSamples = (int)(seconds * sampleRate);
+    printf("%d samples at %.0f Hz per run\n\n", numSamples, sampleRate);
+    printf("%-20s %-16s %10s", "module", "config", "ns/sample");
+    if (useCounters) {
+        printf(" %10s %10s %6s %10s %10s %10s", "cycles", "instr", "IPC", "L1D miss", "LLC miss", "br miss");
+    }
+    printf("\n");
+
+    std::vector<Result> results;
+    for (Model* model : plugin.models) {
+        if (!slugs.empty() && std::find(slugs.begin(), slugs.end(), model->slug) == slugs.end()) {
+            continue;
+        }
+        Module* probe = model->createModule();
+        std::vector<Config> configs = configsFor(probe, oversampling);
+        delete probe;
+
+        for (const Config& config : configs) {
+            Result r = measure(model, config, numSamples, useCounters ? &counters : NULL);
+            printResult(r, useCounters);
+            results.push_back(r);
+        }
+    }
+
+    std::string settingsFilename = asset::user("Rackwindows.json");
+    remove(settingsFilename.c_str());
+    rmdir(userDir);
+
+    if (!csvFilename.empty()) {
+        writeCsv(csvFilename, results);
+    }
+
+    return 0;
+}
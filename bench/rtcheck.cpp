@@ -0,0 +1,357 @@
+/***********************************************************************************************
+Real-time safety check
+----------------------
+Runs every module's process() against the headless Rack in ./headless with the calls that
+can block the audio thread interposed:
+
+- malloc, calloc, realloc, free (and so new and delete)
+- pthread_mutex_lock
+- fopen
+- rand, random (they take a lock inside the C library)
+
+Any such call made while process() runs is reported with a stack trace, and the run exits
+with status 1. Each module runs in every configuration it supports (quality, 1 and 16
+voices, oversampling), with its parameters moved to random values every block, and with a
+stretch of silence in between, so sleeping and waking are covered too.
+
+    ./rtcheck                 # all modules
+    ./rtcheck -s 4 mv         # selected modules, seconds per configuration
+
+Linux with glibc only (the allocator is reached through __libc_malloc and friends).
+See ./readme.md
+************************************************************************************************/
+
+#include <rack.hpp>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <unistd.h>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+}
+
+/* #hooks
+======================================================================================== */
+// Hits are recorded into fixed storage, since the hooks themselves must not allocate
+namespace rtcheck {
+
+static const int maxTraces = 8;
+static const int maxFrames = 12;
+
+struct Trace {
+    const char* function;
+    int numFrames;
+    void* frames[maxFrames];
+};
+
+static thread_local bool isChecking = false;
+static thread_local bool isInHook = false;
+static int numHits = 0;
+static int numTraces = 0;
+static Trace traces[maxTraces];
+
+static void hit(const char* function)
+{
+    if (!isChecking || isInHook) {
+        return;
+    }
+    isInHook = true;
+    numHits++;
+    if (numTraces < maxTraces) {
+        // keep each distinct call site once
+        Trace& trace = traces[numTraces];
+        trace.function = function;
+        trace.numFrames = backtrace(trace.frames, maxFrames);
+        bool isNew = true;
+        for (int i = 0; i < numTraces && isNew; i++) {
+            isNew = traces[i].function != function || traces[i].numFrames != trace.numFrames || memcmp(traces[i].frames, trace.frames, trace.numFrames * sizeof(void*)) != 0;
+        }
+        numTraces += isNew;
+    }
+    isInHook = false;
+}
+
+template <typename TFunction>
+static TFunction next(const char* name)
+{
+    return (TFunction)dlsym(RTLD_NEXT, name);
+}
+
+} // namespace rtcheck
+
+extern "C" {
+
+void* malloc(size_t size)
+{
+    rtcheck::hit("malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    rtcheck::hit("calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    rtcheck::hit("realloc");
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr)
+{
+    if (ptr) {
+        rtcheck::hit("free");
+    }
+    __libc_free(ptr);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+    typedef int (*Function)(pthread_mutex_t*);
+    static Function function = NULL;
+    static bool isResolving = false;
+    if (!function) {
+        // dlsym may lock too, and nothing else runs yet
+        if (isResolving) {
+            return 0;
+        }
+        isResolving = true;
+        function = rtcheck::next<Function>("pthread_mutex_lock");
+        isResolving = false;
+    }
+    rtcheck::hit("pthread_mutex_lock");
+    return function(mutex);
+}
+
+FILE* fopen(const char* filename, const char* mode)
+{
+    typedef FILE* (*Function)(const char*, const char*);
+    static Function function = rtcheck::next<Function>("fopen");
+    rtcheck::hit("fopen");
+    return function(filename, mode);
+}
+
+int rand()
+{
+    typedef int (*Function)();
+    static Function function = rtcheck::next<Function>("rand");
+    rtcheck::hit("rand");
+    return function();
+}
+
+long random()
+{
+    typedef long (*Function)();
+    static Function function = rtcheck::next<Function>("random");
+    rtcheck::hit("random");
+    return function();
+}
+
+} // extern "C"
+
+/* #check
+======================================================================================== */
+struct Config {
+    std::string name;
+    int quality;
+    int voices;
+    int oversampling;
+};
+
+static const float sampleRate = 48000.f;
+static const int blockSize = 256;
+
+// "binary(mangled+0x12) [0x...]" from backtrace_symbols, with the name demangled
+static std::string describeFrame(const char* symbol)
+{
+    std::string text = symbol;
+    size_t open = text.find('(');
+    size_t plus = text.find('+', open);
+    if (open == std::string::npos || plus == std::string::npos || plus == open + 1) {
+        return text;
+    }
+    std::string mangled = text.substr(open + 1, plus - open - 1);
+    int status = 0;
+    char* name = abi::__cxa_demangle(mangled.c_str(), NULL, NULL, &status);
+    if (status == 0 && name) {
+        text = name;
+        free(name);
+    }
+    return text;
+}
+
+static void printTraces()
+{
+    for (int i = 0; i < rtcheck::numTraces; i++) {
+        const rtcheck::Trace& trace = rtcheck::traces[i];
+        printf("    %s\n", trace.function);
+        char** symbols = backtrace_symbols(trace.frames, trace.numFrames);
+        // skip the hook itself and rtcheck::hit
+        for (int f = 2; f < trace.numFrames && symbols; f++) {
+            std::string frame = describeFrame(symbols[f]);
+            printf("      %s\n", frame.c_str());
+            if (frame.find("::process(") != std::string::npos) {
+                break;
+            }
+        }
+        free(symbols);
+    }
+}
+
+static std::vector<Config> configsFor(Module* module)
+{
+    json_t* rootJ = module->dataToJson();
+    bool hasQuality = rootJ && json_object_get(rootJ, "quality");
+    bool hasOversampling = rootJ && json_object_get(rootJ, "oversampling");
+    json_decref(rootJ);
+
+    std::vector<Config> configs;
+    for (int quality = 0; quality < (hasQuality ? 2 : 1); quality++) {
+        for (int voices : { 1, 16 }) {
+            for (int oversampling : { 1, 4 }) {
+                if (oversampling > 1 && !hasOversampling) {
+                    continue;
+                }
+                std::string name = hasQuality ? (quality ? "high " : "eco ") : "";
+                name += string::f("%dv", voices);
+                if (oversampling > 1) {
+                    name += string::f(" %dx", oversampling);
+                }
+                configs.push_back({ name, hasQuality ? quality : -1, voices, oversampling });
+            }
+        }
+    }
+    return configs;
+}
+
+// returns the number of calls caught while process() ran
+static int check(Model* model, const Config& config, double seconds)
+{
+    Module* module = model->createModule();
+    json_t* rootJ = json_object();
+    if (config.quality >= 0) {
+        json_object_set_new(rootJ, "quality", json_integer(config.quality));
+    }
+    json_object_set_new(rootJ, "oversampling", json_integer(config.oversampling));
+    module->dataFromJson(rootJ);
+    json_decref(rootJ);
+
+    for (Input& input : module->inputs) {
+        input.channels = config.voices;
+    }
+    for (Output& output : module->outputs) {
+        output.channels = 1;
+    }
+
+    // signal, then silence long enough for the modules with a short tail to sleep, then signal
+    int numSamples = seconds * sampleRate;
+    int silenceStart = numSamples / 4;
+    int silenceEnd = numSamples * 3 / 4;
+    Module::ProcessArgs args = { sampleRate, 1.f / sampleRate };
+
+    rtcheck::numHits = 0;
+    rtcheck::numTraces = 0;
+    for (int i = 0; i < numSamples; i++) {
+        if (i % blockSize == 0) {
+            for (size_t p = 0; p < module->params.size(); p++) {
+                ParamQuantity* q = module->paramQuantities[p];
+                if (q) {
+                    module->params[p].setValue(q->minValue + (q->maxValue - q->minValue) * random::uniform());
+                }
+            }
+        }
+        bool isSilent = i >= silenceStart && i < silenceEnd;
+        for (Input& input : module->inputs) {
+            for (int c = 0; c < config.voices; c++) {
+                input.voltages[c] = isSilent ? 0.f : 5.f * std::sin(0.01f * (c + 1) * i);
+            }
+        }
+        rtcheck::isChecking = true;
+        module->process(args);
+        rtcheck::isChecking = false;
+    }
+
+    delete module;
+    return rtcheck::numHits;
+}
+
+static void usage()
+{
+    printf("usage: rtcheck [-s seconds] [--plugin-dir dir] [slug...]\n");
+}
+
+int main(int argc, char** argv)
+{
+    double seconds = 2.0;
+    std::string pluginDir = "..";
+    std::vector<std::string> slugs;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-s" && hasValue) {
+            seconds = std::max(0.1, atof(argv[++i]));
+        } else if (arg == "--plugin-dir" && hasValue) {
+            pluginDir = argv[++i];
+        } else if (arg[0] == '-') {
+            usage();
+            return 2;
+        } else {
+            slugs.push_back(arg);
+        }
+    }
+
+    // the first backtrace() loads the unwinder, which allocates
+    void* frames[4];
+    backtrace(frames, 4);
+
+    // keep the settings file away from the real Rack user folder
+    char userDir[] = "/tmp/rackwindows-bench-XXXXXX";
+    if (!mkdtemp(userDir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    asset::userDir = userDir;
+    APP->engine->sampleRate = sampleRate;
+
+    Plugin plugin;
+    plugin.path = pluginDir;
+    init(&plugin);
+
+    int numFailures = 0;
+    for (Model* model : plugin.models) {
+        if (!slugs.empty() && std::find(slugs.begin(), slugs.end(), model->slug) == slugs.end()) {
+            continue;
+        }
+        Module* probe = model->createModule();
+        std::vector<Config> configs = configsFor(probe);
+        delete probe;
+
+        for (const Config& config : configs) {
+            int numHits = check(model, config, seconds);
+            printf("%-20s %-14s %s\n", model->slug.c_str(), config.name.c_str(), numHits ? string::f("FAIL (%d calls)", numHits).c_str() : "ok");
+            if (numHits) {
+                printTraces();
+                numFailures++;
+            }
+        }
+    }
+
+    std::string settingsFilename = asset::user("Rackwindows.json");
+    remove(settingsFilename.c_str());
+    rmdir(userDir);
+
+    if (numFailures) {
+        printf("\n%d configurations are not real-time safe\n", numFailures);
+        return 1;
+    }
+    printf("\nall configurations are real-time safe\n");
+    return 0;
+}
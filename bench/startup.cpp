@@ -0,0 +1,231 @@
+/***********************************************************************************************
+Startup benchmark
+-----------------
+Constructs N instances of every module and of its widget against the headless Rack in
+./headless and reports, per module:
+
+- cold: time to build the first widget, which reads the panel and component SVGs
+- module/widget: mean construction time per instance once the SVG cache is warm
+- reset: mean time of onReset()
+- module/widget KB: resident memory added per instance
+
+Results can be written as CSV and compared against a previous run, which makes the tool
+usable as a regression check between releases:
+
+    ./startup -n 32 --csv startup-1.2.0.csv
+    ./startup -n 32 --baseline startup-1.2.0.csv --tolerance 25
+
+See ./readme.md
+************************************************************************************************/
+
+#include <rack.hpp>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+struct Result {
+    std::string slug;
+    double coldMs;
+    double moduleUs;
+    double widgetUs;
+    double resetUs;
+    double moduleKb;
+    double widgetKb;
+};
+
+static double now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// resident set size in KB
+static double residentKb()
+{
+    long pages = 0, resident = 0;
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (file) {
+        if (fscanf(file, "%ld %ld", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        fclose(file);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024.0);
+}
+
+static Result measure(Model* model, int numInstances)
+{
+    Result result;
+    result.slug = model->slug;
+
+    // first widget, with whatever SVGs this module adds to the cache
+    double start = now();
+    delete model->createModuleWidget();
+    result.coldMs = (now() - start) * 1e3;
+
+    std::vector<Module*> modules(numInstances);
+    double rss = residentKb();
+    start = now();
+    for (int i = 0; i < numInstances; i++) {
+        modules[i] = model->createModule();
+    }
+    result.moduleUs = (now() - start) * 1e6 / numInstances;
+    result.moduleKb = (residentKb() - rss) / numInstances;
+
+    start = now();
+    for (int i = 0; i < numInstances; i++) {
+        modules[i]->onReset();
+    }
+    result.resetUs = (now() - start) * 1e6 / numInstances;
+
+    for (Module* module : modules) {
+        delete module;
+    }
+
+    // widgets come with their own module, so take the module out again
+    std::vector<ModuleWidget*> widgets(numInstances);
+    rss = residentKb();
+    start = now();
+    for (int i = 0; i < numInstances; i++) {
+        widgets[i] = model->createModuleWidget();
+    }
+    result.widgetUs = std::max(0.0, (now() - start) * 1e6 / numInstances - result.moduleUs);
+    result.widgetKb = std::max(0.0, (residentKb() - rss) / numInstances - result.moduleKb);
+
+    for (ModuleWidget* widget : widgets) {
+        delete widget->module;
+        delete widget;
+    }
+
+    return result;
+}
+
+static void writeCsv(const std::string& filename, const std::vector<Result>& results)
+{
+    std::ofstream file(filename.c_str());
+    file << "slug,cold_ms,module_us,widget_us,reset_us,module_kb,widget_kb\n";
+    for (const Result& r : results) {
+        file << r.slug << "," << r.coldMs << "," << r.moduleUs << "," << r.widgetUs << "," << r.resetUs << "," << r.moduleKb << "," << r.widgetKb << "\n";
+    }
+}
+
+static std::vector<Result> readCsv(const std::string& filename)
+{
+    std::vector<Result> results;
+    std::ifstream file(filename.c_str());
+    std::string line;
+    std::getline(file, line); // header
+    while (std::getline(file, line)) {
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream fields(line);
+        Result r;
+        if (fields >> r.slug >> r.coldMs >> r.moduleUs >> r.widgetUs >> r.resetUs >> r.moduleKb >> r.widgetKb) {
+            results.push_back(r);
+        }
+    }
+    return results;
+}
+
+// returns the number of modules whose construction got slower than the tolerance allows
+static int compare(const std::vector<Result>& results, const std::vector<Result>& baseline, double tolerance)
+{
+    int regressions = 0;
+    printf("\n%-20s %12s %12s %8s\n", "vs baseline", "before us", "after us", "change");
+    for (const Result& r : results) {
+        for (const Result& b : baseline) {
+            if (b.slug != r.slug) {
+                continue;
+            }
+            double before = b.moduleUs + b.widgetUs + b.resetUs;
+            double after = r.moduleUs + r.widgetUs + r.resetUs;
+            double change = before > 0.0 ? (after / before - 1.0) * 100.0 : 0.0;
+            bool isRegression = change > tolerance;
+            regressions += isRegression;
+            printf("%-20s %12.2f %12.2f %+7.1f%%%s\n", r.slug.c_str(), before, after, change, isRegression ? "  REGRESSION" : "");
+        }
+    }
+    return regressions;
+}
+
+static void usage()
+{
+    printf("usage: startup [-n instances] [--plugin-dir dir] [--csv file] [--baseline file] [--tolerance percent] [slug...]\n");
+}
+
+int main(int argc, char** argv)
+{
+    int numInstances = 16;
+    std::string pluginDir = "..";
+    std::string csvFilename;
+    std::string baselineFilename;
+    double tolerance = 25.0;
+    std::vector<std::string> slugs;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-n" && hasValue) {
+            numInstances = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--plugin-dir" && hasValue) {
+            pluginDir = argv[++i];
+        } else if (arg == "--csv" && hasValue) {
+            csvFilename = argv[++i];
+        } else if (arg == "--baseline" && hasValue) {
+            baselineFilename = argv[++i];
+        } else if (arg == "--tolerance" && hasValue) {
+            tolerance = atof(argv[++i]);
+        } else if (arg[0] == '-') {
+            usage();
+            return 2;
+        } else {
+            slugs.push_back(arg);
+        }
+    }
+
+    // keep the settings file away from the real Rack user folder
+    char userDir[] = "/tmp/rackwindows-bench-XXXXXX";
+    if (!mkdtemp(userDir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    asset::userDir = userDir;
+
+    Plugin plugin;
+    plugin.path = pluginDir;
+    double start = now();
+    init(&plugin);
+    printf("init: %.3f ms, %d instances per module\n\n", (now() - start) * 1e3, numInstances);
+
+    std::vector<Result> results;
+    printf("%-20s %9s %10s %10s %10s %10s %10s\n", "module", "cold ms", "module us", "widget us", "reset us", "module KB", "widget KB");
+    for (Model* model : plugin.models) {
+        if (!slugs.empty() && std::find(slugs.begin(), slugs.end(), model->slug) == slugs.end()) {
+            continue;
+        }
+        Result r = measure(model, numInstances);
+        printf("%-20s %9.3f %10.2f %10.2f %10.2f %10.1f %10.1f\n", r.slug.c_str(), r.coldMs, r.moduleUs, r.widgetUs, r.resetUs, r.moduleKb, r.widgetKb);
+        results.push_back(r);
+    }
+    printf("\nsvg files read: %zu (%.1f KB)\n", APP->window->svgLoads, APP->window->svgBytes / 1024.0);
+
+    std::string settingsFilename = asset::user("Rackwindows.json");
+    remove(settingsFilename.c_str());
+    rmdir(userDir);
+
+    if (!csvFilename.empty()) {
+        writeCsv(csvFilename, results);
+    }
+
+    if (!baselineFilename.empty()) {
+        std::vector<Result> baseline = readCsv(baselineFilename);
+        if (baseline.empty()) {
+            fprintf(stderr, "no results in %s\n", baselineFilename.c_str());
+            return 1;
+        }
+        if (compare(results, baseline, tolerance) > 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
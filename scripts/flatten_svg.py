@@ -0,0 +1,419 @@
+#!/usr/bin/env python3
+"""Flatten panel and component artwork for faster drawing in Rack.
+
+    flatten_svg.py input.svg output.svg
+
+Rack draws an SVG shape by shape, one NanoVG fill or stroke per shape, and does it again
+every time the framebuffer is redrawn (zoom, scroll, module moves). This rewrites an SVG
+into the smallest set of shapes that Rack draws identically:
+
+- groups are dissolved, their transforms applied to the coordinates and their styles
+  pushed down to the shapes
+- circles and rectangles become paths, all path data becomes absolute M/L/C/Z
+- clip paths, metadata, ids and editor attributes are dropped (Rack ignores them)
+- shapes that draw nothing are dropped
+- consecutive shapes with the same style are merged into one. Filled shapes are only
+  merged when their bounds (1px apart) don't touch, because Rack decides whether a
+  sub-path is a hole by counting crossings with the other sub-paths of its shape
+
+Only the SVG features used by the artwork in res/ are supported: path (without arcs),
+circle, ellipse, rect, line, polyline, polygon, and matrix/translate/scale transforms.
+A file using anything else is copied unchanged, so it is never flattened wrongly.
+"""
+
+import math
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+SVG_NS = "{http://www.w3.org/2000/svg}"
+
+# style properties that reach NanoVG through nanosvg
+INHERITED = ("fill", "fill-opacity", "fill-rule", "stroke", "stroke-width", "stroke-opacity", "stroke-linecap", "stroke-linejoin", "stroke-miterlimit", "stroke-dasharray")
+NOT_INHERITED = ("opacity", "display")
+
+# shapes merged into one path at most, the crossing test Rack runs per sub-path grows with the square
+MAX_MERGED = 24
+
+# cubic approximation of a quarter circle, as in nanosvg
+KAPPA = 0.5522847493
+
+IDENTITY = (1.0, 0.0, 0.0, 1.0, 0.0, 0.0)
+
+
+class UnsupportedError(Exception):
+    pass
+
+
+def local_name(tag):
+    return tag.split("}", 1)[1] if tag.startswith("{") else tag
+
+
+def multiply(a, b):
+    """Transform that applies b first, then a."""
+    return (a[0] * b[0] + a[2] * b[1],
+            a[1] * b[0] + a[3] * b[1],
+            a[0] * b[2] + a[2] * b[3],
+            a[1] * b[2] + a[3] * b[3],
+            a[0] * b[4] + a[2] * b[5] + a[4],
+            a[1] * b[4] + a[3] * b[5] + a[5])
+
+
+def parse_transform(text):
+    matrix = IDENTITY
+    for name, args in re.findall(r"(\w+)\s*\(([^)]*)\)", text or ""):
+        values = [float(v) for v in re.split(r"[\s,]+", args.strip()) if v]
+        if name == "matrix" and len(values) == 6:
+            step = tuple(values)
+        elif name == "translate":
+            step = (1.0, 0.0, 0.0, 1.0, values[0], values[1] if len(values) > 1 else 0.0)
+        elif name == "scale":
+            step = (values[0], 0.0, 0.0, values[1] if len(values) > 1 else values[0], 0.0, 0.0)
+        else:
+            raise UnsupportedError("transform %s" % name)
+        matrix = multiply(matrix, step)
+    return matrix
+
+
+def apply(matrix, x, y):
+    return (matrix[0] * x + matrix[2] * y + matrix[4], matrix[1] * x + matrix[3] * y + matrix[5])
+
+
+def parse_style(element):
+    style = {}
+    for name in INHERITED + NOT_INHERITED:
+        if name in element.attrib:
+            style[name] = element.attrib[name].strip()
+    for item in element.attrib.get("style", "").split(";"):
+        if ":" in item:
+            name, value = item.split(":", 1)
+            style[name.strip()] = value.strip()
+    return style
+
+
+def parse_length(text, default=0.0):
+    if text is None:
+        return default
+    return float(re.sub(r"(px|pt)$", "", text.strip()))
+
+
+# #path data
+# ========================================================================================
+
+TOKEN = re.compile(r"[MmLlHhVvCcSsQqTtZzAa]|[-+]?(?:\d+\.?\d*|\.\d+)(?:[eE][-+]?\d+)?")
+
+
+def parse_path(d):
+    """Path data as a list of sub-paths, each [start, [(c1, c2, end), ...], closed]."""
+    tokens = TOKEN.findall(d)
+    subpaths = []
+    current = None
+    x = y = 0.0
+    start = (0.0, 0.0)
+    last_control = None
+    command = None
+    i = 0
+
+    def number():
+        nonlocal i
+        value = float(tokens[i])
+        i += 1
+        return value
+
+    def line_to(nx, ny):
+        current[1].append(((x, y), (nx, ny), (nx, ny)))
+
+    while i < len(tokens):
+        if tokens[i].isalpha():
+            command = tokens[i]
+            i += 1
+        elif command is None:
+            raise UnsupportedError("path data without a command")
+        relative = command.islower()
+        c = command.upper()
+        dx, dy = (x, y) if relative else (0.0, 0.0)
+
+        if c == "Z":
+            if current:
+                current[2] = True
+            x, y = start
+            command = None
+            last_control = None
+            continue
+        if c == "A":
+            raise UnsupportedError("arcs")
+
+        if c == "M":
+            nx, ny = number() + dx, number() + dy
+            current = [(nx, ny), [], False]
+            subpaths.append(current)
+            x, y = start = (nx, ny)
+            command = "l" if relative else "L"  # further pairs are line-tos
+            last_control = None
+            continue
+
+        if current is None or current[2]:
+            # drawing after a close starts at the last start point
+            current = [(x, y), [], False]
+            subpaths.append(current)
+
+        if c == "L":
+            nx, ny = number() + dx, number() + dy
+            line_to(nx, ny)
+            last_control = None
+        elif c == "H":
+            nx, ny = number() + (x if relative else 0.0), y
+            line_to(nx, ny)
+            last_control = None
+        elif c == "V":
+            nx, ny = x, number() + (y if relative else 0.0)
+            line_to(nx, ny)
+            last_control = None
+        elif c == "C":
+            c1 = (number() + dx, number() + dy)
+            c2 = (number() + dx, number() + dy)
+            nx, ny = number() + dx, number() + dy
+            current[1].append((c1, c2, (nx, ny)))
+            last_control = c2
+        elif c == "S":
+            c1 = (2 * x - last_control[0], 2 * y - last_control[1]) if last_control else (x, y)
+            c2 = (number() + dx, number() + dy)
+            nx, ny = number() + dx, number() + dy
+            current[1].append((c1, c2, (nx, ny)))
+            last_control = c2
+        elif c in "QT":
+            if c == "Q":
+                q = (number() + dx, number() + dy)
+            else:
+                q = (2 * x - last_control[0], 2 * y - last_control[1]) if last_control else (x, y)
+            nx, ny = number() + dx, number() + dy
+            c1 = (x + 2.0 / 3.0 * (q[0] - x), y + 2.0 / 3.0 * (q[1] - y))
+            c2 = (nx + 2.0 / 3.0 * (q[0] - nx), ny + 2.0 / 3.0 * (q[1] - ny))
+            current[1].append((c1, c2, (nx, ny)))
+            last_control = q
+        x, y = nx, ny
+
+    return subpaths
+
+
+def ellipse_path(cx, cy, rx, ry):
+    kx, ky = rx * KAPPA, ry * KAPPA
+    return [[(cx + rx, cy), [
+        ((cx + rx, cy + ky), (cx + kx, cy + ry), (cx, cy + ry)),
+        ((cx - kx, cy + ry), (cx - rx, cy + ky), (cx - rx, cy)),
+        ((cx - rx, cy - ky), (cx - kx, cy - ry), (cx, cy - ry)),
+        ((cx + kx, cy - ry), (cx + rx, cy - ky), (cx + rx, cy)),
+    ], True]]
+
+
+def polyline_path(points, closed):
+    if not points:
+        return []
+    segments = [(p0, p1, p1) for p0, p1 in zip(points, points[1:])]
+    return [[points[0], segments, closed]]
+
+
+def element_path(element):
+    name = local_name(element.tag)
+    a = element.attrib
+    if name == "path":
+        return parse_path(a.get("d", ""))
+    if name == "circle":
+        r = parse_length(a.get("r"))
+        return ellipse_path(parse_length(a.get("cx")), parse_length(a.get("cy")), r, r) if r > 0 else []
+    if name == "ellipse":
+        rx, ry = parse_length(a.get("rx")), parse_length(a.get("ry"))
+        return ellipse_path(parse_length(a.get("cx")), parse_length(a.get("cy")), rx, ry) if rx > 0 and ry > 0 else []
+    if name == "rect":
+        if parse_length(a.get("rx")) or parse_length(a.get("ry")):
+            raise UnsupportedError("rounded rect")
+        x, y = parse_length(a.get("x")), parse_length(a.get("y"))
+        w, h = parse_length(a.get("width")), parse_length(a.get("height"))
+        if w <= 0 or h <= 0:
+            return []
+        return polyline_path([(x, y), (x + w, y), (x + w, y + h), (x, y + h)], True)
+    if name == "line":
+        return polyline_path([(parse_length(a.get("x1")), parse_length(a.get("y1"))), (parse_length(a.get("x2")), parse_length(a.get("y2")))], False)
+    if name in ("polyline", "polygon"):
+        values = [float(v) for v in re.split(r"[\s,]+", a.get("points", "").strip()) if v]
+        return polyline_path(list(zip(values[0::2], values[1::2])), name == "polygon")
+    raise UnsupportedError("element %s" % name)
+
+
+def transform_path(subpaths, matrix):
+    return [[apply(matrix, *start), [tuple(apply(matrix, *p) for p in segment) for segment in segments], closed] for start, segments, closed in subpaths]
+
+
+def bounds(subpaths):
+    xs, ys = [], []
+    for start, segments, closed in subpaths:
+        for p in (start,) + tuple(p for segment in segments for p in segment):
+            xs.append(p[0])
+            ys.append(p[1])
+    return (min(xs), min(ys), max(xs), max(ys)) if xs else None
+
+
+def format_number(value):
+    text = ("%.3f" % value).rstrip("0").rstrip(".")
+    return "0" if text in ("-0", "") else text
+
+
+def format_point(p):
+    return "%s,%s" % (format_number(p[0]), format_number(p[1]))
+
+
+def format_path(subpaths):
+    parts = []
+    for start, segments, closed in subpaths:
+        parts.append("M" + format_point(start))
+        previous = start
+        for c1, c2, end in segments:
+            if c1 == previous and c2 == end:
+                parts.append("L" + format_point(end))
+            else:
+                parts.append("C%s %s %s" % (format_point(c1), format_point(c2), format_point(end)))
+            previous = end
+        if closed:
+            parts.append("Z")
+    return "".join(parts)
+
+
+# #flatten
+# ========================================================================================
+
+
+class Shape:
+    def __init__(self, style, subpaths):
+        self.style = style
+        self.subpaths = subpaths
+        self.bounds = [bounds(subpaths)]
+        self.count = 1
+
+    def is_filled(self):
+        return self.style.get("fill", "black") != "none"
+
+    def key(self):
+        return tuple(sorted(self.style.items()))
+
+    def can_merge(self, other):
+        if self.key() != other.key() or self.count >= MAX_MERGED:
+            return False
+        if "url(" in self.style.get("fill", "") or "url(" in self.style.get("stroke", ""):
+            return False
+        if not self.is_filled():
+            return True
+        b = other.bounds[0]
+        for a in self.bounds:
+            if a[0] - 1.0 <= b[2] + 1.0 and b[0] - 1.0 <= a[2] + 1.0 and a[1] - 1.0 <= b[3] + 1.0 and b[1] - 1.0 <= a[3] + 1.0:
+                return False
+        return True
+
+    def merge(self, other):
+        self.subpaths += other.subpaths
+        self.bounds += other.bounds
+        self.count += 1
+
+
+def average_scale(matrix):
+    return math.sqrt(abs(matrix[0] * matrix[3] - matrix[1] * matrix[2]))
+
+
+def draws_nothing(style):
+    if style.get("display") == "none":
+        return True
+    if float(style.get("opacity", "1")) == 0.0:
+        return True
+    no_fill = style.get("fill", "black") == "none" or float(style.get("fill-opacity", "1")) == 0.0
+    no_stroke = style.get("stroke", "none") == "none" or float(style.get("stroke-opacity", "1")) == 0.0
+    return no_fill and no_stroke
+
+
+def collect(element, matrix, inherited, shapes):
+    name = local_name(element.tag)
+    if name in ("defs", "clipPath", "mask", "metadata", "title", "desc", "style", "namedview") or not element.tag.startswith(SVG_NS):
+        return
+    if name in ("use", "text", "image", "linearGradient", "radialGradient", "pattern", "symbol"):
+        raise UnsupportedError("element %s" % name)
+
+    own = parse_style(element)
+    style = {k: v for k, v in inherited.items() if k in INHERITED}
+    style.update(own)
+    # opacity isn't inherited but multiplies down through groups
+    if "opacity" in inherited or "opacity" in own:
+        style["opacity"] = format_number(float(inherited.get("opacity", "1")) * float(own.get("opacity", "1")))
+    matrix = multiply(matrix, parse_transform(element.attrib.get("transform")))
+
+    if name in ("svg", "g"):
+        if style.get("display") == "none":
+            return
+        for child in element:
+            collect(child, matrix, style, shapes)
+        return
+
+    if draws_nothing(style):
+        return
+    subpaths = [s for s in element_path(element) if s[1]]
+    if not subpaths:
+        return
+
+    if "stroke-width" in style and matrix != IDENTITY:
+        style["stroke-width"] = format_number(parse_length(style["stroke-width"]) * average_scale(matrix))
+    elif "stroke-width" in style:
+        style["stroke-width"] = format_number(parse_length(style["stroke-width"]))
+    if style.get("opacity") == "1":
+        del style["opacity"]
+    # only fill properties matter without a fill, and the other way round
+    if style.get("fill") == "none":
+        for k in ("fill-opacity", "fill-rule"):
+            style.pop(k, None)
+    if style.get("stroke", "none") == "none":
+        for k in list(style):
+            if k.startswith("stroke"):
+                del style[k]
+
+    shape = Shape(style, transform_path(subpaths, matrix))
+    if shapes and shapes[-1].can_merge(shape):
+        shapes[-1].merge(shape)
+    else:
+        shapes.append(shape)
+
+
+def flatten(source):
+    root = ET.parse(source).getroot()
+    if local_name(root.tag) != "svg":
+        raise UnsupportedError("not an svg file")
+
+    shapes = []
+    # the root's own style (fill-rule etc.) is inherited like a group's
+    collect(root, IDENTITY, {}, shapes)
+
+    attributes = ['xmlns="http://www.w3.org/2000/svg"', 'version="1.1"']
+    for name in ("width", "height", "viewBox"):
+        if name in root.attrib:
+            attributes.append('%s="%s"' % (name, root.attrib[name]))
+
+    lines = ['<?xml version="1.0" encoding="UTF-8" standalone="no"?>', "<svg %s>" % " ".join(attributes)]
+    for shape in shapes:
+        style = ";".join("%s:%s" % item for item in sorted(shape.style.items()))
+        lines.append('<path d="%s" style="%s"/>' % (format_path(shape.subpaths), style))
+    lines.append("</svg>")
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.stderr.write("usage: flatten_svg.py input.svg output.svg\n")
+        return 2
+    try:
+        output = flatten(sys.argv[1])
+    except (UnsupportedError, ValueError) as error:
+        sys.stderr.write("%s: copied unchanged, %s\n" % (sys.argv[1], error))
+        with open(sys.argv[1]) as file:
+            output = file.read()
+    with open(sys.argv[2], "w") as file:
+        file.write(output)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
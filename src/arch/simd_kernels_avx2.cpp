@@ -0,0 +1,4 @@
+// built with -mavx2 -mfma (see Makefile), only called when the CPU supports it
+#define SIMD_KERNELS_ARCH avx2
+#define SIMD_KERNELS_NAME "AVX2/FMA"
+#include "../simd_kernels_impl.hpp"
@@ -0,0 +1,4 @@
+// built with -mavx512f -mavx512dq -mavx512vl -mavx2 -mfma (see Makefile), only called when the CPU supports it
+#define SIMD_KERNELS_ARCH avx512
+#define SIMD_KERNELS_NAME "AVX-512"
+#include "../simd_kernels_impl.hpp"
@@ -0,0 +1,4 @@
+// built with the plugin's baseline flags
+#define SIMD_KERNELS_ARCH sse2
+#define SIMD_KERNELS_NAME "SSE2"
+#include "../simd_kernels_impl.hpp"
@@ -10,7 +10,7 @@ Changes/Additions:
 - if no input is connected, the respective output will provide constant voltage selectable in 1V steps from -8V to +8V
 - option to link bottom BSG to top BSG -> gain shifts at top BSG are automatically compensated for by the bottom BSG
 - if linked, bottom knob acts as an offset
-- polyphonic
+- polyphonic, gain changes take effect at the zero crossings of each voice
 
 See ./LICENSE.md for all licenses
 ************************************************************************************************/
@@ -19,6 +19,83 @@ See ./LICENSE.md for all licenses
 
 #include "plugin.hpp"
 
+// The shift of one BSG unit per voice, four voices per float_4. A new shift is taken on by
+// each voice at its own zero crossings, to reduce clicks on parameter changes. Once all
+// voices have it the unit is settled, and crossings are only looked for again on the next
+// change, so a settled unit doesn't keep the last samples either: the first sample of a
+// change only records them.
+struct VoiceShifts {
+    simd::float_4 shifts[4];
+    simd::float_4 lastSamples[4];
+    float shift; // the knob's shift, which all voices have while settled
+    bool isSettled;
+    bool isStarting; // first sample of a change
+    bool isChanging; // this sample
+
+    void reset()
+    {
+        for (int i = 0; i < 4; i++) {
+            shifts[i] = 0.f;
+            lastSamples[i] = 0.f;
+        }
+        shift = 0.f;
+        isSettled = true;
+        isStarting = false;
+        isChanging = false;
+    }
+
+    // once per sample, before update()
+    void setShift(float newShift)
+    {
+        if (newShift != shift) {
+            shift = newShift;
+            isStarting = isSettled;
+            isSettled = false;
+        }
+        isChanging = !isSettled;
+    }
+
+    // the shifts of voices c to c + 3 for this sample
+    simd::float_4 update(simd::float_4 inputSample, int c)
+    {
+        if (!isChanging) {
+            return shift;
+        }
+        if (!isStarting) {
+            simd::float_4 isCrossing = (inputSample * lastSamples[c / 4]) < 0.f;
+            shifts[c / 4] = simd::ifelse(isCrossing, shift, shifts[c / 4]);
+        }
+        lastSamples[c / 4] = inputSample;
+        return shifts[c / 4];
+    }
+
+    simd::float_4 get(int c)
+    {
+        return isChanging ? shifts[c / 4] : simd::float_4(shift);
+    }
+
+    // once per sample, after update(): settled once every voice has the new shift
+    void settle(int numChannels)
+    {
+        if (!isChanging) {
+            return;
+        }
+        isStarting = false;
+        bool isDone = true;
+        for (int c = 0; c < numChannels; c += 4) {
+            simd::float_4 voice = simd::float_4(c) + simd::float_4(0.f, 1.f, 2.f, 3.f);
+            isDone &= simd::movemask((shifts[c / 4] == shift) | (voice >= (float)numChannels)) == 0xf;
+        }
+        if (isDone) {
+            // voices that come in later start at the knob's shift
+            for (int i = 0; i < 4; i++) {
+                shifts[i] = shift;
+            }
+            isSettled = true;
+        }
+    }
+};
+
 struct Bitshiftgain : Module {
     enum ParamIds {
         SHIFT_A_PARAM,
@@ -41,11 +118,10 @@ struct Bitshiftgain : Module {
         NUM_LIGHTS
     };
 
-    int shiftA;
-    int shiftB;
+    VoiceShifts shiftA;
+    VoiceShifts shiftB;
     bool isLinked;
-    double lastSampleA; // for zero crossing detection
-    double lastSampleB; // for zero crossing detection
+    DspStats dspStats;
 
     Bitshiftgain()
     {
@@ -59,125 +135,22 @@ struct Bitshiftgain : Module {
 
     void onReset() override
     {
-        shiftA = 0;
-        shiftB = 0;
+        shiftA.reset();
+        shiftB.reset();
         isLinked = false;
-        lastSampleA = 0.0;
-        lastSampleB = 0.0;
     }
 
-    double bitShift(int bitshiftGain)
+    // 2^shift for shifts of -16 to 16, put together from the exponent bits, so multiplying by
+    // it only adds to the exponent of the sample
+    static simd::float_4 bitShift(simd::float_4 shift)
     {
-        double gain = 1.0;
-
-        //we are directly punching in the gain values rather than calculating them
-        switch (bitshiftGain) {
-        case -16:
-            gain = 0.0000152587890625;
-            break;
-        case -15:
-            gain = 0.000030517578125;
-            break;
-        case -14:
-            gain = 0.00006103515625;
-            break;
-        case -13:
-            gain = 0.0001220703125;
-            break;
-        case -12:
-            gain = 0.000244140625;
-            break;
-        case -11:
-            gain = 0.00048828125;
-            break;
-        case -10:
-            gain = 0.0009765625;
-            break;
-        case -9:
-            gain = 0.001953125;
-            break;
-        case -8:
-            gain = 0.00390625;
-            break;
-        case -7:
-            gain = 0.0078125;
-            break;
-        case -6:
-            gain = 0.015625;
-            break;
-        case -5:
-            gain = 0.03125;
-            break;
-        case -4:
-            gain = 0.0625;
-            break;
-        case -3:
-            gain = 0.125;
-            break;
-        case -2:
-            gain = 0.25;
-            break;
-        case -1:
-            gain = 0.5;
-            break;
-        case 0:
-            gain = 1.0;
-            break;
-        case 1:
-            gain = 2.0;
-            break;
-        case 2:
-            gain = 4.0;
-            break;
-        case 3:
-            gain = 8.0;
-            break;
-        case 4:
-            gain = 16.0;
-            break;
-        case 5:
-            gain = 32.0;
-            break;
-        case 6:
-            gain = 64.0;
-            break;
-        case 7:
-            gain = 128.0;
-            break;
-        case 8:
-            gain = 256.0;
-            break;
-        case 9:
-            gain = 512.0;
-            break;
-        case 10:
-            gain = 1024.0;
-            break;
-        case 11:
-            gain = 2048.0;
-            break;
-        case 12:
-            gain = 4096.0;
-            break;
-        case 13:
-            gain = 8192.0;
-            break;
-        case 14:
-            gain = 16384.0;
-            break;
-        case 15:
-            gain = 32768.0;
-            break;
-        case 16:
-            gain = 65536.0;
-            break;
-        }
-
-        return gain;
+        return simd::float_4::cast((simd::int32_4(shift) + simd::int32_4(127)) << 23);
     }
 
     void process(const ProcessArgs& args) override
     {
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
+
         // link
         isLinked = params[LINK_PARAM].getValue() ? true : false;
         lights[LINK_LIGHT].setBrightness(isLinked);
@@ -190,20 +163,22 @@ struct Bitshiftgain : Module {
             // get number of polyphonic channels
             int numChannelsA = inputs[IN_A_INPUT].getChannels();
 
-            // set number of output channels
-            outputs[OUT_A_OUTPUT].setChannels(numChannelsA);
+            // all voices in at once, four at a time
+            PolyBuffer voices;
+            voices.read(inputs[IN_A_INPUT]);
 
-            // update shiftA only at zero crossings (of first channel) to reduce clicks on parameter changes
-            // reasonably effective on most sources, but will not happen across multiple channels, therefore monophonic only
-            bool isZero = (inputs[IN_A_INPUT].getVoltage() * lastSampleA < 0.0);
-            shiftA = isZero ? params[SHIFT_A_PARAM].getValue() : shiftA;
-            lastSampleA = inputs[IN_A_INPUT].getVoltage();
+            shiftA.setShift(params[SHIFT_A_PARAM].getValue());
+
+            for (int c = 0; c < numChannelsA; c += 4) {
+                simd::float_4 inputSample = voices.getSimd(c);
 
-            // for each poly channel
-            for (int i = 0; i < numChannelsA; i++) {
                 // shift signal in 6db steps
-                outputs[OUT_A_OUTPUT].setVoltage(inputs[IN_A_INPUT].getPolyVoltage(i) * bitShift(shiftA), i);
+                voices.setSimd(inputSample * bitShift(shiftA.update(inputSample, c)), c);
             }
+
+            shiftA.settle(numChannelsA);
+
+            voices.write(outputs[OUT_A_OUTPUT]);
         } else {
             // output -8 to 8 in 1V steps if no input is connected
             outputs[OUT_A_OUTPUT].setVoltage(params[SHIFT_A_PARAM].getValue());
@@ -217,30 +192,38 @@ struct Bitshiftgain : Module {
             // get number of polyphonic channels
             int numChannelsB = inputs[IN_B_INPUT].getChannels();
 
-            // set number of output channels
-            outputs[OUT_B_OUTPUT].setChannels(numChannelsB);
+            // all voices in at once, four at a time
+            PolyBuffer voices;
+            voices.read(inputs[IN_B_INPUT]);
 
-            // update shiftB only at zero crossings (of first channel) to reduce clicks on parameter changes
-            // reasonably effective on most sources, but will not happen across multiple channels, therefore monophonic only
-            bool isZero = (inputs[IN_B_INPUT].getVoltage() * lastSampleB < 0.0);
-            shiftB = isZero ? params[SHIFT_B_PARAM].getValue() : shiftB;
-            lastSampleB = inputs[IN_B_INPUT].getVoltage();
+            shiftB.setShift(params[SHIFT_B_PARAM].getValue());
+
+            // voice c of B compensates for voice c of A, or for A's only voice if A is monophonic
+            int numChannelsA = inputs[IN_A_INPUT].getChannels();
+
+            for (int c = 0; c < numChannelsB; c += 4) {
+                simd::float_4 inputSample = voices.getSimd(c);
+                simd::float_4 shift = shiftB.update(inputSample, c);
 
-            // for each poly channel
-            for (int i = 0; i < numChannelsB; i++) {
                 if (isLinked) {
                     if (inputs[IN_A_INPUT].isConnected()) {
+                        simd::float_4 linkedShiftA = (numChannelsA == 1) ? simd::float_4(shiftA.get(0)[0]) : shiftA.get(c);
+
                         // offset signal in 6db steps
-                        outputs[OUT_B_OUTPUT].setVoltage(inputs[IN_B_INPUT].getPolyVoltage(i) * bitShift(-shiftA + shiftB), i);
+                        voices.setSimd(inputSample * bitShift(-linkedShiftA + shift), c);
                     } else {
                         // offset signal in 1V steps
-                        outputs[OUT_B_OUTPUT].setVoltage(inputs[IN_B_INPUT].getPolyVoltage(i) + params[SHIFT_B_PARAM].getValue(), i);
+                        voices.setSimd(inputSample + params[SHIFT_B_PARAM].getValue(), c);
                     }
                 } else {
                     // shift signal in 6db steps
-                    outputs[OUT_B_OUTPUT].setVoltage(inputs[IN_B_INPUT].getPolyVoltage(i) * bitShift(shiftB), i);
+                    voices.setSimd(inputSample * bitShift(shift), c);
                 }
             }
+
+            shiftB.settle(numChannelsB);
+
+            voices.write(outputs[OUT_B_OUTPUT]);
         } else {
             // output -8 to 8 in 1V steps if no input is connected
             outputs[OUT_B_OUTPUT].setVoltage(params[SHIFT_B_PARAM].getValue());
@@ -249,10 +232,23 @@ struct Bitshiftgain : Module {
 };
 
 struct BitshiftgainWidget : ModuleWidget {
+
+    void appendContextMenu(Menu* menu) override
+    {
+        Bitshiftgain* module = dynamic_cast<Bitshiftgain*>(this->module);
+        assert(module);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
+    }
+
     BitshiftgainWidget(Bitshiftgain* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/bitshiftgain_dark.svg")));
+        setPanel(loadArtwork("bitshiftgain_dark.svg"));
 
         // screws
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH * 1.5, 0)));
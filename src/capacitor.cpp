@@ -9,7 +9,7 @@ Changes/Additions:
 - mono
 - no Dry/Wet
 - CV inputs for Lowpass and Highpass
-- polyphonic
+- polyphonic, four voices at a time
 
 See ./LICENSE.md for all licenses
 ************************************************************************************************/
@@ -49,30 +49,20 @@ struct Capacitor : Module {
     float lowpassParam;
     float highpassParam;
 
-    // state variables (as arrays in order to handle up to 16 polyphonic channels)
-    double iirHighpassA[16];
-    double iirHighpassB[16];
-    double iirHighpassC[16];
-    double iirHighpassD[16];
-    double iirHighpassE[16];
-    double iirHighpassF[16];
-    double iirLowpassA[16];
-    double iirLowpassB[16];
-    double iirLowpassC[16];
-    double iirLowpassD[16];
-    double iirLowpassE[16];
-    double iirLowpassF[16];
-    double lowpassChase[16];
-    double highpassChase[16];
-    double lowpassAmount[16];
-    double highpassAmount[16];
-    double lastLowpass[16];
-    double lastHighpass[16];
-    int count[16];
-    long double fpNShape[16];
+    // state variables, voices in groups of four
+    rwlib::Capacitor<simd::float_4, 4> capacitor;
+    simd::float_4 fpNShape[4];
 
     // other
     double overallscale;
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
+    rwlib::DitherNoise ditherSource;
+
+    // process kernel, specialised at compile time for the current quality setting
+    typedef void (Capacitor::*ProcessKernel)(const ProcessArgs& args);
+    ProcessKernel kernel;
+    int kernelQuality;
 
     Capacitor()
     {
@@ -81,6 +71,7 @@ struct Capacitor : Module {
         configParam(HIGHPASS_PARAM, 0.f, 1.f, 0.f, "Highpass");
 
         quality = loadQuality();
+        kernelQuality = -1;
         onReset();
     }
 
@@ -88,27 +79,9 @@ struct Capacitor : Module {
     {
         onSampleRateChange();
 
-        for (int i = 0; i < 16; i++) {
-            iirHighpassA[i] = 0.0;
-            iirHighpassB[i] = 0.0;
-            iirHighpassC[i] = 0.0;
-            iirHighpassD[i] = 0.0;
-            iirHighpassE[i] = 0.0;
-            iirHighpassF[i] = 0.0;
-            iirLowpassA[i] = 0.0;
-            iirLowpassB[i] = 0.0;
-            iirLowpassC[i] = 0.0;
-            iirLowpassD[i] = 0.0;
-            iirLowpassE[i] = 0.0;
-            iirLowpassF[i] = 0.0;
-            lowpassChase[i] = 0.0;
-            highpassChase[i] = 0.0;
-            lowpassAmount[i] = 1.0;
-            highpassAmount[i] = 0.0;
-            lastLowpass[i] = 1000.0;
-            lastHighpass[i] = 1000.0;
-            count[i] = 0;
-            fpNShape[i] = 0.0;
+        capacitor.reset();
+        for (int i = 0; i < 4; i++) {
+            fpNShape[i] = 0.f;
         }
     }
 
@@ -119,6 +92,10 @@ struct Capacitor : Module {
         overallscale = 1.0;
         overallscale /= 44100.0;
         overallscale *= sampleRate;
+
+        // tail: the one-pole filters at their lowest setting (coefficient 0.0001) need ~14 time
+        // constants to fall by 120 dB
+        silenceDetector.setTail(140000.0, sampleRate);
     }
 
     json_t* dataToJson() override
@@ -139,7 +116,32 @@ struct Capacitor : Module {
             quality = json_integer_value(qualityJ);
     }
 
+    void selectKernel()
+    {
+        kernel = (quality == HIGH) ? &Capacitor::processKernel<HIGH> : &Capacitor::processKernel<ECO>;
+        kernelQuality = quality;
+    }
+
     void process(const ProcessArgs& args) override
+    {
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
+
+        // skip the dsp once the inputs have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs[IN_INPUT]))) {
+            dspStats.sleep();
+            clearOutputs(outputs);
+            return;
+        }
+
+        if (quality != kernelQuality) {
+            selectKernel();
+        }
+
+        (this->*kernel)(args);
+    }
+
+    template <int QUALITY>
+    void processKernel(const ProcessArgs& args)
     {
         if (outputs[OUT_OUTPUT].isConnected()) {
 
@@ -151,171 +153,35 @@ struct Capacitor : Module {
             highpassParam += inputs[HIGHPASS_CV_INPUT].getVoltage() / 5;
             highpassParam = clamp(highpassParam, 0.01f, 0.99f);
 
-            double lowpassSpeed;
-            double highpassSpeed;
-            double invLowpass;
-            double invHighpass;
-            long double inputSample;
-
-            // for each poly channel
-            for (int i = 0, numChannels = std::max(1, inputs[IN_INPUT].getChannels()); i < numChannels; ++i) {
-
-                lowpassChase[i] = pow(lowpassParam, 2);
-                highpassChase[i] = pow(highpassParam, 2);
-                //should not scale with sample rate, because values reaching 1 are important
-                //to its ability to bypass when set to max
-                lowpassSpeed = 300 / (fabs(lastLowpass[i] - lowpassChase[i]) + 1.0);
-                highpassSpeed = 300 / (fabs(lastHighpass[i] - highpassChase[i]) + 1.0);
-                lastLowpass[i] = lowpassChase[i];
-                lastHighpass[i] = highpassChase[i];
-
-                // input
-                inputSample = inputs[IN_INPUT].getPolyVoltage(i);
-
-                // pad gain
-                inputSample *= gainCut;
-
-                if (quality == HIGH) {
-                    if (inputSample < 1.2e-38 && -inputSample < 1.2e-38) {
-                        static int noisesource = 0;
-                        //this declares a variable before anything else is compiled. It won't keep assigning
-                        //it to 0 for every sample, it's as if the declaration doesn't exist in this context,
-                        //but it lets me add this denormalization fix in a single place rather than updating
-                        //it in three different locations. The variable isn't thread-safe but this is only
-                        //a random seed and we can share it with whatever.
-                        noisesource = noisesource % 1700021;
-                        noisesource++;
-                        int residue = noisesource * noisesource;
-                        residue = residue % 170003;
-                        residue *= residue;
-                        residue = residue % 17011;
-                        residue *= residue;
-                        residue = residue % 1709;
-                        residue *= residue;
-                        residue = residue % 173;
-                        residue *= residue;
-                        residue = residue % 17;
-                        double applyresidue = residue;
-                        applyresidue *= 0.00000001;
-                        applyresidue *= 0.00000001;
-                        inputSample = applyresidue;
-                    }
-                }
+            simd::float_4 lowpassChase = lowpassParam * lowpassParam;
+            simd::float_4 highpassChase = highpassParam * highpassParam;
 
-                lowpassAmount[i] = (((lowpassAmount[i] * lowpassSpeed) + lowpassChase[i]) / (lowpassSpeed + 1.0));
-                invLowpass = 1.0 - lowpassAmount[i];
-                highpassAmount[i] = (((highpassAmount[i] * highpassSpeed) + highpassChase[i]) / (highpassSpeed + 1.0));
-                invHighpass = 1.0 - highpassAmount[i];
-
-                //Highpass Filter chunk. This is three poles of IIR highpass, with a 'gearbox' that progressively
-                //steepens the filter after minimizing artifacts.
-                count[i]++;
-                if (count[i] > 5)
-                    count[i] = 0;
-                switch (count[i]) {
-                case 0:
-                    iirHighpassA[i] = (iirHighpassA[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassA[i];
-                    iirLowpassA[i] = (iirLowpassA[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassA[i];
-                    iirHighpassB[i] = (iirHighpassB[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassB[i];
-                    iirLowpassB[i] = (iirLowpassB[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassB[i];
-                    iirHighpassD[i] = (iirHighpassD[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassD[i];
-                    iirLowpassD[i] = (iirLowpassD[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassD[i];
-                    break;
-                case 1:
-                    iirHighpassA[i] = (iirHighpassA[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassA[i];
-                    iirLowpassA[i] = (iirLowpassA[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassA[i];
-                    iirHighpassC[i] = (iirHighpassC[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassC[i];
-                    iirLowpassC[i] = (iirLowpassC[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassC[i];
-                    iirHighpassE[i] = (iirHighpassE[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassE[i];
-                    iirLowpassE[i] = (iirLowpassE[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassE[i];
-                    break;
-                case 2:
-                    iirHighpassA[i] = (iirHighpassA[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassA[i];
-                    iirLowpassA[i] = (iirLowpassA[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassA[i];
-                    iirHighpassB[i] = (iirHighpassB[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassB[i];
-                    iirLowpassB[i] = (iirLowpassB[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassB[i];
-                    iirHighpassF[i] = (iirHighpassF[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassF[i];
-                    iirLowpassF[i] = (iirLowpassF[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassF[i];
-                    break;
-                case 3:
-                    iirHighpassA[i] = (iirHighpassA[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassA[i];
-                    iirLowpassA[i] = (iirLowpassA[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassA[i];
-                    iirHighpassC[i] = (iirHighpassC[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassC[i];
-                    iirLowpassC[i] = (iirLowpassC[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassC[i];
-                    iirHighpassD[i] = (iirHighpassD[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassD[i];
-                    iirLowpassD[i] = (iirLowpassD[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassD[i];
-                    break;
-                case 4:
-                    iirHighpassA[i] = (iirHighpassA[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassA[i];
-                    iirLowpassA[i] = (iirLowpassA[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassA[i];
-                    iirHighpassB[i] = (iirHighpassB[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassB[i];
-                    iirLowpassB[i] = (iirLowpassB[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassB[i];
-                    iirHighpassE[i] = (iirHighpassE[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassE[i];
-                    iirLowpassE[i] = (iirLowpassE[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassE[i];
-                    break;
-                case 5:
-                    iirHighpassA[i] = (iirHighpassA[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassA[i];
-                    iirLowpassA[i] = (iirLowpassA[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassA[i];
-                    iirHighpassC[i] = (iirHighpassC[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassC[i];
-                    iirLowpassC[i] = (iirLowpassC[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassC[i];
-                    iirHighpassF[i] = (iirHighpassF[i] * invHighpass) + (inputSample * highpassAmount[i]);
-                    inputSample -= iirHighpassF[i];
-                    iirLowpassF[i] = (iirLowpassF[i] * invLowpass) + (inputSample * lowpassAmount[i]);
-                    inputSample = iirLowpassF[i];
-                    break;
-                }
+            // all voices in at once, four at a time
+            PolyBuffer voices;
+            voices.read(inputs[IN_INPUT]);
 
-                //stereo 32 bit dither, made small and tidy.
-                if (quality == HIGH) {
-                    int expon;
-                    frexpf((float)inputSample, &expon);
-                    long double dither = (rand() / (RAND_MAX * 7.737125245533627e+25)) * pow(2, expon + 62);
-                    inputSample += (dither - fpNShape[i]);
-                    fpNShape[i] = dither;
-                    //end 32 bit dither
+            capacitor.step();
+
+            for (int c = 0; c < voices.channels; c += 4) {
+                // input, pad gain
+                simd::float_4 inputSample = voices.getSimd(c) * (float)gainCut;
+
+                if (QUALITY == HIGH) {
+                    inputSample = denormalize(inputSample, std::min(4, voices.channels - c));
                 }
 
-                // bring gain back up
-                inputSample *= gainBoost;
+                inputSample = capacitor.process(inputSample, lowpassChase, highpassChase, c / 4);
 
-                // output
-                outputs[OUT_OUTPUT].setChannels(numChannels);
-                outputs[OUT_OUTPUT].setVoltage(inputSample, i);
+                if (QUALITY == HIGH) {
+                    DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
+                    inputSample = ditherNoiseShaped(inputSample, ditherSource, fpNShape[c / 4]);
+                }
+
+                // bring gain back up, output
+                voices.setSimd(inputSample * (float)gainBoost, c);
             }
+
+            voices.write(outputs[OUT_OUTPUT]);
         }
     }
 };
@@ -360,12 +226,18 @@ struct CapacitorWidget : ModuleWidget {
         high->module = module;
         high->quality = 1;
         menu->addChild(high);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
     }
 
     CapacitorWidget(Capacitor* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/capacitor_mono_dark.svg")));
+        setPanel(loadArtwork("capacitor_mono_dark.svg"));
 
         // screws
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH * 1.5, 0)));
@@ -9,7 +9,7 @@ Changes/Additions:
 - separate controls for left and right channels
 - controls can be linked
 - CV inputs for lowpass, highpass and dry/wet
-- polyphonic
+- polyphonic, four voices at a time
 
 See ./LICENSE.md for all licenses
 ************************************************************************************************/
@@ -63,35 +63,20 @@ struct Capacitor_stereo : Module {
     float highpassParam;
     float drywetParam;
 
-    // state variables (as arrays in order to handle up to 16 polyphonic channels)
-    struct stateVars {
-        double iirHighpassA;
-        double iirHighpassB;
-        double iirHighpassC;
-        double iirHighpassD;
-        double iirHighpassE;
-        double iirHighpassF;
-        double iirLowpassA;
-        double iirLowpassB;
-        double iirLowpassC;
-        double iirLowpassD;
-        double iirLowpassE;
-        double iirLowpassF;
-        double lowpassChase;
-        double highpassChase;
-        double wetChase;
-        double lowpassAmount;
-        double highpassAmount;
-        double wet;
-        double lastLowpass;
-        double lastHighpass;
-        double lastWet;
-        int count;
-        long double fpNShape;
-    } stateL[16], stateR[16];
+    // state variables, voices in groups of four: left in groups 0 to 3, right in 4 to 7
+    rwlib::Capacitor<simd::float_4, 8> capacitor;
+    simd::float_4 fpNShape[8];
 
     // other
     double overallscale;
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
+    rwlib::DitherNoise ditherSource;
+
+    // process kernel, specialised at compile time for the current quality setting
+    typedef void (Capacitor_stereo::*ProcessKernel)(const ProcessArgs& args);
+    ProcessKernel kernel;
+    int kernelQuality;
 
     Capacitor_stereo()
     {
@@ -105,6 +90,7 @@ struct Capacitor_stereo : Module {
 
         isLinked = true;
         quality = loadQuality();
+        kernelQuality = -1;
         onReset();
     }
 
@@ -115,39 +101,21 @@ struct Capacitor_stereo : Module {
         overallscale = 1.0;
         overallscale /= 44100.0;
         overallscale *= sampleRate;
+
+        // tail: the one-pole filters at their lowest setting (coefficient 0.0001) need ~14 time
+        // constants to fall by 120 dB
+        silenceDetector.setTail(140000.0, sampleRate);
     }
 
     void onReset() override
     {
         onSampleRateChange();
 
-        for (int i = 0; i < 16; i++) {
-            stateL[i].iirHighpassA = stateR[i].iirHighpassA = 0.0;
-            stateL[i].iirHighpassB = stateR[i].iirHighpassB = 0.0;
-            stateL[i].iirHighpassC = stateR[i].iirHighpassC = 0.0;
-            stateL[i].iirHighpassD = stateR[i].iirHighpassD = 0.0;
-            stateL[i].iirHighpassE = stateR[i].iirHighpassE = 0.0;
-            stateL[i].iirHighpassF = stateR[i].iirHighpassF = 0.0;
-            stateL[i].iirLowpassA = stateR[i].iirLowpassA = 0.0;
-            stateL[i].iirLowpassB = stateR[i].iirLowpassB = 0.0;
-            stateL[i].iirLowpassC = stateR[i].iirLowpassC = 0.0;
-            stateL[i].iirLowpassD = stateR[i].iirLowpassD = 0.0;
-            stateL[i].iirLowpassE = stateR[i].iirLowpassE = 0.0;
-            stateL[i].iirLowpassF = stateR[i].iirLowpassF = 0.0;
-            stateL[i].lowpassChase = stateR[i].lowpassChase = 0.0;
-            stateL[i].highpassChase = stateR[i].highpassChase = 0.0;
-            stateL[i].wetChase = stateR[i].wetChase = 0.0;
-            stateL[i].lowpassAmount = stateR[i].lowpassAmount = 1.0;
-            stateL[i].highpassAmount = stateR[i].highpassAmount = 0.0;
-            stateL[i].wet = stateR[i].wet = 1.0;
-            stateL[i].lastLowpass = stateR[i].lastLowpass = 1000.0;
-            stateL[i].lastHighpass = stateR[i].lastHighpass = 1000.0;
-            stateL[i].lastWet = stateR[i].lastWet = 1000.0;
-            stateL[i].count = stateR[i].count = 0;
-            stateL[i].fpNShape = stateR[i].fpNShape = 0.0;
-
-            lastLowpassParam = lastHighpassParam = 0.0f;
+        capacitor.reset();
+        for (int i = 0; i < 8; i++) {
+            fpNShape[i] = 0.f;
         }
+        lastLowpassParam = lastHighpassParam = 0.0f;
     }
 
     json_t* dataToJson() override
@@ -168,7 +136,9 @@ struct Capacitor_stereo : Module {
             quality = json_integer_value(qualityJ);
     }
 
-    void processChannel(stateVars v[], Param& lowpass, Param& highpass, Param& drywet, Input& lowpassCv, Input& highpassCv, Input& drywetCv, Input& input, Output& output)
+    // side 0 is left, 1 is right
+    template <int QUALITY>
+    void processChannel(int side, Param& lowpass, Param& highpass, Param& drywet, Input& lowpassCv, Input& highpassCv, Input& drywetCv, Input& input, Output& output)
     {
         // params
         lowpassParam = lowpass.getValue();
@@ -183,188 +153,50 @@ struct Capacitor_stereo : Module {
         drywetParam += drywetCv.getVoltage() / 5;
         drywetParam = clamp(drywetParam, 0.01f, 0.99f);
 
-        double lowpassSpeed;
-        double highpassSpeed;
-        double wetSpeed;
-        double invLowpass;
-        double invHighpass;
-        double dry;
-
-        long double inputSample;
-        long double drySample;
-
-        // for each poly channel
-        for (int i = 0, numChannels = std::max(1, input.getChannels()); i < numChannels; ++i) {
-
-            v[i].lowpassChase = pow(lowpassParam, 2);
-            v[i].highpassChase = pow(highpassParam, 2);
-            v[i].wetChase = drywetParam;
-            //should not scale with sample rate, because values reaching 1 are important
-            //to its ability to bypass when set to max
-            lowpassSpeed = 300 / (fabs(v[i].lastLowpass - v[i].lowpassChase) + 1.0);
-            highpassSpeed = 300 / (fabs(v[i].lastHighpass - v[i].highpassChase) + 1.0);
-            wetSpeed = 300 / (fabs(v[i].lastWet - v[i].wetChase) + 1.0);
-            v[i].lastLowpass = v[i].lowpassChase;
-            v[i].lastHighpass = v[i].highpassChase;
-            v[i].lastWet = v[i].wetChase;
-
-            // input
-            inputSample = input.getPolyVoltage(i);
-
-            // pad gain
-            inputSample *= gainCut;
-
-            if (quality == HIGH) {
-                if (inputSample < 1.2e-38 && -inputSample < 1.2e-38) {
-                    static int noisesource = 0;
-                    //this declares a variable before anything else is compiled. It won't keep assigning
-                    //it to 0 for every sample, it's as if the declaration doesn't exist in this context,
-                    //but it lets me add this denormalization fix in a single place rather than updating
-                    //it in three different locations. The variable isn't thread-safe but this is only
-                    //a random seed and we can share it with whatever.
-                    noisesource = noisesource % 1700021;
-                    noisesource++;
-                    int residue = noisesource * noisesource;
-                    residue = residue % 170003;
-                    residue *= residue;
-                    residue = residue % 17011;
-                    residue *= residue;
-                    residue = residue % 1709;
-                    residue *= residue;
-                    residue = residue % 173;
-                    residue *= residue;
-                    residue = residue % 17;
-                    double applyresidue = residue;
-                    applyresidue *= 0.00000001;
-                    applyresidue *= 0.00000001;
-                    inputSample = applyresidue;
-                }
-            }
+        simd::float_4 lowpassChase = lowpassParam * lowpassParam;
+        simd::float_4 highpassChase = highpassParam * highpassParam;
 
-            drySample = inputSample;
-
-            v[i].lowpassAmount = (((v[i].lowpassAmount * lowpassSpeed) + v[i].lowpassChase) / (lowpassSpeed + 1.0));
-            invLowpass = 1.0 - v[i].lowpassAmount;
-            v[i].highpassAmount = (((v[i].highpassAmount * highpassSpeed) + v[i].highpassChase) / (highpassSpeed + 1.0));
-            invHighpass = 1.0 - v[i].highpassAmount;
-            v[i].wet = (((v[i].wet * wetSpeed) + v[i].wetChase) / (wetSpeed + 1.0));
-            dry = 1.0 - v[i].wet;
-
-            //Highpass Filter chunk. This is three poles of IIR highpass, with a 'gearbox' that progressively
-            //steepens the filter after minimizing artifacts.
-            v[i].count++;
-            if (v[i].count > 5)
-                v[i].count = 0;
-            switch (v[i].count) {
-            case 0:
-                v[i].iirHighpassA = (v[i].iirHighpassA * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassA;
-                v[i].iirLowpassA = (v[i].iirLowpassA * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassA;
-                v[i].iirHighpassB = (v[i].iirHighpassB * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassB;
-                v[i].iirLowpassB = (v[i].iirLowpassB * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassB;
-                v[i].iirHighpassD = (v[i].iirHighpassD * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassD;
-                v[i].iirLowpassD = (v[i].iirLowpassD * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassD;
-                break;
-            case 1:
-                v[i].iirHighpassA = (v[i].iirHighpassA * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassA;
-                v[i].iirLowpassA = (v[i].iirLowpassA * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassA;
-                v[i].iirHighpassC = (v[i].iirHighpassC * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassC;
-                v[i].iirLowpassC = (v[i].iirLowpassC * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassC;
-                v[i].iirHighpassE = (v[i].iirHighpassE * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassE;
-                v[i].iirLowpassE = (v[i].iirLowpassE * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassE;
-                break;
-            case 2:
-                v[i].iirHighpassA = (v[i].iirHighpassA * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassA;
-                v[i].iirLowpassA = (v[i].iirLowpassA * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassA;
-                v[i].iirHighpassB = (v[i].iirHighpassB * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassB;
-                v[i].iirLowpassB = (v[i].iirLowpassB * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassB;
-                v[i].iirHighpassF = (v[i].iirHighpassF * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassF;
-                v[i].iirLowpassF = (v[i].iirLowpassF * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassF;
-                break;
-            case 3:
-                v[i].iirHighpassA = (v[i].iirHighpassA * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassA;
-                v[i].iirLowpassA = (v[i].iirLowpassA * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassA;
-                v[i].iirHighpassC = (v[i].iirHighpassC * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassC;
-                v[i].iirLowpassC = (v[i].iirLowpassC * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassC;
-                v[i].iirHighpassD = (v[i].iirHighpassD * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassD;
-                v[i].iirLowpassD = (v[i].iirLowpassD * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassD;
-                break;
-            case 4:
-                v[i].iirHighpassA = (v[i].iirHighpassA * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassA;
-                v[i].iirLowpassA = (v[i].iirLowpassA * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassA;
-                v[i].iirHighpassB = (v[i].iirHighpassB * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassB;
-                v[i].iirLowpassB = (v[i].iirLowpassB * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassB;
-                v[i].iirHighpassE = (v[i].iirHighpassE * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassE;
-                v[i].iirLowpassE = (v[i].iirLowpassE * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassE;
-                break;
-            case 5:
-                v[i].iirHighpassA = (v[i].iirHighpassA * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassA;
-                v[i].iirLowpassA = (v[i].iirLowpassA * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassA;
-                v[i].iirHighpassC = (v[i].iirHighpassC * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassC;
-                v[i].iirLowpassC = (v[i].iirLowpassC * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassC;
-                v[i].iirHighpassF = (v[i].iirHighpassF * invHighpass) + (inputSample * v[i].highpassAmount);
-                inputSample -= v[i].iirHighpassF;
-                v[i].iirLowpassF = (v[i].iirLowpassF * invLowpass) + (inputSample * v[i].lowpassAmount);
-                inputSample = v[i].iirLowpassF;
-                break;
-            }
+        // all voices in at once, four at a time
+        PolyBuffer voices;
+        voices.read(input);
 
-            inputSample = (drySample * dry) + (inputSample * v[i].wet);
+        for (int c = 0; c < voices.channels; c += 4) {
+            int group = side * 4 + c / 4;
 
-            if (quality == HIGH) {
-                //stereo 32 bit dither, made small and tidy.
-                int expon;
-                frexpf((float)inputSample, &expon);
-                long double dither = (rand() / (RAND_MAX * 7.737125245533627e+25)) * pow(2, expon + 62);
-                inputSample += (dither - v[i].fpNShape);
-                v[i].fpNShape = dither;
-                //end 32 bit dither
+            // input, pad gain
+            simd::float_4 inputSample = voices.getSimd(c) * (float)gainCut;
+
+            if (QUALITY == HIGH) {
+                inputSample = denormalize(inputSample, std::min(4, voices.channels - c));
             }
 
-            // bring gain back up
-            inputSample *= gainBoost;
+            simd::float_4 drySample = inputSample;
+
+            inputSample = capacitor.process(inputSample, lowpassChase, highpassChase, group);
+            inputSample = capacitor.mix(drySample, inputSample, drywetParam, group);
+
+            if (QUALITY == HIGH) {
+                DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
+                inputSample = ditherNoiseShaped(inputSample, ditherSource, fpNShape[group]);
+            }
 
-            // output
-            output.setChannels(numChannels);
-            output.setVoltage(inputSample, i);
+            // bring gain back up, output
+            voices.setSimd(inputSample * (float)gainBoost, c);
         }
+
+        voices.write(output);
+    }
+
+    void selectKernel()
+    {
+        kernel = (quality == HIGH) ? &Capacitor_stereo::processKernel<HIGH> : &Capacitor_stereo::processKernel<ECO>;
+        kernelQuality = quality;
     }
 
     void process(const ProcessArgs& args) override
     {
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
+
         // link
         isLinked = params[LINK_PARAM].getValue() ? true : false;
 
@@ -384,15 +216,34 @@ struct Capacitor_stereo : Module {
         lastLowpassParam = params[LOWPASS_R_PARAM].getValue();
         lastHighpassParam = params[HIGHPASS_R_PARAM].getValue();
 
+        // link light
+        lights[LINK_LIGHT].setBrightness(isLinked);
+
+        // skip the dsp once the inputs have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs[IN_L_INPUT]) && isSilent(inputs[IN_R_INPUT]))) {
+            dspStats.sleep();
+            clearOutputs(outputs);
+            return;
+        }
+
+        if (quality != kernelQuality) {
+            selectKernel();
+        }
+
+        (this->*kernel)(args);
+    }
+
+    template <int QUALITY>
+    void processKernel(const ProcessArgs& args)
+    {
+        capacitor.step();
+
         if (outputs[OUT_L_OUTPUT].isConnected()) {
-            processChannel(stateL, params[LOWPASS_L_PARAM], params[HIGHPASS_L_PARAM], params[DRYWET_PARAM], inputs[LOWPASS_CV_L_INPUT], inputs[HIGHPASS_CV_L_INPUT], inputs[DRYWET_CV_INPUT], inputs[IN_L_INPUT], outputs[OUT_L_OUTPUT]);
+            processChannel<QUALITY>(0, params[LOWPASS_L_PARAM], params[HIGHPASS_L_PARAM], params[DRYWET_PARAM], inputs[LOWPASS_CV_L_INPUT], inputs[HIGHPASS_CV_L_INPUT], inputs[DRYWET_CV_INPUT], inputs[IN_L_INPUT], outputs[OUT_L_OUTPUT]);
         }
         if (outputs[OUT_R_OUTPUT].isConnected()) {
-            processChannel(stateR, params[LOWPASS_R_PARAM], params[HIGHPASS_R_PARAM], params[DRYWET_PARAM], inputs[LOWPASS_CV_R_INPUT], inputs[HIGHPASS_CV_R_INPUT], inputs[DRYWET_CV_INPUT], inputs[IN_R_INPUT], outputs[OUT_R_OUTPUT]);
+            processChannel<QUALITY>(1, params[LOWPASS_R_PARAM], params[HIGHPASS_R_PARAM], params[DRYWET_PARAM], inputs[LOWPASS_CV_R_INPUT], inputs[HIGHPASS_CV_R_INPUT], inputs[DRYWET_CV_INPUT], inputs[IN_R_INPUT], outputs[OUT_R_OUTPUT]);
         }
-
-        // link light
-        lights[LINK_LIGHT].setBrightness(isLinked);
     }
 };
 
@@ -436,12 +287,18 @@ struct Capacitor_stereoWidget : ModuleWidget {
         high->module = module;
         high->quality = 1;
         menu->addChild(high);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
     }
 
     Capacitor_stereoWidget(Capacitor_stereo* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/capacitor_st_dark.svg")));
+        setPanel(loadArtwork("capacitor_st_dark.svg"));
 
         // screws
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH, 0)));
@@ -57,7 +57,7 @@ struct Chorus : Module {
 
     // state variables (as arrays in order to handle up to 16 polyphonic channels)
     const static int totalsamples = 16386;
-    float d[16][totalsamples];
+    rwlib::DelayBuffer<float, totalsamples> d[16];
     double sweepL[16];
     double sweepR[16];
     int gcountL[16];
@@ -77,6 +77,15 @@ struct Chorus : Module {
 
     // other
     double overallscale;
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
+    rwlib::DitherNoise ditherSource;
+
+    // process kernel, specialised at compile time for the current quality and ensemble setting
+    typedef void (Chorus::*ProcessKernel)(const ProcessArgs& args);
+    ProcessKernel kernel;
+    int kernelQuality;
+    int kernelEnsemble;
 
     Chorus()
     {
@@ -88,6 +97,8 @@ struct Chorus : Module {
 
         quality = loadQuality();
         isEnsemble = false;
+        kernelQuality = -1;
+        kernelEnsemble = -1;
         onReset();
     }
 
@@ -96,9 +107,7 @@ struct Chorus : Module {
         onSampleRateChange();
 
         for (int i = 0; i < 16; i++) {
-            for (int count = 0; count < totalsamples - 1; count++) {
-                d[i][count] = 0;
-            }
+            d[i].clear();
             sweepL[i] = 3.141592653589793238 / 2.0;
             sweepR[i] = 3.141592653589793238 / 2.0;
             gcountL[i] = 0;
@@ -125,6 +134,9 @@ struct Chorus : Module {
         overallscale = 1.0;
         overallscale /= 44100.0;
         overallscale *= sampleRate;
+
+        // tail: bounded by the delay buffer
+        silenceDetector.setTail(totalsamples, sampleRate);
     }
 
     json_t* dataToJson() override
@@ -145,6 +157,7 @@ struct Chorus : Module {
             quality = json_integer_value(qualityJ);
     }
 
+    template <int QUALITY, bool IS_ENSEMBLE>
     void processChannel(Input& input, Output& output, double sweep[], int gcount[], double airPrev[], double airEven[], double airOdd[], double airFactor[], bool fpFlip[], long double fpNShape[])
     {
         if (output.isConnected()) {
@@ -164,7 +177,7 @@ struct Chorus : Module {
             double start[4];
             int loopLimit = (int)(totalsamples * 0.499);
 
-            if (isEnsemble) {
+            if (IS_ENSEMBLE) {
                 speed = pow(speedParam, 3) * 0.001;
                 range = pow(rangeParam, 3) * loopLimit * 0.12;
                 // start[4];
@@ -195,16 +208,20 @@ struct Chorus : Module {
             // input
             int numChannels = std::max(1, input.getChannels());
 
+            // all voices in at once, processed in place
+            PolyBuffer voices;
+            voices.read(input);
+
             // for each poly channel
             for (int i = 0; i < numChannels; i++) {
 
                 // input
-                inputSample = input.getPolyVoltage(i);
+                inputSample = voices[i];
 
                 // pad gain
                 inputSample *= gainCut;
 
-                if (quality == HIGH) {
+                if (QUALITY == HIGH) {
                     if (inputSample < 1.2e-38 && -inputSample < 1.2e-38) {
                         static int noisesource = 0;
                         //this declares a variable before anything else is compiled. It won't keep assigning
@@ -253,39 +270,40 @@ struct Chorus : Module {
                     gcount[i] = loopLimit;
                 }
                 count = gcount[i];
-                d[i][count + loopLimit] = d[i][count] = inputSample;
+                d[i].write(count, inputSample);
+                d[i].write(count + loopLimit, inputSample);
                 gcount[i]--;
                 //double buffer
 
-                if (isEnsemble) {
+                if (IS_ENSEMBLE) {
                     offset = start[0] + (modulation * sin(sweep[i]));
                     count = gcount[i] + (int)floor(offset);
 
-                    inputSample = d[i][count] * (1 - (offset - floor(offset))); //less as value moves away from .0
-                    inputSample += d[i][count + 1]; //we can assume always using this in one way or another?
-                    inputSample += (d[i][count + 2] * (offset - floor(offset))); //greater as value moves away from .0
-                    inputSample -= (((d[i][count] - d[i][count + 1]) - (d[i][count + 1] - d[i][count + 2])) / 50); //interpolation hacks 'r us
+                    inputSample = d[i].read(count) * (1 - (offset - floor(offset))); //less as value moves away from .0
+                    inputSample += d[i].read(count + 1); //we can assume always using this in one way or another?
+                    inputSample += (d[i].read(count + 2) * (offset - floor(offset))); //greater as value moves away from .0
+                    inputSample -= (((d[i].read(count) - d[i].read(count + 1)) - (d[i].read(count + 1) - d[i].read(count + 2))) / 50); //interpolation hacks 'r us
 
                     offset = start[1] + (modulation * sin(sweep[i] + 1.0));
                     count = gcount[i] + (int)floor(offset);
-                    inputSample += d[i][count] * (1 - (offset - floor(offset))); //less as value moves away from .0
-                    inputSample += d[i][count + 1]; //we can assume always using this in one way or another?
-                    inputSample += (d[i][count + 2] * (offset - floor(offset))); //greater as value moves away from .0
-                    inputSample -= (((d[i][count] - d[i][count + 1]) - (d[i][count + 1] - d[i][count + 2])) / 50); //interpolation hacks 'r us
+                    inputSample += d[i].read(count) * (1 - (offset - floor(offset))); //less as value moves away from .0
+                    inputSample += d[i].read(count + 1); //we can assume always using this in one way or another?
+                    inputSample += (d[i].read(count + 2) * (offset - floor(offset))); //greater as value moves away from .0
+                    inputSample -= (((d[i].read(count) - d[i].read(count + 1)) - (d[i].read(count + 1) - d[i].read(count + 2))) / 50); //interpolation hacks 'r us
 
                     offset = start[2] + (modulation * sin(sweep[i] + 2.0));
                     count = gcount[i] + (int)floor(offset);
-                    inputSample += d[i][count] * (1 - (offset - floor(offset))); //less as value moves away from .0
-                    inputSample += d[i][count + 1]; //we can assume always using this in one way or another?
-                    inputSample += (d[i][count + 2] * (offset - floor(offset))); //greater as value moves away from .0
-                    inputSample -= (((d[i][count] - d[i][count + 1]) - (d[i][count + 1] - d[i][count + 2])) / 50); //interpolation hacks 'r us
+                    inputSample += d[i].read(count) * (1 - (offset - floor(offset))); //less as value moves away from .0
+                    inputSample += d[i].read(count + 1); //we can assume always using this in one way or another?
+                    inputSample += (d[i].read(count + 2) * (offset - floor(offset))); //greater as value moves away from .0
+                    inputSample -= (((d[i].read(count) - d[i].read(count + 1)) - (d[i].read(count + 1) - d[i].read(count + 2))) / 50); //interpolation hacks 'r us
 
                     offset = start[3] + (modulation * sin(sweep[i] + 3.0));
                     count = gcount[i] + (int)floor(offset);
-                    inputSample += d[i][count] * (1 - (offset - floor(offset))); //less as value moves away from .0
-                    inputSample += d[i][count + 1]; //we can assume always using this in one way or another?
-                    inputSample += (d[i][count + 2] * (offset - floor(offset))); //greater as value moves away from .0
-                    inputSample -= (((d[i][count] - d[i][count + 1]) - (d[i][count + 1] - d[i][count + 2])) / 50); //interpolation hacks 'r us
+                    inputSample += d[i].read(count) * (1 - (offset - floor(offset))); //less as value moves away from .0
+                    inputSample += d[i].read(count + 1); //we can assume always using this in one way or another?
+                    inputSample += (d[i].read(count + 2) * (offset - floor(offset))); //greater as value moves away from .0
+                    inputSample -= (((d[i].read(count) - d[i].read(count + 1)) - (d[i].read(count + 1) - d[i].read(count + 2))) / 50); //interpolation hacks 'r us
 
                     inputSample *= 0.25; // to get a comparable level
 
@@ -294,10 +312,10 @@ struct Chorus : Module {
                     offset = range + (modulation * sin(sweep[i]));
                     count += (int)floor(offset);
 
-                    inputSample = d[i][count] * (1 - (offset - floor(offset))); //less as value moves away from .0
-                    inputSample += d[i][count + 1]; //we can assume always using this in one way or another?
-                    inputSample += (d[i][count + 2] * (offset - floor(offset))); //greater as value moves away from .0
-                    inputSample -= (((d[i][count] - d[i][count + 1]) - (d[i][count + 1] - d[i][count + 2])) / 50); //interpolation hacks 'r us
+                    inputSample = d[i].read(count) * (1 - (offset - floor(offset))); //less as value moves away from .0
+                    inputSample += d[i].read(count + 1); //we can assume always using this in one way or another?
+                    inputSample += (d[i].read(count + 2) * (offset - floor(offset))); //greater as value moves away from .0
+                    inputSample -= (((d[i].read(count) - d[i].read(count + 1)) - (d[i].read(count + 1) - d[i].read(count + 2))) / 50); //interpolation hacks 'r us
 
                     inputSample *= 0.5; // to get a comparable level
                     //sliding
@@ -314,11 +332,12 @@ struct Chorus : Module {
                 }
                 fpFlip[i] = !fpFlip[i];
 
-                if (quality == HIGH) {
+                if (QUALITY == HIGH) {
+                    DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
                     //stereo 32 bit dither, made small and tidy.
                     int expon;
                     frexpf((float)inputSample, &expon);
-                    long double dither = (rand() / (RAND_MAX * 7.737125245533627e+25)) * pow(2, expon + 62);
+                    long double dither = (ditherSource.next() / 7.737125245533627e+25) * pow(2, expon + 62);
                     inputSample += (dither - fpNShape[i]);
                     fpNShape[i] = dither;
                     //end 32 bit dither
@@ -328,21 +347,59 @@ struct Chorus : Module {
                 inputSample *= gainBoost;
 
                 // output
-                output.setChannels(numChannels);
-                output.setVoltage(inputSample, i);
+                voices[i] = inputSample;
             }
+
+            voices.write(output);
         }
     }
-    void process(const ProcessArgs& args) override
+
+    void selectKernel()
     {
+        static const ProcessKernel kernels[2][2] = {
+            { &Chorus::processKernel<ECO, false>, &Chorus::processKernel<ECO, true> },
+            { &Chorus::processKernel<HIGH, false>, &Chorus::processKernel<HIGH, true> }
+        };
+
+        kernel = kernels[quality == HIGH ? HIGH : ECO][isEnsemble ? 1 : 0];
+        kernelQuality = quality;
+        kernelEnsemble = isEnsemble;
+    }
+
+    template <int QUALITY, bool IS_ENSEMBLE>
+    void processKernel(const ProcessArgs& args)
+    {
+        // zero a little more of the delay memory left stale by the last reset
+        for (int i = 0; i < 16; i++) {
+            d[i].sweep();
+        }
+
         // process L
-        processChannel(inputs[IN_L_INPUT], outputs[OUT_L_OUTPUT], sweepL, gcountL, airPrevL, airEvenL, airOddL, airFactorL, fpFlipL, fpNShapeL);
+        processChannel<QUALITY, IS_ENSEMBLE>(inputs[IN_L_INPUT], outputs[OUT_L_OUTPUT], sweepL, gcountL, airPrevL, airEvenL, airOddL, airFactorL, fpFlipL, fpNShapeL);
         // process R
-        processChannel(inputs[IN_R_INPUT], outputs[OUT_R_OUTPUT], sweepR, gcountR, airPrevR, airEvenR, airOddR, airFactorR, fpFlipR, fpNShapeR);
+        processChannel<QUALITY, IS_ENSEMBLE>(inputs[IN_R_INPUT], outputs[OUT_R_OUTPUT], sweepR, gcountR, airPrevR, airEvenR, airOddR, airFactorR, fpFlipR, fpNShapeR);
+    }
+
+    void process(const ProcessArgs& args) override
+    {
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
 
         // ensemble light
         isEnsemble = params[ENSEMBLE_PARAM].getValue() ? true : false;
         lights[ENSEMBLE_LIGHT].setBrightness(isEnsemble);
+
+        // skip the dsp once the inputs have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs[IN_L_INPUT]) && isSilent(inputs[IN_R_INPUT]))) {
+            dspStats.sleep();
+            clearOutputs(outputs);
+            return;
+        }
+
+        if (quality != kernelQuality || (int)isEnsemble != kernelEnsemble) {
+            selectKernel();
+        }
+
+        (this->*kernel)(args);
     }
 };
 
@@ -386,12 +443,18 @@ struct ChorusWidget : ModuleWidget {
         high->module = module;
         high->quality = 1;
         menu->addChild(high);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
     }
 
     ChorusWidget(Chorus* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/chorus_dark.svg")));
+        setPanel(loadArtwork("chorus_dark.svg"));
 
         // screws
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH, 0)));
@@ -4,6 +4,16 @@
 using namespace rack;
 extern Plugin* pluginInstance;
 
+// artwork, preferring the flattened copy in res/flat built by `make panels` (fewer shapes to draw)
+inline std::shared_ptr<Svg> loadArtwork(const std::string& filename)
+{
+    std::string flat = asset::plugin(pluginInstance, "res/flat/" + filename);
+    if (system::isFile(flat)) {
+        return APP->window->loadSvg(flat);
+    }
+    return APP->window->loadSvg(asset::plugin(pluginInstance, "res/" + filename));
+}
+
 // knobs
 struct RwKnobLarge : app::SvgKnob {
     RwKnobLarge()
@@ -11,7 +21,7 @@ struct RwKnobLarge : app::SvgKnob {
         minAngle = -0.76 * M_PI;
         maxAngle = 0.76 * M_PI;
         shadow->opacity = 0;
-        setSvg(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_knob_large.svg")));
+        setSvg(loadArtwork("components/rw_knob_large.svg"));
     }
 };
 struct RwKnobLargeDark : app::SvgKnob {
@@ -20,7 +30,7 @@ struct RwKnobLargeDark : app::SvgKnob {
         minAngle = -0.76 * M_PI;
         maxAngle = 0.76 * M_PI;
         shadow->opacity = 0.1;
-        setSvg(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_knob_large_dark.svg")));
+        setSvg(loadArtwork("components/rw_knob_large_dark.svg"));
     }
 };
 struct RwKnobMedium : app::SvgKnob {
@@ -29,7 +39,7 @@ struct RwKnobMedium : app::SvgKnob {
         minAngle = -0.76 * M_PI;
         maxAngle = 0.76 * M_PI;
         shadow->opacity = 0;
-        setSvg(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_knob_medium.svg")));
+        setSvg(loadArtwork("components/rw_knob_medium.svg"));
     }
 };
 struct RwKnobMediumDark : app::SvgKnob {
@@ -38,7 +48,7 @@ struct RwKnobMediumDark : app::SvgKnob {
         minAngle = -0.76 * M_PI;
         maxAngle = 0.76 * M_PI;
         shadow->opacity = 0.1;
-        setSvg(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_knob_medium_dark.svg")));
+        setSvg(loadArtwork("components/rw_knob_medium_dark.svg"));
     }
 };
 struct RwKnobSmall : app::SvgKnob {
@@ -47,7 +57,7 @@ struct RwKnobSmall : app::SvgKnob {
         minAngle = -0.76 * M_PI;
         maxAngle = 0.76 * M_PI;
         shadow->opacity = 0;
-        setSvg(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_knob_small.svg")));
+        setSvg(loadArtwork("components/rw_knob_small.svg"));
     }
 };
 struct RwKnobSmallDark : app::SvgKnob {
@@ -56,7 +66,7 @@ struct RwKnobSmallDark : app::SvgKnob {
         minAngle = -0.76 * M_PI;
         maxAngle = 0.76 * M_PI;
         shadow->opacity = 0;
-        setSvg(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_knob_small_dark.svg")));
+        setSvg(loadArtwork("components/rw_knob_small_dark.svg"));
     }
 };
 struct RwKnobTrimpot : app::SvgKnob {
@@ -65,7 +75,7 @@ struct RwKnobTrimpot : app::SvgKnob {
         minAngle = -0.76 * M_PI;
         maxAngle = 0.76 * M_PI;
         shadow->opacity = 0.05;
-        setSvg(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_knob_trimpot.svg")));
+        setSvg(loadArtwork("components/rw_knob_trimpot.svg"));
     }
 };
 
@@ -131,31 +141,31 @@ struct RwSwitchKnobSmallDark : RwKnobSmallDark {
 struct RwSwitchThree : SvgSwitch {
     RwSwitchThree()
     {
-        addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_switch_three_1.svg")));
-        addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_switch_three_0.svg")));
-        addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_switch_three_2.svg")));
+        addFrame(loadArtwork("components/rw_switch_three_1.svg"));
+        addFrame(loadArtwork("components/rw_switch_three_0.svg"));
+        addFrame(loadArtwork("components/rw_switch_three_2.svg"));
     }
 };
 struct RwSwitchThreeVert : SvgSwitch {
     RwSwitchThreeVert()
     {
-        addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_switch_three_vert_1.svg")));
-        addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_switch_three_vert_0.svg")));
-        addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_switch_three_vert_2.svg")));
+        addFrame(loadArtwork("components/rw_switch_three_vert_1.svg"));
+        addFrame(loadArtwork("components/rw_switch_three_vert_0.svg"));
+        addFrame(loadArtwork("components/rw_switch_three_vert_2.svg"));
     }
 };
 struct RwCKSS : SvgSwitch {
     RwCKSS()
     {
-        addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_CKSS_0.svg")));
-        addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_CKSS_1.svg")));
+        addFrame(loadArtwork("components/rw_CKSS_0.svg"));
+        addFrame(loadArtwork("components/rw_CKSS_1.svg"));
     }
 };
 struct RwCKSSRot : SvgSwitch {
     RwCKSSRot()
     {
-        addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_CKSS_rot_0.svg")));
-        addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_CKSS_rot_1.svg")));
+        addFrame(loadArtwork("components/rw_CKSS_rot_0.svg"));
+        addFrame(loadArtwork("components/rw_CKSS_rot_1.svg"));
     }
 };
 
@@ -163,12 +173,12 @@ struct RwCKSSRot : SvgSwitch {
 struct RwPJ301MPort : app::SvgPort {
     RwPJ301MPort()
     {
-        setSvg(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_PJ301M.svg")));
+        setSvg(loadArtwork("components/rw_PJ301M.svg"));
     }
 };
 struct RwPJ301MPortSilver : app::SvgPort {
     RwPJ301MPortSilver()
     {
-        setSvg(APP->window->loadSvg(asset::plugin(pluginInstance, "res/components/rw_PJ301M_silver.svg")));
+        setSvg(loadArtwork("components/rw_PJ301M_silver.svg"));
     }
 };
\ No newline at end of file
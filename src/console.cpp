@@ -26,6 +26,17 @@ See ./LICENSE.md for all licenses
 #define CONSOLE_6 0
 #define PUREST_CONSOLE 1
 
+// one sample of the encoded mix bus that Consoles placed side by side share (see process())
+struct ConsoleBusMessage {
+    simd::float_4 mixL[rwlib::Oversampler<simd::float_4>::maxFactor][4];
+    simd::float_4 mixR[rwlib::Oversampler<simd::float_4>::maxFactor][4];
+    int maxChannelsL;
+    int maxChannelsR;
+    int consoleType;
+    int oversampling;
+    bool isSilent; // every Console up to here is asleep, the mix is empty
+};
+
 struct Console : Module {
     enum ParamIds {
         NUM_PARAMS
@@ -52,12 +63,36 @@ struct Console : Module {
     const double gainBoost = 10.0;
     bool quality;
     int consoleType;
-    dsp::VuMeter2 vuMeters[9];
+    int oversampling;
+    bool chainRight; // hand the mix to the Console on the right instead of decoding it here
+    BlockVuMeter vuMeters[9];
     dsp::ClockDivider lightDivider;
     // float drive;
 
     // state variables (as arrays in order to handle up to 16 polyphonic channels)
     uint32_t fpd[16];
+    rwlib::Oversampler<simd::float_4> channelOversamplersL[9][4];
+    rwlib::Oversampler<simd::float_4> channelOversamplersR[9][4];
+    rwlib::Oversampler<simd::float_4> bussOversamplerL[4];
+    rwlib::Oversampler<simd::float_4> bussOversamplerR[4];
+
+    // expander bus, double-buffered: the Console on the left writes the producer message and
+    // this one reads the consumer message, which the engine swaps in after every sample
+    ConsoleBusMessage busMessages[2];
+    ConsoleBusMessage localBus; // mix of a Console with none on its right
+    ConsoleBusMessage* busIn; // mix of the Consoles on the left, NULL if none
+    ConsoleBusMessage* busOut; // mix for the Console on the right, NULL if none
+
+    // other
+    int lastOversampling; // oversampling in use, a chained Console follows the first one
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
+
+    // process kernel, specialised at compile time for the current quality setting and console type
+    typedef void (Console::*ProcessKernel)(const ProcessArgs& args);
+    ProcessKernel kernel;
+    int kernelQuality;
+    int kernelConsoleType;
 
     Console()
     {
@@ -65,15 +100,60 @@ struct Console : Module {
 
         quality = loadQuality();
         consoleType = loadConsoleType();
+        oversampling = lastOversampling = 1;
+        chainRight = false;
+        kernelQuality = kernelConsoleType = -1;
         lightDivider.setDivision(512);
+
+        for (ConsoleBusMessage& message : busMessages) {
+            message.consoleType = consoleType;
+            message.oversampling = 1;
+            message.isSilent = true;
+        }
+        leftExpander.producerMessage = &busMessages[0];
+        leftExpander.consumerMessage = &busMessages[1];
+        busIn = busOut = NULL;
+
         onReset();
     }
 
     void onReset() override
     {
+        onSampleRateChange();
+
         for (int i = 0; i < 16; i++) {
             fpd[i] = 17;
         }
+
+        for (int i = 0; i < 9; i++) {
+            vuMeters[i].reset();
+        }
+
+        setOversampling(lastOversampling);
+    }
+
+    void onSampleRateChange() override
+    {
+        float sampleRate = APP->engine->getSampleRate();
+
+        // tail: none, the console is memoryless apart from the oversampling filters
+        silenceDetector.setTail(0.0, sampleRate);
+    }
+
+    void setOversampling(int factor)
+    {
+        for (int i = 0; i < 4; i++) {
+            for (int j = 0; j < 9; j++) {
+                channelOversamplersL[j][i].setFactor(factor);
+                channelOversamplersL[j][i].reset();
+                channelOversamplersR[j][i].setFactor(factor);
+                channelOversamplersR[j][i].reset();
+            }
+            bussOversamplerL[i].setFactor(factor);
+            bussOversamplerL[i].reset();
+            bussOversamplerR[i].setFactor(factor);
+            bussOversamplerR[i].reset();
+        }
     }
 
     json_t* dataToJson() override
@@ -86,6 +166,12 @@ struct Console : Module {
         // consoleType
         json_object_set_new(rootJ, "consoleType", json_integer(consoleType));
 
+        // oversampling
+        json_object_set_new(rootJ, "oversampling", json_integer(oversampling));
+
+        // chainRight
+        json_object_set_new(rootJ, "chainRight", json_boolean(chainRight));
+
         return rootJ;
     }
 
@@ -100,154 +186,313 @@ struct Console : Module {
         json_t* consoleTypeJ = json_object_get(rootJ, "consoleType");
         if (consoleTypeJ)
             consoleType = json_integer_value(consoleTypeJ);
+
+        // oversampling
+        json_t* oversamplingJ = json_object_get(rootJ, "oversampling");
+        if (oversamplingJ)
+            oversampling = rwlib::validOversampling(json_integer_value(oversamplingJ));
+
+        // chainRight
+        json_t* chainRightJ = json_object_get(rootJ, "chainRight");
+        if (chainRightJ)
+            chainRight = json_boolean_value(chainRightJ);
     }
 
-    long double encode(long double inputSample, int consoleType = 0)
+    // All voices are processed four at a time as float_4, with the voltages read and written
+    // straight from the ports and the mixes held in float_4 vectors. Voices beyond a port's
+    // channel count are zeroed before encoding, and encode(0) = 0, so they add nothing.
+
+    template <int CONSOLE_TYPE>
+    simd::float_4 encode(simd::float_4 inputSample)
     {
-        switch (consoleType) {
+        switch (CONSOLE_TYPE) {
         case PUREST_CONSOLE: // PurestConsoleChannel
-            inputSample *= 0.25;
-            inputSample = sin(inputSample);
+            inputSample *= 0.25f;
+            inputSample = simd::sin(inputSample);
             break;
-        case CONSOLE_6: // Console6Channel
-            inputSample *= 0.2;
-            if (inputSample > 1.0)
-                inputSample = 1.0;
-            else if (inputSample > 0.0)
-                inputSample = 1.0 - pow(1.0 - inputSample, 2.0);
-
-            if (inputSample < -1.0)
-                inputSample = -1.0;
-            else if (inputSample < 0.0)
-                inputSample = -1.0 + pow(1.0 + inputSample, 2.0);
+        case CONSOLE_6: // Console6Channel, 1 - (1 - x)^2 for positive x, mirrored for negative x
+            inputSample *= 0.2f;
+            inputSample = simd::clamp(inputSample, -1.f, 1.f);
+            inputSample *= 2.f - simd::fabs(inputSample);
             break;
         }
         return inputSample;
     }
 
-    long double decode(long double inputSample, int consoleType = 0)
+    template <int CONSOLE_TYPE>
+    simd::float_4 decode(simd::float_4 inputSample)
     {
-        switch (consoleType) {
+        switch (CONSOLE_TYPE) {
         case PUREST_CONSOLE: // PurestConsoleBuss
-            inputSample = sin(inputSample);
-            inputSample *= 4.0;
+            inputSample = simd::sin(inputSample);
+            inputSample *= 4.f;
             break;
-        case CONSOLE_6: // Console6Buss
-            if (inputSample > 1.0)
-                inputSample = 1.0;
-            else if (inputSample > 0.0)
-                inputSample = 1.0 - pow(1.0 - inputSample, 0.5);
-
-            if (inputSample < -1.0)
-                inputSample = -1.0;
-            else if (inputSample < 0.0)
-                inputSample = -1.0 + pow(1.0 + inputSample, 0.5);
-            inputSample *= 5.0;
+        case CONSOLE_6: // Console6Buss, 1 - (1 - x)^0.5 for positive x, mirrored for negative x
+            inputSample = simd::clamp(inputSample, -1.f, 1.f);
+            inputSample = (1.f - simd::sqrt(1.f - simd::fabs(inputSample))) | (inputSample & -0.f);
+            inputSample *= 5.f;
             break;
         }
         return inputSample;
     }
 
-    float consoleChannel(Input& input, long double mix[], int numChannels)
+    // voices c to c + 3 of an input, with the voices past its channel count zeroed
+    simd::float_4 readVoices(Input& input, int c, int numChannels)
+    {
+        simd::float_4 inputSamples = input.getVoltageSimd<simd::float_4>(c);
+        if (numChannels - c < 4) {
+            inputSamples = simd::ifelse(simd::float_4(c, c + 1, c + 2, c + 3) < numChannels, inputSamples, 0.f);
+        }
+        return inputSamples;
+    }
+
+    template <int QUALITY, int CONSOLE_TYPE>
+    void consoleChannel(Input& input, simd::float_4 mix[], int numChannels)
     {
         if (input.isConnected()) {
-            float sum = 0.0f;
+            for (int c = 0; c < numChannels; c += 4) {
+                // input, only the voices it drives get the denormal guard
+                simd::float_4 inputSample = readVoices(input, c, numChannels);
+                simd::float_4 isActive = simd::float_4(c, c + 1, c + 2, c + 3) < numChannels;
 
-            // input
-            float inputSamples[16] = {};
-            input.readVoltages(inputSamples);
+                // pad gain, will be boosted in consoleBuss()
+                inputSample *= (float)gainCut;
 
-            for (int i = 0; i < numChannels; i++) {
+                if (QUALITY == HIGH) {
+                    inputSample = guardDenormals(inputSample, isActive, &fpd[c], dspStats.denormalGuards);
+                }
 
-                long double inputSample = inputSamples[i];
+                // encode and add to mix
+                mix[c / 4] += encode<CONSOLE_TYPE>(inputSample);
+            }
+        }
+    }
 
-                // inputSample *= rescale(drive, 0, 1, 0.5, 2);
+    template <int QUALITY, int CONSOLE_TYPE>
+    void consoleBuss(Output& output, simd::float_4 mix[], int maxChannels)
+    {
+        if (output.isConnected()) {
+            for (int c = 0; c < maxChannels; c += 4) {
+                // decode
+                simd::float_4 inputSample = decode<CONSOLE_TYPE>(mix[c / 4]);
 
-                // calculate sum for VU meter
-                sum += inputSample;
+                if (QUALITY == HIGH) {
+                    DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
+                    inputSample = ditherFloat(inputSample, &fpd[c]);
+                }
 
-                // pad gain, will be boosted in consoleBuss()
-                inputSample *= gainCut;
+                // bring gain back up
+                inputSample *= (float)gainBoost;
 
-                if (quality == HIGH) {
-                    if (fabs(inputSample) < 1.18e-37)
-                        inputSample = fpd[i] * 1.18e-37;
-                }
+                output.setVoltageSimd(inputSample, c);
+            }
+            output.setChannels(maxChannels);
+        }
+    }
+
+    // encodes each voice at the oversampled rate, mix holds `lastOversampling` frames of 16 voices
+    template <int QUALITY, int CONSOLE_TYPE>
+    void consoleChannelOversampled(Input& input, simd::float_4 mix[][4], int numChannels, rwlib::Oversampler<simd::float_4> oversampler[])
+    {
+        if (input.isConnected()) {
+            for (int c = 0; c < numChannels; c += 4) {
+                simd::float_4 buffer[rwlib::Oversampler<simd::float_4>::maxFactor];
+
+                // input, only the voices it drives get the denormal guard
+                oversampler[c / 4].upsample(readVoices(input, c, numChannels), buffer);
+                simd::float_4 isActive = simd::float_4(c, c + 1, c + 2, c + 3) < numChannels;
+
+                for (int j = 0; j < lastOversampling; j++) {
+                    // pad gain, will be boosted in consoleBussOversampled()
+                    simd::float_4 inputSample = buffer[j] * (float)gainCut;
 
-                // encode
-                inputSample = encode(inputSample, consoleType);
+                    if (QUALITY == HIGH) {
+                        inputSample = guardDenormals(inputSample, isActive, &fpd[c], dspStats.denormalGuards);
+                    }
 
-                // add to mix
-                mix[i] += inputSample;
+                    // encode and add to mix
+                    mix[j][c / 4] += encode<CONSOLE_TYPE>(inputSample);
+                }
             }
-            return sum;
         }
     }
 
-    void consoleBuss(Output& output, long double mix[], int maxChannels)
+    // decodes each voice at the oversampled rate and brings it back down
+    template <int QUALITY, int CONSOLE_TYPE>
+    void consoleBussOversampled(Output& output, simd::float_4 mix[][4], int maxChannels, rwlib::Oversampler<simd::float_4> oversampler[])
     {
         if (output.isConnected()) {
-            float out[16] = {};
+            for (int c = 0; c < maxChannels; c += 4) {
+                simd::float_4 buffer[rwlib::Oversampler<simd::float_4>::maxFactor];
+
+                for (int j = 0; j < lastOversampling; j++) {
+                    // decode
+                    buffer[j] = decode<CONSOLE_TYPE>(mix[j][c / 4]);
+                }
 
-            for (int i = 0; i < maxChannels; i++) {
-                long double inputSample = mix[i];
+                simd::float_4 inputSample = oversampler[c / 4].downsample(buffer);
 
-                // decode
-                inputSample = decode(inputSample, consoleType);
-
-                if (quality == HIGH) {
-                    //begin 32 bit stereo floating point dither
-                    int expon;
-                    frexpf((float)inputSample, &expon);
-                    fpd[i] ^= fpd[i] << 13;
-                    fpd[i] ^= fpd[i] >> 17;
-                    fpd[i] ^= fpd[i] << 5;
-                    inputSample += ((double(fpd[i]) - uint32_t(0x7fffffff)) * 5.5e-36l * pow(2, expon + 62));
+                if (QUALITY == HIGH) {
+                    DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
+                    inputSample = ditherFloat(inputSample, &fpd[c]);
                 }
 
                 // bring gain back up
-                inputSample *= gainBoost;
+                inputSample *= (float)gainBoost;
 
-                out[i] = (float)inputSample;
+                output.setVoltageSimd(inputSample, c);
             }
-
             output.setChannels(maxChannels);
-            output.writeVoltages(out);
         }
     }
 
+    // channel VU lights, the meters only accumulate per sample and are evaluated at the light rate
+    void processMeters(const ProcessArgs& args)
+    {
+        for (int i = 0; i < 9; i++) {
+            vuMeters[i].accumulate(inputs[IN_L_INPUTS + i], inputs[IN_R_INPUTS + i]);
+        }
+        if (lightDivider.process()) {
+            for (int i = 0; i < 9; i++) {
+                vuMeters[i].update(args.sampleTime * lightDivider.getDivision());
+                lights[VU_LIGHTS + i].setBrightness(vuMeters[i].getBrightness(-18.f, 0.f));
+            }
+        }
+    }
+
+    // a neighbour that takes part in the bus (a bypassed module doesn't pass messages on)
+    static bool isBusModule(Module* module)
+    {
+        return module && module->model == modelConsole && !module->bypass;
+    }
+
+    // a Console on the left that hands its mix on to this one
+    static bool isChainedFrom(Module* module)
+    {
+        return isBusModule(module) && static_cast<Console*>(module)->chainRight;
+    }
+
+    // hands the message to the Console on the right, the engine flips it after this sample
+    void sendBus()
+    {
+        busOut->consoleType = busIn ? busIn->consoleType : consoleType;
+        busOut->oversampling = lastOversampling;
+        rightExpander.module->leftExpander.messageFlipRequested = true;
+    }
+
+    void selectKernel(int busConsoleType)
+    {
+        if (quality == HIGH) {
+            kernel = (busConsoleType == PUREST_CONSOLE) ? &Console::processKernel<HIGH, PUREST_CONSOLE> : &Console::processKernel<HIGH, CONSOLE_6>;
+        } else {
+            kernel = (busConsoleType == PUREST_CONSOLE) ? &Console::processKernel<ECO, PUREST_CONSOLE> : &Console::processKernel<ECO, CONSOLE_6>;
+        }
+        kernelQuality = quality;
+        kernelConsoleType = busConsoleType;
+    }
+
     void process(const ProcessArgs& args) override
     {
-        if (outputs[OUT_L_OUTPUT].isConnected() || outputs[OUT_R_OUTPUT].isConnected()) {
-            long double mixL[16] = {};
-            long double mixR[16] = {};
-            float sumL = 0.0;
-            float sumR = 0.0;
-            int numChannelsL = 1;
-            int numChannelsR = 1;
-            int maxChannelsL = 1;
-            int maxChannelsR = 1;
-
-            // for each mixer channel
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
+
+        // Consoles placed side by side with "Chain to right Console" share one encoded mix, from
+        // left to right: each one adds its channels to the mix of its left neighbour and only
+        // the last one decodes. Without the option a Console decodes its own mix as before
+        busIn = isChainedFrom(leftExpander.module) ? (ConsoleBusMessage*)leftExpander.consumerMessage : NULL;
+        busOut = (chainRight && isBusModule(rightExpander.module)) ? (ConsoleBusMessage*)rightExpander.module->leftExpander.producerMessage : NULL;
+
+        // skip the dsp once the inputs and the incoming mix have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs) && (!busIn || busIn->isSilent))) {
+            dspStats.sleep();
             for (int i = 0; i < 9; i++) {
-                numChannelsL = inputs[IN_L_INPUTS + i].getChannels();
-                maxChannelsL = std::max(maxChannelsL, numChannelsL);
-                sumL = consoleChannel(inputs[IN_L_INPUTS + i], mixL, numChannelsL); // encode L
-
-                numChannelsR = inputs[IN_R_INPUTS + i].getChannels();
-                maxChannelsR = std::max(maxChannelsR, numChannelsR);
-                sumR = consoleChannel(inputs[IN_R_INPUTS + i], mixR, numChannelsR); // encode R
-
-                // channel VU light
-                vuMeters[i].process(args.sampleTime, (sumL + sumR) / 5.f);
-                if (lightDivider.process()) {
-                    float b = vuMeters[i].getBrightness(-18.f, 0.f);
-                    lights[VU_LIGHTS + i].setBrightness(b);
+                vuMeters[i].reset();
+                lights[VU_LIGHTS + i].setBrightness(0.f);
+            }
+            clearOutputs(outputs);
+            if (busOut) {
+                busOut->isSilent = true;
+                sendBus();
+            }
+            return;
+        }
+
+        // a chain runs at the console type of its first Console
+        int busConsoleType = busIn ? busIn->consoleType : consoleType;
+        if (quality != kernelQuality || busConsoleType != kernelConsoleType) {
+            selectKernel(busConsoleType);
+        }
+
+        (this->*kernel)(args);
+    }
+
+    template <int QUALITY, int CONSOLE_TYPE>
+    void processKernel(const ProcessArgs& args)
+    {
+        // apply oversampling changes, a chain runs at the oversampling of its first Console
+        int busOversampling = busIn ? busIn->oversampling : oversampling;
+        if (busOversampling != lastOversampling) {
+            setOversampling(busOversampling);
+            lastOversampling = busOversampling;
+            dspStats.oversampling = busOversampling;
+        }
+
+        if (!busOut && !outputs[OUT_L_OUTPUT].isConnected() && !outputs[OUT_R_OUTPUT].isConnected()) {
+            return;
+        }
+
+        // the channels are summed straight into the message for the Console on the right, if
+        // there is one, on top of the mix that came in from the left
+        ConsoleBusMessage& bus = busOut ? *busOut : localBus;
+        if (busIn && !busIn->isSilent) {
+            for (int j = 0; j < lastOversampling; j++) {
+                for (int c = 0; c < 4; c++) {
+                    bus.mixL[j][c] = busIn->mixL[j][c];
+                    bus.mixR[j][c] = busIn->mixR[j][c];
                 }
             }
+            bus.maxChannelsL = busIn->maxChannelsL;
+            bus.maxChannelsR = busIn->maxChannelsR;
+        } else {
+            for (int j = 0; j < lastOversampling; j++) {
+                for (int c = 0; c < 4; c++) {
+                    bus.mixL[j][c] = bus.mixR[j][c] = 0.f;
+                }
+            }
+            bus.maxChannelsL = bus.maxChannelsR = 1;
+        }
+        bus.isSilent = false;
+
+        // for each mixer channel
+        for (int i = 0; i < 9; i++) {
+            int numChannelsL = inputs[IN_L_INPUTS + i].getChannels();
+            int numChannelsR = inputs[IN_R_INPUTS + i].getChannels();
+            bus.maxChannelsL = std::max(bus.maxChannelsL, numChannelsL);
+            bus.maxChannelsR = std::max(bus.maxChannelsR, numChannelsR);
+
+            if (lastOversampling > 1) {
+                consoleChannelOversampled<QUALITY, CONSOLE_TYPE>(inputs[IN_L_INPUTS + i], bus.mixL, numChannelsL, channelOversamplersL[i]); // encode L
+                consoleChannelOversampled<QUALITY, CONSOLE_TYPE>(inputs[IN_R_INPUTS + i], bus.mixR, numChannelsR, channelOversamplersR[i]); // encode R
+            } else {
+                consoleChannel<QUALITY, CONSOLE_TYPE>(inputs[IN_L_INPUTS + i], bus.mixL[0], numChannelsL); // encode L
+                consoleChannel<QUALITY, CONSOLE_TYPE>(inputs[IN_R_INPUTS + i], bus.mixR[0], numChannelsR); // encode R
+            }
+        }
+
+        processMeters(args);
+
+        // not the last Console in the chain, the decoding happens further right
+        if (busOut) {
+            sendBus();
+            clearOutputs(outputs);
+            return;
+        }
 
-            consoleBuss(outputs[OUT_L_OUTPUT], mixL, maxChannelsL); // decode L
-            consoleBuss(outputs[OUT_R_OUTPUT], mixR, maxChannelsR); // decode R
+        if (lastOversampling > 1) {
+            consoleBussOversampled<QUALITY, CONSOLE_TYPE>(outputs[OUT_L_OUTPUT], bus.mixL, bus.maxChannelsL, bussOversamplerL); // decode L
+            consoleBussOversampled<QUALITY, CONSOLE_TYPE>(outputs[OUT_R_OUTPUT], bus.mixR, bus.maxChannelsR, bussOversamplerR); // decode R
+        } else {
+            consoleBuss<QUALITY, CONSOLE_TYPE>(outputs[OUT_L_OUTPUT], bus.mixL[0], bus.maxChannelsL); // decode L
+            consoleBuss<QUALITY, CONSOLE_TYPE>(outputs[OUT_R_OUTPUT], bus.mixR[0], bus.maxChannelsR); // decode R
         }
     }
 };
@@ -288,6 +533,37 @@ struct ConsoleWidget : ModuleWidget {
         }
     };
 
+    // oversampling item
+    struct OversamplingItem : MenuItem {
+        Console* module;
+        int oversampling;
+
+        void onAction(const event::Action& e) override
+        {
+            module->oversampling = oversampling;
+        }
+
+        void step() override
+        {
+            rightText = (module->oversampling == oversampling) ? "✔" : "";
+        }
+    };
+
+    // chain item
+    struct ChainItem : MenuItem {
+        Console* module;
+
+        void onAction(const event::Action& e) override
+        {
+            module->chainRight = !module->chainRight;
+        }
+
+        void step() override
+        {
+            rightText = module->chainRight ? "✔" : "";
+        }
+    };
+
     // struct DriveSlider : ui::Slider {
     //     struct DriveQuantity : Quantity {
     //         Console* module;
@@ -378,6 +654,34 @@ struct ConsoleWidget : ModuleWidget {
         purestConsole->consoleType = PUREST_CONSOLE;
         menu->addChild(purestConsole);
 
+        menu->addChild(new MenuSeparator()); // separator
+
+        MenuLabel* oversamplingLabel = new MenuLabel(); // menu label
+        oversamplingLabel->text = "Oversampling";
+        menu->addChild(oversamplingLabel);
+
+        const char* oversamplingNames[] = { "Off", "2x", "4x", "8x" };
+        for (int i = 0; i < 4; i++) {
+            OversamplingItem* oversamplingItem = new OversamplingItem();
+            oversamplingItem->text = oversamplingNames[i];
+            oversamplingItem->module = module;
+            oversamplingItem->oversampling = 1 << i;
+            menu->addChild(oversamplingItem);
+        }
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        ChainItem* chainItem = new ChainItem(); // chain
+        chainItem->text = "Chain to right Console";
+        chainItem->module = module;
+        menu->addChild(chainItem);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
+
         // menu->addChild(new MenuSeparator()); // separator
 
         // menu->addChild(new DriveSlider(module));
@@ -388,7 +692,7 @@ struct ConsoleWidget : ModuleWidget {
         setModule(module);
 
         // panel
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/console_dark.svg")));
+        setPanel(loadArtwork("console_dark.svg"));
 
         // screws
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH, 0)));
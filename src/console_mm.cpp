@@ -59,9 +59,23 @@ struct Console_mm : Module {
     bool quality;
     int consoleType;
     int directOutMode;
+    float lastLevel;
+    float inputGain;
+    float outputGain;
 
     // state variables (as arrays in order to handle up to 16 polyphonic channels)
-    uint32_t fpd[16];
+    uint32_t fpd[16]; // per voice while encoding, per output sum while decoding
+
+    // other
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
+
+    // process kernel, specialised at compile time for the current quality setting, console type and direct out mode
+    typedef void (Console_mm::*ProcessKernel)(const ProcessArgs& args);
+    ProcessKernel kernel;
+    int kernelQuality;
+    int kernelConsoleType;
+    int kernelDirectOutMode;
 
     Console_mm()
     {
@@ -71,16 +85,28 @@ struct Console_mm : Module {
         quality = loadQuality();
         consoleType = loadConsoleType();
         directOutMode = loadDirectOutMode();
+        kernelQuality = kernelConsoleType = kernelDirectOutMode = -1;
+        setLevel(0.f);
         onReset();
     }
 
     void onReset() override
     {
+        onSampleRateChange();
+
         for (int i = 0; i < 16; i++) {
             fpd[i] = 17;
         }
     }
 
+    void onSampleRateChange() override
+    {
+        float sampleRate = APP->engine->getSampleRate();
+
+        // tail: none, the console is memoryless
+        silenceDetector.setTail(0.0, sampleRate);
+    }
+
     json_t* dataToJson() override
     {
         json_t* rootJ = json_object();
@@ -115,176 +141,193 @@ struct Console_mm : Module {
             consoleType = json_integer_value(consoleTypeJ);
     }
 
-    long double encode(long double inputSample, int consoleType = 0)
+    // All 48 voices are encoded four at a time as float_4 and summed lane by lane: voice i
+    // sits in lane i % 4, so even lanes hold the left channel and odd lanes the right one of
+    // the stereo sum. Only the five sums are brought together and decoded at the end.
+
+    template <int CONSOLE_TYPE>
+    simd::float_4 encode(simd::float_4 inputSample)
     {
-        switch (consoleType) {
+        switch (CONSOLE_TYPE) {
         case PUREST_CONSOLE: // PurestConsoleChannel
-            inputSample = sin(inputSample);
+            inputSample = simd::sin(inputSample);
             break;
-        case CONSOLE_6: // Console6Channel
-            inputSample *= 0.4;
-            if (inputSample > 1.0)
-                inputSample = 1.0;
-            else if (inputSample > 0.0)
-                inputSample = 1.0 - pow(1.0 - inputSample, 2.0);
-
-            if (inputSample < -1.0)
-                inputSample = -1.0;
-            else if (inputSample < 0.0)
-                inputSample = -1.0 + pow(1.0 + inputSample, 2.0);
+        case CONSOLE_6: // Console6Channel, 1 - (1 - x)^2 for positive x, mirrored for negative x
+            inputSample *= 0.4f;
+            inputSample = simd::clamp(inputSample, -1.f, 1.f);
+            inputSample *= 2.f - simd::fabs(inputSample);
             break;
         }
         return inputSample;
     }
 
-    long double decode(long double inputSample, int consoleType = 0)
+    template <int CONSOLE_TYPE>
+    simd::float_4 decode(simd::float_4 inputSample)
     {
-        switch (consoleType) {
+        switch (CONSOLE_TYPE) {
         case PUREST_CONSOLE: // PurestConsoleBuss
             //without this, you can get a NaN condition where it spits out DC offset at full blast!
-            if (inputSample > 1.0)
-                inputSample = 1.0;
-            if (inputSample < -1.0)
-                inputSample = -1.0;
-
-            inputSample = asin(inputSample);
+            inputSample = simd::clamp(inputSample, -1.f, 1.f);
+            inputSample = arcsin(inputSample);
             break;
-        case CONSOLE_6: // Console6Buss
-            if (inputSample > 1.0)
-                inputSample = 1.0;
-            else if (inputSample > 0.0)
-                inputSample = 1.0 - pow(1.0 - inputSample, 0.5);
-
-            if (inputSample < -1.0)
-                inputSample = -1.0;
-            else if (inputSample < 0.0)
-                inputSample = -1.0 + pow(1.0 + inputSample, 0.5);
-            inputSample *= 2.5;
+        case CONSOLE_6: // Console6Buss, 1 - (1 - x)^0.5 for positive x, mirrored for negative x
+            inputSample = simd::clamp(inputSample, -1.f, 1.f);
+            inputSample = (1.f - simd::sqrt(1.f - simd::fabs(inputSample))) | (inputSample & -0.f);
+            inputSample *= 2.5f;
             break;
         }
         return inputSample;
     }
 
+    // asin() for -1 <= x <= 1 with the polynomial of Cephes' asinf, Rack has no vector asin
+    static simd::float_4 arcsin(simd::float_4 x)
+    {
+        simd::float_4 sign = x & -0.f;
+        x = simd::fabs(x);
+        // above 0.5, asin(x) = pi/2 - 2 asin(sqrt((1 - x) / 2))
+        simd::float_4 isUpper = x > 0.5f;
+        simd::float_4 z = simd::ifelse(isUpper, 0.5f * (1.f - x), x * x);
+        x = simd::ifelse(isUpper, simd::sqrt(z), x);
+        simd::float_4 y = ((((4.2163199048e-2f * z + 2.4181311049e-2f) * z + 4.5470025998e-2f) * z + 7.4953002686e-2f) * z + 1.6666752422e-1f) * z * x + x;
+        y = simd::ifelse(isUpper, 1.5707963268f - 2.f * y, y);
+        return y | sign;
+    }
+
+    // input and output gains of the level (drive) knob, resolved when it moves
+    void setLevel(float level)
+    {
+        if (level > 0.f) {
+            inputGain = gainCut * (level + 1);
+            outputGain = gainBoost / (level + 1);
+        } else if (level < 0.f) {
+            inputGain = gainCut / (level - 1);
+            outputGain = gainBoost * (level - 1);
+        } else {
+            inputGain = gainCut;
+            outputGain = gainBoost;
+        }
+        lastLevel = level;
+    }
+
+    void selectKernel()
+    {
+        static const ProcessKernel kernels[2][2][2] = {
+            { { &Console_mm::processKernel<ECO, CONSOLE_6, UNPROCESSED>, &Console_mm::processKernel<ECO, CONSOLE_6, SUMMED> },
+                { &Console_mm::processKernel<ECO, PUREST_CONSOLE, UNPROCESSED>, &Console_mm::processKernel<ECO, PUREST_CONSOLE, SUMMED> } },
+            { { &Console_mm::processKernel<HIGH, CONSOLE_6, UNPROCESSED>, &Console_mm::processKernel<HIGH, CONSOLE_6, SUMMED> },
+                { &Console_mm::processKernel<HIGH, PUREST_CONSOLE, UNPROCESSED>, &Console_mm::processKernel<HIGH, PUREST_CONSOLE, SUMMED> } }
+        };
+
+        kernel = kernels[quality ? HIGH : ECO][consoleType ? PUREST_CONSOLE : CONSOLE_6][directOutMode ? SUMMED : UNPROCESSED];
+        kernelQuality = quality;
+        kernelConsoleType = consoleType;
+        kernelDirectOutMode = directOutMode;
+    }
+
     void process(const ProcessArgs& args) override
     {
-        long double directOutSum[] = { 0.0, 0.0, 0.0 };
-        long double stereoOutSum[] = { 0.0, 0.0 };
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
+
+        // skip the dsp once the inputs have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs))) {
+            dspStats.sleep();
+            clearOutputs(outputs);
+            return;
+        }
+
+        if (quality != kernelQuality || consoleType != kernelConsoleType || directOutMode != kernelDirectOutMode) {
+            selectKernel();
+        }
+
+        (this->*kernel)(args);
+    }
+
+    template <int QUALITY, int CONSOLE_TYPE, int DIRECT_OUT_MODE>
+    void processKernel(const ProcessArgs& args)
+    {
+        float level = params[LEVEL_PARAM].getValue();
+        if (level != lastLevel) {
+            setLevel(level);
+        }
+
+        simd::float_4 stereoOutSum = 0.f;
+        simd::float_4 directOutSum[3];
 
         // for each input
         for (int x = 0; x < 3; x++) {
 
+            directOutSum[x] = 0.f;
+
             int numChannels = inputs[IN_INPUTS + x].getChannels();
             outputs[DIRECT_OUTPUTS + x].setChannels(numChannels);
 
             if (inputs[IN_INPUTS + x].isConnected()) {
 
-                // for each poly channel
-                for (int i = 0; i < std::max(1, numChannels); i++) {
+                // all voices in at once
+                PolyBuffer voices;
+                voices.read(inputs[IN_INPUTS + x]);
 
-                    // get input
-                    long double inputSample = inputs[IN_INPUTS + x].getPolyVoltage(i);
+                if (DIRECT_OUT_MODE == UNPROCESSED) {
+                    // send the input directly to the respective output
+                    voices.write(outputs[DIRECT_OUTPUTS + x]);
+                }
 
-                    if (directOutMode == UNPROCESSED) {
-                        // send the input directly to the respective output
-                        outputs[DIRECT_OUTPUTS + x].setVoltage(inputSample, i);
-                    }
+                // for each group of four poly channels (padded with silence)
+                for (int c = 0; c < voices.channels; c += 4) {
 
-                    // only process if there is a signal
-                    if (inputSample) {
-
-                        // pad gain, will be boosted before output
-                        if (params[LEVEL_PARAM].getValue() > 0.0) {
-                            inputSample *= gainCut * (params[LEVEL_PARAM].getValue() + 1);
-                        } else if (params[LEVEL_PARAM].getValue() < 0.0) {
-                            inputSample *= gainCut / (params[LEVEL_PARAM].getValue() - 1);
-                        } else {
-                            inputSample *= gainCut;
-                        }
-
-                        if (quality == HIGH) {
-                            if (fabs(inputSample) < 1.18e-37)
-                                inputSample = fpd[i] * 1.18e-37;
-                        }
-
-                        // encode
-                        inputSample = encode(inputSample, consoleType);
-
-                        // add alternately to the left or right channel of the stereo sum
-                        stereoOutSum[i % 2] += inputSample;
-
-                        if (directOutMode == SUMMED) {
-                            // add processed sample to respective output sum
-                            directOutSum[x] += inputSample;
-                        }
-                    }
-                }
-            }
-        }
+                    // get input, pad gain, will be boosted before output
+                    simd::float_4 inputSample = voices.getSimd(c) * inputGain;
 
-        if (directOutMode == SUMMED) {
-            // for each direct output in summing mode
-            for (int i = 0; i < 3; i++) {
-                if (outputs[DIRECT_OUTPUTS + i].isConnected()) {
-
-                    // decode
-                    directOutSum[i] = decode(directOutSum[i], consoleType);
-
-                    if (quality == HIGH) {
-                        // 32 bit floating point dither
-                        int expon;
-                        frexpf((float)directOutSum[i], &expon);
-                        fpd[i] ^= fpd[i] << 13;
-                        fpd[i] ^= fpd[i] >> 17;
-                        fpd[i] ^= fpd[i] << 5;
-                        directOutSum[i] += ((double(fpd[i]) - uint32_t(0x7fffffff)) * 5.5e-36l * pow(2, expon + 62));
+                    if (QUALITY == HIGH) {
+                        // silent voices aren't processed
+                        inputSample = guardDenormals(inputSample, inputSample != 0.f, &fpd[c], dspStats.denormalGuards);
                     }
 
-                    // bring gain back up + rough compensation for summing
-                    if (params[LEVEL_PARAM].getValue() > 0.0) {
-                        directOutSum[i] *= gainBoost / (params[LEVEL_PARAM].getValue() + 1) * 0.5;
-                    } else if (params[LEVEL_PARAM].getValue() < 0.0) {
-                        directOutSum[i] *= gainBoost * (params[LEVEL_PARAM].getValue() - 1) * 0.5;
-                    } else {
-                        directOutSum[i] *= gainBoost * 0.5;
+                    // encode, silent voices stay at zero
+                    inputSample = encode<CONSOLE_TYPE>(inputSample);
+
+                    // add to the stereo sum, even lanes left and odd lanes right
+                    stereoOutSum += inputSample;
+
+                    if (DIRECT_OUT_MODE == SUMMED) {
+                        // add processed voices to respective output sum
+                        directOutSum[x] += inputSample;
                     }
                 }
-
-                // outputs
-                outputs[DIRECT_OUTPUTS + i].setVoltage(directOutSum[i]);
             }
         }
 
-        // for each stereo channel
-        for (int i = 0; i < 2; i++) {
-
-            if (outputs[OUT_OUTPUTS + i].isConnected()) {
-
-                // decode
-                stereoOutSum[i] = decode(stereoOutSum[i], consoleType);
+        // gather the sums: { left, right, direct 1, direct 2 } and { direct 3, 0, 0, 0 }
+        __m128 stereoPairs = _mm_add_ps(stereoOutSum.v, _mm_movehl_ps(stereoOutSum.v, stereoOutSum.v));
+        __m128 directSums = _mm_hadd_ps(_mm_hadd_ps(directOutSum[0].v, directOutSum[1].v), _mm_hadd_ps(directOutSum[2].v, _mm_setzero_ps()));
+        simd::float_4 outSums[2] = { _mm_movelh_ps(stereoPairs, directSums), _mm_movehl_ps(_mm_setzero_ps(), directSums) };
+        int numOutSums = (DIRECT_OUT_MODE == SUMMED) ? 2 : 1;
 
-                if (quality == HIGH) {
-                    // 32 bit floating point dither
-                    int expon;
-                    frexpf((float)stereoOutSum[i], &expon);
-                    fpd[i] ^= fpd[i] << 13;
-                    fpd[i] ^= fpd[i] >> 17;
-                    fpd[i] ^= fpd[i] << 5;
-                    stereoOutSum[i] += ((double(fpd[i]) - uint32_t(0x7fffffff)) * 5.5e-36l * pow(2, expon + 62));
-                }
+        for (int k = 0; k < numOutSums; k++) {
+            // decode
+            outSums[k] = decode<CONSOLE_TYPE>(outSums[k]);
 
-                // bring gain back up
-                if (params[LEVEL_PARAM].getValue() > 0.0) {
-                    stereoOutSum[i] *= gainBoost / (params[LEVEL_PARAM].getValue() + 1);
-                } else if (params[LEVEL_PARAM].getValue() < 0.0) {
-                    stereoOutSum[i] *= gainBoost * (params[LEVEL_PARAM].getValue() - 1);
-                } else {
-                    stereoOutSum[i] *= gainBoost;
-                }
+            if (QUALITY == HIGH) {
+                DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
+                // 32 bit floating point dither
+                outSums[k] = ditherFloat(outSums[k], &fpd[4 * k]);
             }
+        }
 
+        // bring gain back up (+ rough compensation for summing on the direct outputs)
+        outSums[0] *= simd::float_4(outputGain, outputGain, outputGain * 0.5f, outputGain * 0.5f);
+        outSums[1] *= outputGain * 0.5f;
+
+        if (DIRECT_OUT_MODE == SUMMED) {
             // outputs
-            outputs[OUT_OUTPUTS + i].setVoltage(stereoOutSum[i]);
+            outputs[DIRECT_OUTPUTS + 0].setVoltage(outSums[0][2]);
+            outputs[DIRECT_OUTPUTS + 1].setVoltage(outSums[0][3]);
+            outputs[DIRECT_OUTPUTS + 2].setVoltage(outSums[1][0]);
         }
+
+        // outputs
+        outputs[OUT_OUTPUTS + 0].setVoltage(outSums[0][0]);
+        outputs[OUT_OUTPUTS + 1].setVoltage(outSums[0][1]);
     }
 };
 
@@ -396,12 +439,18 @@ struct Console_mmWidget : ModuleWidget {
         summed->module = module;
         summed->directOutMode = 1;
         menu->addChild(summed);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
     }
 
     Console_mmWidget(Console_mm* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/console_mm_dark.svg")));
+        setPanel(loadArtwork("console_mm_dark.svg"));
 
         // screws
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH, 0)));
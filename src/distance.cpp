@@ -43,6 +43,7 @@ struct Distance : Module {
     const double gainCut = 0.03125;
     const double gainBoost = 32.0;
     int quality;
+    int oversampling;
 
     // control parameters
     float distanceParam;
@@ -56,9 +57,13 @@ struct Distance : Module {
     double prevresult[16];
     double last[16];
     long double fpNShape[16];
+    rwlib::PolyOversampler oversampler;
 
     // other variables, which do not need to be updated every cycle
     double overallscale;
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
+    rwlib::DitherNoise ditherSource;
     double softslew;
     double filtercorrect;
     double thirdfilter;
@@ -67,6 +72,12 @@ struct Distance : Module {
     double dry;
     float lastDistanceParam;
     float lastDrywetParam;
+    int lastOversampling;
+
+    // process kernel, specialised at compile time for the current quality setting
+    typedef void (Distance::*ProcessKernel)(const ProcessArgs& args);
+    ProcessKernel kernel;
+    int kernelQuality;
 
     Distance()
     {
@@ -75,6 +86,8 @@ struct Distance : Module {
         configParam(DRYWET_PARAM, 0.f, 1.f, 1.f, "Dry/Wet");
 
         quality = loadQuality();
+        oversampling = lastOversampling = 1;
+        kernelQuality = -1;
         onReset();
     }
 
@@ -87,6 +100,9 @@ struct Distance : Module {
             fpNShape[i] = 0.0;
         }
 
+        oversampler.setFactor(oversampling);
+        oversampler.reset();
+
         softslew = 0.0;
         filtercorrect = 0.0;
         thirdfilter = 0.0;
@@ -104,6 +120,12 @@ struct Distance : Module {
         overallscale = 1.0;
         overallscale /= 44100.0;
         overallscale *= sampleRate;
+        overallscale *= oversampling;
+
+        lastDistanceParam = 0.0; // force update of sample rate dependent coefficients
+
+        // tail: none beyond the hold, the slew filters settle within a few samples
+        silenceDetector.setTail(0.0, sampleRate);
     }
 
     json_t* dataToJson() override
@@ -113,6 +135,9 @@ struct Distance : Module {
         // quality
         json_object_set_new(rootJ, "quality", json_integer(quality));
 
+        // oversampling
+        json_object_set_new(rootJ, "oversampling", json_integer(oversampling));
+
         return rootJ;
     }
 
@@ -122,12 +147,115 @@ struct Distance : Module {
         json_t* qualityJ = json_object_get(rootJ, "quality");
         if (qualityJ)
             quality = json_integer_value(qualityJ);
+
+        // oversampling
+        json_t* oversamplingJ = json_object_get(rootJ, "oversampling");
+        if (oversamplingJ)
+            oversampling = rwlib::validOversampling(json_integer_value(oversamplingJ));
+    }
+
+    template <int QUALITY>
+    long double processDistance(long double inputSample, int i)
+    {
+        double postfilter;
+        double bridgerectifier;
+        long double drySample;
+
+        // pad gain
+        inputSample *= gainCut;
+
+        if (QUALITY == HIGH) {
+            inputSample = rwlib::denormalize(inputSample);
+        }
+
+        drySample = inputSample;
+
+        inputSample *= softslew;
+        lastclamp[i] = clasp[i];
+        clasp[i] = inputSample - last[i];
+        postfilter = change[i] = fabs(clasp[i] - lastclamp[i]);
+        postfilter += filtercorrect;
+        if (change[i] > 1.5707963267949)
+            change[i] = 1.5707963267949;
+        bridgerectifier = (1.0 - sin(change[i]));
+        if (bridgerectifier < 0.0)
+            bridgerectifier = 0.0;
+        inputSample = last[i] + (clasp[i] * bridgerectifier);
+        last[i] = inputSample;
+        inputSample /= softslew;
+        inputSample += (thirdresult[i] * thirdfilter);
+        inputSample /= (thirdfilter + 1.0);
+        inputSample += (prevresult[i] * postfilter);
+        inputSample /= (postfilter + 1.0);
+        //do an IIR like thing to further squish superdistant stuff
+        thirdresult[i] = prevresult[i];
+        prevresult[i] = inputSample;
+        inputSample *= levelcorrect;
+
+        if (wet < 1.0) {
+            inputSample = (drySample * dry) + (inputSample * wet);
+        }
+
+        return inputSample;
+    }
+
+    template <int QUALITY>
+    long double ditherAndBoost(long double inputSample, int i)
+    {
+        if (QUALITY == HIGH) {
+            DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
+            //stereo 32 bit dither, made small and tidy.
+            int expon;
+            frexpf((float)inputSample, &expon);
+            long double dither = (ditherSource.next() / 7.737125245533627e+25) * pow(2, expon + 62);
+            inputSample += (dither - fpNShape[i]);
+            fpNShape[i] = dither;
+            //end 32 bit dither
+        }
+
+        // bring gain back up
+        inputSample *= gainBoost;
+
+        return inputSample;
+    }
+
+    void selectKernel()
+    {
+        kernel = (quality == HIGH) ? &Distance::processKernel<HIGH> : &Distance::processKernel<ECO>;
+        kernelQuality = quality;
     }
 
     void process(const ProcessArgs& args) override
+    {
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
+
+        // skip the dsp once the inputs have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs[IN_INPUT]))) {
+            dspStats.sleep();
+            clearOutputs(outputs);
+            return;
+        }
+
+        if (quality != kernelQuality) {
+            selectKernel();
+        }
+
+        (this->*kernel)(args);
+    }
+
+    template <int QUALITY>
+    void processKernel(const ProcessArgs& args)
     {
         if (outputs[OUT_OUTPUT].isConnected()) {
 
+            // apply oversampling changes
+            if (oversampling != lastOversampling) {
+                onSampleRateChange();
+                oversampler.setFactor(oversampling);
+                lastOversampling = oversampling;
+                dspStats.oversampling = oversampling;
+            }
+
             distanceParam = params[DISTANCE_PARAM].getValue();
             distanceParam += inputs[DISTANCE_CV_INPUT].getVoltage() / 5;
             distanceParam = clamp(distanceParam, 0.01f, 0.99f);
@@ -155,94 +283,59 @@ struct Distance : Module {
                 lastDrywetParam = drywetParam;
             }
 
-            double postfilter;
-            double bridgerectifier;
             long double inputSample;
-            long double drySample;
 
             // number of polyphonic channels
             int numChannels = std::max(1, inputs[IN_INPUT].getChannels());
 
-            // for each poly channel
-            for (int i = 0; i < numChannels; i++) {
-
-                // input
-                inputSample = inputs[IN_INPUT].getPolyVoltage(i);
-
-                // pad gain
-                inputSample *= gainCut;
-
-                if (quality == HIGH) {
-                    if (inputSample < 1.2e-38 && -inputSample < 1.2e-38) {
-                        static int noisesource = 0;
-                        //this declares a variable before anything else is compiled. It won't keep assigning
-                        //it to 0 for every sample, it's as if the declaration doesn't exist in this context,
-                        //but it lets me add this denormalization fix in a single place rather than updating
-                        //it in three different locations. The variable isn't thread-safe but this is only
-                        //a random seed and we can share it with whatever.
-                        noisesource = noisesource % 1700021;
-                        noisesource++;
-                        int residue = noisesource * noisesource;
-                        residue = residue % 170003;
-                        residue *= residue;
-                        residue = residue % 17011;
-                        residue *= residue;
-                        residue = residue % 1709;
-                        residue *= residue;
-                        residue = residue % 173;
-                        residue *= residue;
-                        residue = residue % 17;
-                        double applyresidue = residue;
-                        applyresidue *= 0.00000001;
-                        applyresidue *= 0.00000001;
-                        inputSample = applyresidue;
-                    }
-                }
+            if (oversampling == 1) {
+
+                // all voices in at once, processed in place
+                PolyBuffer voices;
+                voices.read(inputs[IN_INPUT]);
+
+                // for each poly channel
+                for (int i = 0; i < numChannels; i++) {
 
-                drySample = inputSample;
-
-                inputSample *= softslew;
-                lastclamp[i] = clasp[i];
-                clasp[i] = inputSample - last[i];
-                postfilter = change[i] = fabs(clasp[i] - lastclamp[i]);
-                postfilter += filtercorrect;
-                if (change[i] > 1.5707963267949)
-                    change[i] = 1.5707963267949;
-                bridgerectifier = (1.0 - sin(change[i]));
-                if (bridgerectifier < 0.0)
-                    bridgerectifier = 0.0;
-                inputSample = last[i] + (clasp[i] * bridgerectifier);
-                last[i] = inputSample;
-                inputSample /= softslew;
-                inputSample += (thirdresult[i] * thirdfilter);
-                inputSample /= (thirdfilter + 1.0);
-                inputSample += (prevresult[i] * postfilter);
-                inputSample /= (postfilter + 1.0);
-                //do an IIR like thing to further squish superdistant stuff
-                thirdresult[i] = prevresult[i];
-                prevresult[i] = inputSample;
-                inputSample *= levelcorrect;
-
-                if (wet < 1.0) {
-                    inputSample = (drySample * dry) + (inputSample * wet);
+                    // input
+                    inputSample = voices[i];
+
+                    // work the magic
+                    inputSample = processDistance<QUALITY>(inputSample, i);
+
+                    inputSample = ditherAndBoost<QUALITY>(inputSample, i);
+
+                    // output
+                    voices[i] = inputSample;
                 }
 
-                if (quality == HIGH) {
-                    //stereo 32 bit dither, made small and tidy.
-                    int expon;
-                    frexpf((float)inputSample, &expon);
-                    long double dither = (rand() / (RAND_MAX * 7.737125245533627e+25)) * pow(2, expon + 62);
-                    inputSample += (dither - fpNShape[i]);
-                    fpNShape[i] = dither;
-                    //end 32 bit dither
+                voices.write(outputs[OUT_OUTPUT]);
+            } else {
+                float buffer[rwlib::PolyOversampler::maxFactor][rwlib::maxLanes];
+
+                // all voices in at once, processed in place
+                PolyBuffer voices;
+                voices.read(inputs[IN_INPUT]);
+
+                oversampler.upsample(voices.voltages, buffer, numChannels);
+
+                // work the magic at the oversampled rate
+                for (int j = 0; j < oversampling; j++) {
+                    for (int i = 0; i < numChannels; i++) {
+                        buffer[j][i] = processDistance<QUALITY>(buffer[j][i], i);
+                    }
                 }
 
-                // bring gain back up
-                inputSample *= gainBoost;
+                oversampler.downsample(buffer, voices.voltages, numChannels);
+
+                for (int i = 0; i < numChannels; i++) {
+                    inputSample = ditherAndBoost<QUALITY>(voices[i], i);
 
-                // output
-                outputs[OUT_OUTPUT].setChannels(numChannels);
-                outputs[OUT_OUTPUT].setVoltage(inputSample, i);
+                    // output
+                    voices[i] = inputSample;
+                }
+
+                voices.write(outputs[OUT_OUTPUT]);
             }
         }
     }
@@ -266,6 +359,22 @@ struct DistanceWidget : ModuleWidget {
         }
     };
 
+    // oversampling item
+    struct OversamplingItem : MenuItem {
+        Distance* module;
+        int oversampling;
+
+        void onAction(const event::Action& e) override
+        {
+            module->oversampling = oversampling;
+        }
+
+        void step() override
+        {
+            rightText = (module->oversampling == oversampling) ? "✔" : "";
+        }
+    };
+
     void appendContextMenu(Menu* menu) override
     {
         Distance* module = dynamic_cast<Distance*>(this->module);
@@ -288,12 +397,33 @@ struct DistanceWidget : ModuleWidget {
         high->module = module;
         high->quality = 1;
         menu->addChild(high);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        MenuLabel* oversamplingLabel = new MenuLabel(); // menu label
+        oversamplingLabel->text = "Oversampling";
+        menu->addChild(oversamplingLabel);
+
+        const char* oversamplingNames[] = { "Off", "2x", "4x", "8x" };
+        for (int i = 0; i < 4; i++) {
+            OversamplingItem* oversamplingItem = new OversamplingItem();
+            oversamplingItem->text = oversamplingNames[i];
+            oversamplingItem->module = module;
+            oversamplingItem->oversampling = 1 << i;
+            menu->addChild(oversamplingItem);
+        }
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
     }
 
     DistanceWidget(Distance* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/distance_dark.svg")));
+        setPanel(loadArtwork("distance_dark.svg"));
 
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH * 1.5, 0)));
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH * 1.5, RACK_GRID_HEIGHT - RACK_GRID_WIDTH)));
@@ -53,13 +53,26 @@ struct Golem : Module {
     int offsetScaling;
 
     // control parameters
-    float balanceParam;
-    float offsetParam;
     float phaseParam;
 
     // state variables
-    rwlib::GolemBCN golem;
-    long double fpNShape;
+    // one delay line per group of four voices, voice-interleaved: a ring of 2048 samples (the
+    // longest offset is 700). A group's memory is only touched once one of its voices is active
+    static const int lineLength = 2048;
+    rwlib::DelayBuffer<simd::float_4, lineLength> lines[4];
+    int count;
+    int numActiveVoices;
+    simd::float_4 fpNShape[4];
+
+    // other
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
+    rwlib::DitherNoise ditherSource;
+
+    // process kernel, specialised at compile time for the current quality setting
+    typedef void (Golem::*ProcessKernel)(const ProcessArgs& args);
+    ProcessKernel kernel;
+    int kernelQuality;
 
     Golem()
     {
@@ -71,6 +84,7 @@ struct Golem : Module {
         configParam(PHASE_PARAM, 0.f, 2.f, 0.f, "Phase");
 
         quality = ECO;
+        kernelQuality = -1;
         delayMode = DI;
         balanceTrimRange = BIPOLAR;
         offsetTrimRange = BIPOLAR;
@@ -80,12 +94,24 @@ struct Golem : Module {
 
     void onReset() override
     {
-        balanceParam = 0.f;
-        offsetParam = 0.f;
+        onSampleRateChange();
+
         phaseParam = 0.f;
 
-        golem = rwlib::GolemBCN();
-        fpNShape = 0.0;
+        for (int i = 0; i < 4; i++) {
+            lines[i].clear();
+            fpNShape[i] = 0.f;
+        }
+        count = 0;
+        numActiveVoices = 0;
+    }
+
+    void onSampleRateChange() override
+    {
+        float sampleRate = APP->engine->getSampleRate();
+
+        // tail: bounded by the delay buffer
+        silenceDetector.setTail(lineLength, sampleRate);
     }
 
     json_t* dataToJson() override
@@ -138,63 +164,164 @@ struct Golem : Module {
             offsetScaling = json_integer_value(offsetScalingJ);
     }
 
+    void selectKernel()
+    {
+        kernel = (quality == HIGH) ? &Golem::processKernel<HIGH> : &Golem::processKernel<ECO>;
+        kernelQuality = quality;
+    }
+
     void process(const ProcessArgs& args) override
+    {
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
+
+        // phase lights
+        lights[PHASE_A_LIGHT].setBrightness(params[PHASE_PARAM].getValue() == 1 ? 1.f : 0.f);
+        lights[PHASE_B_LIGHT].setBrightness(params[PHASE_PARAM].getValue() == 2 ? 1.f : 0.f);
+
+        // skip the dsp once the inputs have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs[IN_A_INPUT]) && isSilent(inputs[IN_B_INPUT]))) {
+            dspStats.sleep();
+            clearOutputs(outputs);
+            return;
+        }
+
+        if (quality != kernelQuality) {
+            selectKernel();
+        }
+
+        (this->*kernel)(args);
+    }
+
+    // zero one voice of a group's line, leaving the other three as they are
+    static void clearLane(rwlib::DelayBuffer<simd::float_4, lineLength>& line, int lane)
+    {
+        for (int i = 0; i < lineLength; i++) {
+            simd::float_4 frame = line.read(i);
+            frame[lane] = 0.f;
+            line.write(i, frame);
+        }
+    }
+
+    template <int QUALITY>
+    void processKernel(const ProcessArgs& args)
     {
         // set trimpot range according to settings
         float balanceTrimParam = balanceTrimRange == UNIPOLAR ? (params[BALANCE_TRIM_PARAM].getValue() + 1) * 0.5 : params[BALANCE_TRIM_PARAM].getValue();
         float offsetTrimParam = offsetTrimRange == UNIPOLAR ? (params[OFFSET_TRIM_PARAM].getValue() + 1) * 0.5 : params[OFFSET_TRIM_PARAM].getValue();
 
-        // get params
-        balanceParam = params[BALANCE_PARAM].getValue();
-        balanceParam += inputs[BALANCE_CV_INPUT].getVoltage() * balanceTrimParam / 5;
-        balanceParam = clamp(balanceParam, -1.f, 1.f);
-
-        offsetParam = params[OFFSET_PARAM].getValue();
-        offsetParam += inputs[OFFSET_CV_INPUT].getVoltage() * offsetTrimParam / 5;
-        offsetParam = clamp(offsetParam, -1.f, 1.f);
-
         phaseParam = params[PHASE_PARAM].getValue();
 
-        // phase lights
-        lights[PHASE_A_LIGHT].setBrightness(phaseParam == 1 ? 1.f : 0.f);
-        lights[PHASE_B_LIGHT].setBrightness(phaseParam == 2 ? 1.f : 0.f);
-
         // set phase parameter according to delay mode settings
         if (phaseParam) {
             phaseParam += delayMode ? 0.f : 2.f;
         }
+        int phase = (int)phaseParam;
+        float range = (phase == 3 || phase == 4) ? 700.f : 30.f;
+
+        // one voice per A/B pair, a monophonic input or CV is shared by all voices
+        int numVoices = std::max(1, std::max(inputs[IN_A_INPUT].getChannels(), inputs[IN_B_INPUT].getChannels()));
+
+        // voices that come in start from a silent line: a new group is cleared as a whole, a new
+        // voice in a running group has its lane zeroed
+        for (int i = numActiveVoices; i < numVoices; i++) {
+            if (i % 4 == 0) {
+                lines[i / 4].clear();
+            } else {
+                clearLane(lines[i / 4], i % 4);
+            }
+            fpNShape[i / 4][i % 4] = 0.f;
+        }
+        numActiveVoices = numVoices;
 
-        // get input
-        long double inputSampleA = inputs[IN_A_INPUT].getVoltage();
-        long double inputSampleB = inputs[IN_B_INPUT].getVoltage();
+        if (count < 1 || count > lineLength) {
+            count = lineLength;
+        }
+        int writeIndex = count & (lineLength - 1);
 
-        // pad gain
-        inputSampleA *= gainCut;
-        inputSampleB *= gainCut;
+        for (int c = 0; c < numVoices; c += 4) {
+            int numLanes = std::min(4, numVoices - c);
 
-        if (quality == HIGH) {
-            inputSampleA = rwlib::denormalize(inputSampleA);
-            inputSampleB = rwlib::denormalize(inputSampleB);
-        }
+            // zero a little more of the delay memory left stale by the last clear
+            rwlib::DelayBuffer<simd::float_4, lineLength>& line = lines[c / 4];
+            line.sweep();
 
-        // work the magic
-        long double outputSample = golem.process(inputSampleA, inputSampleB, balanceParam, offsetParam, phaseParam, offsetScaling);
+            // get params
+            simd::float_4 balance = params[BALANCE_PARAM].getValue() + inputs[BALANCE_CV_INPUT].getPolyVoltageSimd<simd::float_4>(c) * balanceTrimParam / 5;
+            balance = simd::clamp(balance, -1.f, 1.f);
+
+            simd::float_4 offset = params[OFFSET_PARAM].getValue() + inputs[OFFSET_CV_INPUT].getPolyVoltageSimd<simd::float_4>(c) * offsetTrimParam / 5;
+            offset = simd::clamp(offset, -1.f, 1.f);
+
+            // offset in samples, linear or exponential
+            if (offsetScaling == EXPONENTIAL) {
+                offset = offset * offset * offset;
+            }
+            offset *= range;
+
+            // get input, pad gain
+            simd::float_4 inputSampleA = inputs[IN_A_INPUT].getPolyVoltageSimd<simd::float_4>(c) * (float)gainCut;
+            simd::float_4 inputSampleB = inputs[IN_B_INPUT].getPolyVoltageSimd<simd::float_4>(c) * (float)gainCut;
+
+            if (QUALITY == HIGH) {
+                inputSampleA = denormalize(inputSampleA, numLanes);
+                inputSampleB = denormalize(inputSampleB, numLanes);
+            }
 
-        if (quality == HIGH) {
-            //stereo 32 bit dither, made small and tidy.
-            int expon;
-            frexpf((float)outputSample, &expon);
-            long double dither = (rand() / (RAND_MAX * 7.737125245533627e+25)) * pow(2, expon + 62);
-            outputSample += (dither - fpNShape);
-            fpNShape = dither;
+            // phase and balance
+            if (phase == 1 || phase == 3) {
+                inputSampleA = -inputSampleA;
+            }
+            if (phase == 2 || phase == 4) {
+                inputSampleB = -inputSampleB;
+            }
+            inputSampleA *= 0.5f - balance * 0.5f;
+            inputSampleB *= 0.5f + balance * 0.5f;
+
+            // A is delayed for a positive offset, B for a negative one, by the fractional
+            // offset: the samples either side of it, weighted by how near they are
+            simd::float_4 isDelayedA = offset > 0.f;
+            simd::float_4 isDelayedB = offset < 0.f;
+            simd::float_4 delayed = simd::ifelse(isDelayedA, inputSampleA, inputSampleB);
+            simd::float_4 distance = simd::fabs(offset);
+            simd::float_4 near = simd::floor(distance);
+            simd::float_4 farLevel = distance - near;
+            simd::int32_4 nearIndex = (simd::int32_4(near) + simd::int32_4(count)) & simd::int32_4(lineLength - 1);
+            simd::int32_4 farIndex = (nearIndex + simd::int32_4(1)) & simd::int32_4(lineLength - 1);
+
+            // voices at zero offset leave their lane of the line as it is
+            line.write(writeIndex, simd::ifelse(offset != 0.f, delayed, line.read(writeIndex)));
+
+            simd::float_4 nearSample = 0.f;
+            simd::float_4 farSample = 0.f;
+            for (int k = 0; k < numLanes; k++) {
+                if (offset[k] != 0.f) {
+                    nearSample[k] = line.read(nearIndex[k])[k];
+                    farSample[k] = line.read(farIndex[k])[k];
+                }
+            }
+            delayed = nearSample * (1.f - farLevel) + farSample * farLevel;
+            inputSampleA = simd::ifelse(isDelayedA, delayed, inputSampleA);
+            inputSampleB = simd::ifelse(isDelayedB, delayed, inputSampleB);
+
+            simd::float_4 outputSample = inputSampleA + inputSampleB;
+
+            if (QUALITY == HIGH) {
+                DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
+                outputSample = ditherNoiseShaped(outputSample, ditherSource, fpNShape[c / 4]);
+            }
+
+            // bring levels back up
+            outputSample *= (float)gainBoost;
+
+            // output
+            outputs[OUT_POS_OUTPUT].setVoltageSimd(outputSample, c);
+            outputs[OUT_NEG_OUTPUT].setVoltageSimd(-outputSample, c);
         }
 
-        // bring levels back up
-        outputSample *= gainBoost;
+        count--;
 
-        // output
-        outputs[OUT_POS_OUTPUT].setVoltage(outputSample);
-        outputs[OUT_NEG_OUTPUT].setVoltage(-outputSample);
+        outputs[OUT_POS_OUTPUT].setChannels(numVoices);
+        outputs[OUT_NEG_OUTPUT].setChannels(numVoices);
     }
 };
 
@@ -377,12 +504,18 @@ struct GolemWidget : ModuleWidget {
         OffsetScalingItem* offsetScalingItem = createMenuItem<OffsetScalingItem>("Offset Scaling", RIGHT_ARROW);
         offsetScalingItem->module = module;
         menu->addChild(offsetScalingItem);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
     }
 
     GolemWidget(Golem* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/golem_dark.svg")));
+        setPanel(loadArtwork("golem_dark.svg"));
 
         //screws
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH, 0)));
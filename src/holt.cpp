@@ -28,192 +28,336 @@ See ./LICENSE.md for all licenses
 #define ECO 0
 #define HIGH 1
 
-/* Engine (the audio plugin code, single channel)
+// decimation options
+#define DECIMATION_OFF 0
+#define DECIMATION_AUTO 1
+
+/* Engine (the audio plugin code, all voices)
 ======================================================================================== */
+// The coefficients follow the knobs and CVs, which are the same for all voices, so they are
+// computed once per change for the whole module. The four cascaded stages run on four voices
+// at a time, one group per float_4. NUM_POLES is the number of stages engaged: the last one
+// is blended in by the poles setting, the ones after it are bypassed.
+//
+// At high sample rates the stages can also run at a reduced rate (see Decimator). Each stage
+// is a linear two-state system, so one step at 1/factor of the rate is `factor` steps at the
+// full rate, with the input ramping linearly from the last reduced-rate sample to the new
+// one: the state matrix to the power of factor, and two input gains for the two samples.
+// That keeps the response of the full rate within the band, as long as the cutoff is well
+// below the reduced rate.
 struct HoltEngine {
 
-    long double previousSampleA;
-    long double previousTrendA;
-    long double previousSampleB;
-    long double previousTrendB;
-    long double previousSampleC;
-    long double previousTrendC;
-    long double previousSampleD;
-    long double previousTrendD;
-
-    double alpha;
-    double beta;
+    simd::float_4 previousSample[4][4]; // [stage][group]
+    simd::float_4 previousTrend[4][4];
+    simd::float_4 previousInput[4]; // at the reduced rate
+
+    float alpha;
+    float beta;
+    float cutoff; // radians per sample: alpha, or the resonance where it's higher
     float lastFrequencyParam;
     float lastResonanceParam;
 
+    // reduced rate: sample and trend from the last sample and trend, the input and the last input
+    float sampleGains[4];
+    float trendGains[4];
+    int decimation;
+
     HoltEngine()
     {
-        previousSampleA = 0.0;
-        previousTrendA = 0.0;
-        previousSampleB = 0.0;
-        previousTrendB = 0.0;
-        previousSampleC = 0.0;
-        previousTrendC = 0.0;
-        previousSampleD = 0.0;
-        previousTrendD = 0.0;
-
-        alpha = 0.0;
-        beta = 0.0;
-        lastFrequencyParam = 0.0f;
-        lastResonanceParam = 0.0f;
+        reset();
+    }
+
+    void reset()
+    {
+        for (int i = 0; i < 4; i++) {
+            for (int g = 0; g < 4; g++) {
+                previousSample[i][g] = 0.f;
+                previousTrend[i][g] = 0.f;
+            }
+            previousInput[i] = 0.f;
+        }
+
+        alpha = 0.f;
+        beta = 0.f;
+        cutoff = 0.f;
+        lastFrequencyParam = 0.f;
+        lastResonanceParam = 0.f;
+        decimation = 0;
     }
 
-    long double process(long double inputSample, float frequencyParam = 1.0, float resonanceParam = 0.0, float polesParam = 1.0, float outputParam = 1.0, float drywetParam = 1.0)
+    // once per sample, before process()
+    void setParams(float frequencyParam, float resonanceParam)
     {
         if ((frequencyParam != lastFrequencyParam) || (resonanceParam != lastResonanceParam)) {
-            alpha = pow(frequencyParam, 4) + 0.00001;
+            double alpha = pow(frequencyParam, 4) + 0.00001;
             if (alpha > 1.0) {
                 alpha = 1.0;
             }
 
-            beta = (alpha * pow(resonanceParam, 2)) + 0.00001;
+            double beta = (alpha * pow(resonanceParam, 2)) + 0.00001;
             alpha += ((1.0 - beta) * pow(frequencyParam, 3)); //correct for droop in frequency
             if (alpha > 1.0) {
                 alpha = 1.0;
             }
 
+            // the resonance is at the angle of the poles, the eigenvalues of the state matrix
+            // (see setDecimation()), if they are complex
+            double trace = (0.999 - alpha) + (0.999 - beta);
+            double determinant = (0.999 - alpha) * 0.999;
+            double cosine = trace / (2.0 * sqrt(determinant));
+            double resonance = (cosine < 1.0) ? acos(cosine) : 0.0;
+
+            this->alpha = alpha;
+            this->beta = beta;
+            cutoff = std::max(alpha, resonance);
             lastFrequencyParam = frequencyParam;
             lastResonanceParam = resonanceParam;
+            decimation = 0; // the reduced rate gains follow
         }
+    }
 
-        long double trend;
-        long double forecast; //defining these here because we're copying the routine four times
-
-        //four-stage wet/dry control using progressive stages that bypass when not engaged
-        double aWet = 1.0;
-        double bWet = 1.0;
-        double cWet = 1.0;
-        double dWet = polesParam * 4.0;
-
-        if (dWet < 1.0) {
-            aWet = dWet;
-            bWet = 0.0;
-            cWet = 0.0;
-            dWet = 0.0;
-        } else if (dWet < 2.0) {
-            bWet = dWet - 1.0;
-            cWet = 0.0;
-            dWet = 0.0;
-        } else if (dWet < 3.0) {
-            cWet = dWet - 2.0;
-            dWet = 0.0;
-        } else {
-            dWet -= 3.0;
+    // after setParams(), for processDecimated() at 1/factor of the rate
+    void setDecimation(int factor)
+    {
+        if (factor == decimation) {
+            return;
         }
-        //this is one way to make a little set of dry/wet stages that are successively added to the
-        //output as the control is turned up. Each one independently goes from 0-1 and stays at 1
-        //beyond that point: this is a way to progressively add a 'black box' sound processing
-        //which lets you fall through to simpler processing at lower settings.
-
-        double gain = outputParam;
-        double wet = drywetParam;
-
-        long double drySample = inputSample;
-
-        if (aWet > 0.0) {
-            trend = (beta * (inputSample - previousSampleA) + ((0.999 - beta) * previousTrendA));
-            forecast = previousSampleA + previousTrendA;
-            inputSample = (alpha * inputSample) + ((0.999 - alpha) * forecast);
-            previousSampleA = inputSample;
-            previousTrendA = trend;
-            inputSample = (inputSample * aWet) + (drySample * (1.0 - aWet));
+        decimation = factor;
+
+        // full rate: state = a * state + b * input, the state being sample and trend
+        double a[2][2] = { { 0.999 - alpha, 0.999 - alpha }, { -beta, 0.999 - beta } };
+        double b[2] = { alpha, beta };
+
+        // the input of full rate step k (0 to factor - 1) is weighted (k + 1) / factor with
+        // the new input and the rest with the last one, and goes through a^(factor - 1 - k)
+        double power[2][2] = { { 1.0, 0.0 }, { 0.0, 1.0 } };
+        double inputGain[2] = { 0.0, 0.0 };
+        double lastInputGain[2] = { 0.0, 0.0 };
+        for (int k = factor - 1; k >= 0; k--) {
+            double weight = (k + 1) / (double)factor;
+            for (int i = 0; i < 2; i++) {
+                double gain = power[i][0] * b[0] + power[i][1] * b[1];
+                inputGain[i] += weight * gain;
+                lastInputGain[i] += (1.0 - weight) * gain;
+            }
+            double next[2][2];
+            for (int i = 0; i < 2; i++) {
+                for (int j = 0; j < 2; j++) {
+                    next[i][j] = power[i][0] * a[0][j] + power[i][1] * a[1][j];
+                }
+            }
+            std::memcpy(power, next, sizeof(power));
         }
 
-        if (bWet > 0.0) {
-            trend = (beta * (inputSample - previousSampleB) + ((0.999 - beta) * previousTrendB));
-            forecast = previousSampleB + previousTrendB;
-            inputSample = (alpha * inputSample) + ((0.999 - alpha) * forecast);
-            previousSampleB = inputSample;
-            previousTrendB = trend;
-            inputSample = (inputSample * bWet) + (previousSampleA * (1.0 - bWet));
+        // power is a^factor now
+        for (int i = 0; i < 2; i++) {
+            float* gains = (i == 0) ? sampleGains : trendGains;
+            gains[0] = power[i][0];
+            gains[1] = power[i][1];
+            gains[2] = inputGain[i];
+            gains[3] = lastInputGain[i];
         }
+    }
 
-        if (cWet > 0.0) {
-            trend = (beta * (inputSample - previousSampleC) + ((0.999 - beta) * previousTrendC));
-            forecast = previousSampleC + previousTrendC;
-            inputSample = (alpha * inputSample) + ((0.999 - alpha) * forecast);
-            previousSampleC = inputSample;
-            previousTrendC = trend;
-            inputSample = (inputSample * cWet) + (previousSampleB * (1.0 - cWet));
-        }
+    //four-stage wet/dry control using progressive stages that bypass when not engaged:
+    //each one independently goes from 0-1 and stays at 1 beyond that point, a way to
+    //progressively add a 'black box' sound processing which lets you fall through to
+    //simpler processing at lower settings
+    static int getNumPoles(float polesParam)
+    {
+        return clamp((int)(polesParam * 4.f) + 1, 1, 4);
+    }
+
+    // blend of the last engaged stage
+    static float getLastPoleWet(float polesParam, int numPoles)
+    {
+        return polesParam * 4.f - (numPoles - 1);
+    }
 
-        if (dWet > 0.0) {
-            trend = (beta * (inputSample - previousSampleD) + ((0.999 - beta) * previousTrendD));
-            forecast = previousSampleD + previousTrendD;
-            inputSample = (alpha * inputSample) + ((0.999 - alpha) * forecast);
-            previousSampleD = inputSample;
-            previousTrendD = trend;
-            inputSample = (inputSample * dWet) + (previousSampleC * (1.0 - dWet));
+    template <int NUM_POLES>
+    simd::float_4 process(simd::float_4 inputSample, float lastPoleWet, int g)
+    {
+        // the dry sample of each stage is the output of the one before
+        simd::float_4 drySample = inputSample;
+
+        for (int i = 0; i < NUM_POLES; i++) {
+            simd::float_4 trend = (beta * (inputSample - previousSample[i][g]) + ((0.999f - beta) * previousTrend[i][g]));
+            simd::float_4 forecast = previousSample[i][g] + previousTrend[i][g];
+            drySample = inputSample;
+            inputSample = (alpha * inputSample) + ((0.999f - alpha) * forecast);
+            previousSample[i][g] = inputSample;
+            previousTrend[i][g] = trend;
         }
+        return (inputSample * lastPoleWet) + (drySample * (1.f - lastPoleWet));
+    }
 
-        if (gain < 1.0) {
-            inputSample *= gain;
+    // the same at the reduced rate set by setDecimation(), one sample per `decimation` samples
+    template <int NUM_POLES>
+    simd::float_4 processDecimated(simd::float_4 inputSample, float lastPoleWet, int g)
+    {
+        simd::float_4 drySample = inputSample;
+        simd::float_4 lastInputSample = previousInput[g];
+        previousInput[g] = inputSample;
+
+        for (int i = 0; i < NUM_POLES; i++) {
+            simd::float_4 sample = sampleGains[0] * previousSample[i][g] + sampleGains[1] * previousTrend[i][g] + sampleGains[2] * inputSample + sampleGains[3] * lastInputSample;
+            simd::float_4 trend = trendGains[0] * previousSample[i][g] + trendGains[1] * previousTrend[i][g] + trendGains[2] * inputSample + trendGains[3] * lastInputSample;
+            lastInputSample = previousSample[i][g]; // the last input of the next stage
+            drySample = inputSample;
+            inputSample = sample;
+            previousSample[i][g] = sample;
+            previousTrend[i][g] = trend;
         }
+        return (inputSample * lastPoleWet) + (drySample * (1.f - lastPoleWet));
+    }
 
+    static simd::float_4 clip(simd::float_4 inputSample)
+    {
         //clip to 1.2533141373155 to reach maximum output
-        if (inputSample > 1.2533141373155)
-            inputSample = 1.2533141373155;
-        if (inputSample < -1.2533141373155)
-            inputSample = -1.2533141373155;
-        inputSample = sin(inputSample * fabs(inputSample)) / ((inputSample == 0.0) ? 1 : fabs(inputSample));
+        inputSample = simd::clamp(inputSample, -1.2533141373155f, 1.2533141373155f);
+        simd::float_4 magnitude = simd::fabs(inputSample);
+        return simd::sin(inputSample * magnitude) / simd::ifelse(inputSample == 0.f, 1.f, magnitude);
+    }
+};
+
+/* Decimator
+======================================================================================== */
+// Takes four voices down to 1/factor of the rate and back up through cascaded half-band
+// filters (see rwlib::Oversampler, run the other way round). It works in blocks of factor
+// samples, so whatever runs at the reduced rate comes out factor samples late.
+//
+// The stage next to the reduced rate gets away with the wide transition band of the later
+// oversampling stages: what it lets through near the reduced Nyquist frequency aliases to
+// far above the cutoff, and the four poles take it out again.
+struct Decimator {
+    static const int maxFactor = 8;
+
+    rwlib::HalfBand<simd::float_4, 4> downStage2x, upStage2x;
+    rwlib::HalfBand<simd::float_4, 3> downStage4x, upStage4x;
+    rwlib::HalfBand<simd::float_4, 3> downStage8x, upStage8x;
+    int factor;
+    simd::float_4 inputSamples[maxFactor];
+    simd::float_4 outputSamples[maxFactor];
+
+    Decimator()
+        : downStage2x(rwlib::halfBandCoefs4x), upStage2x(rwlib::halfBandCoefs4x), downStage4x(rwlib::halfBandCoefs8x), upStage4x(rwlib::halfBandCoefs8x), downStage8x(rwlib::halfBandCoefs8x), upStage8x(rwlib::halfBandCoefs8x)
+    {
+        reset(1, 0.f, 0.f);
+    }
+
+    // factor 1, 2, 4 or 8; when it changes, it starts from the signals as they are, held
+    // constant, so the switch doesn't start from silence
+    void reset(int factor, simd::float_4 inputSample, simd::float_4 outputSample)
+    {
+        this->factor = factor;
+        downStage2x.reset(inputSample);
+        downStage4x.reset(inputSample);
+        downStage8x.reset(inputSample);
+        upStage2x.reset(outputSample);
+        upStage4x.reset(outputSample);
+        upStage8x.reset(outputSample);
+        for (int i = 0; i < maxFactor; i++) {
+            inputSamples[i] = inputSample;
+            outputSamples[i] = outputSample;
+        }
+    }
 
-        if (wet < 1.0) {
-            inputSample = (inputSample * wet) + (drySample * (1.0 - wet));
+    // the block of input samples down to one sample
+    simd::float_4 downsample()
+    {
+        simd::float_4 buffer2x[2];
+        simd::float_4 buffer4x[4];
+        switch (factor) {
+        case 2:
+            return downStage2x.downsample(inputSamples);
+        case 4:
+            buffer2x[0] = downStage4x.downsample(inputSamples);
+            buffer2x[1] = downStage4x.downsample(inputSamples + 2);
+            return downStage2x.downsample(buffer2x);
+        default:
+            for (int i = 0; i < 4; i++) {
+                buffer4x[i] = downStage8x.downsample(inputSamples + 2 * i);
+            }
+            buffer2x[0] = downStage4x.downsample(buffer4x);
+            buffer2x[1] = downStage4x.downsample(buffer4x + 2);
+            return downStage2x.downsample(buffer2x);
         }
+    }
 
-        return inputSample;
+    // one sample up to the next block of output samples
+    void upsample(simd::float_4 inputSample)
+    {
+        simd::float_4 buffer2x[2];
+        simd::float_4 buffer4x[4];
+        switch (factor) {
+        case 2:
+            upStage2x.upsample(inputSample, outputSamples);
+            break;
+        case 4:
+            upStage2x.upsample(inputSample, buffer2x);
+            upStage4x.upsample(buffer2x[0], outputSamples);
+            upStage4x.upsample(buffer2x[1], outputSamples + 2);
+            break;
+        default:
+            upStage2x.upsample(inputSample, buffer2x);
+            upStage4x.upsample(buffer2x[0], buffer4x);
+            upStage4x.upsample(buffer2x[1], buffer4x + 2);
+            for (int i = 0; i < 4; i++) {
+                upStage8x.upsample(buffer4x[i], outputSamples + 2 * i);
+            }
+            break;
+        }
     }
 };
 
 /* Dither Noise
 ======================================================================================== */
-inline long double ditherNoise(long double in)
-{
-    //for live air, we always apply the dither noise. Then, if our result is
-    //effectively digital black, we'll subtract it again. We want a 'air' hiss
-
-    static int noisesource = 0;
-    int residue;
-    double applyresidue;
-
-    noisesource = noisesource % 1700021;
-    noisesource++;
-    residue = noisesource * noisesource;
-    residue = residue % 170003;
-    residue *= residue;
-    residue = residue % 17011;
-    residue *= residue;
-    residue = residue % 1709;
-    residue *= residue;
-    residue = residue % 173;
-    residue *= residue;
-    residue = residue % 17;
-    applyresidue = residue;
-    applyresidue *= 0.00000001;
-    applyresidue *= 0.00000001;
-    in += applyresidue;
-    if (in < 1.2e-38 && -in < 1.2e-38) {
-        in -= applyresidue;
+// the 'air' hiss of the high quality mode, one per instance and seeded like rwlib::DitherNoise
+struct AirNoise {
+    int noisesource;
+
+    AirNoise()
+    {
+        noisesource = rand() % 1700021;
     }
 
-    return in;
-}
+    // for the first numLanes lanes
+    inline simd::float_4 process(simd::float_4 in, int numLanes)
+    {
+        //for live air, we always apply the dither noise. Then, if our result is
+        //effectively digital black, we'll subtract it again. We want a 'air' hiss
+
+        simd::float_4 applyresidue = 0.f;
+
+        for (int k = 0; k < numLanes; k++) {
+            noisesource = noisesource % 1700021;
+            noisesource++;
+            int residue = noisesource * noisesource;
+            residue = residue % 170003;
+            residue *= residue;
+            residue = residue % 17011;
+            residue *= residue;
+            residue = residue % 1709;
+            residue *= residue;
+            residue = residue % 173;
+            residue *= residue;
+            residue = residue % 17;
+            applyresidue[k] = residue * 1e-16f;
+        }
+        simd::float_4 out = in + applyresidue;
+
+        return simd::ifelse(simd::fabs(out) < 1.2e-38f, in, out);
+    }
+};
 
 /* Mojo (for output saturation)
 ======================================================================================== */
-inline long double mojo(long double in)
+inline simd::float_4 mojo(simd::float_4 in)
 {
-    long double mojo = pow(fabs(in), 0.25);
-    if (mojo > 0.0) {
-        in = (sin(in * mojo * M_PI * 0.5) / mojo) * 0.987654321;
-        in *= 0.65; // dial back a bit to keep levels roughly the same
-    }
-    return in;
+    simd::float_4 mojo = simd::sqrt(simd::sqrt(simd::fabs(in))); // pow(fabs(in), 0.25)
+    simd::float_4 out = (simd::sin(in * mojo * (float)(M_PI * 0.5)) / mojo) * 0.987654321f;
+    out *= 0.65f; // dial back a bit to keep levels roughly the same
+    return simd::ifelse(mojo > 0.f, out, in);
 }
 
 /* Module
@@ -244,7 +388,11 @@ struct Holt : Module {
     const double gainCut = 0.03125;
     const double gainBoost = 32.0;
     int quality;
-    HoltEngine holt[16];
+    int oversampling;
+    int decimationMode;
+    HoltEngine holt;
+    rwlib::Oversampler<simd::float_4> oversampler[4];
+    Decimator decimators[4];
 
     // control parameter
     float frequencyParam;
@@ -253,7 +401,34 @@ struct Holt : Module {
 
     // other
     double overallscale;
-    long double fpNShape;
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
+    rwlib::DitherNoise ditherSource;
+    AirNoise airNoise;
+    simd::float_4 fpNShape[4];
+    int lastOversampling;
+    float sampleRate;
+    int decimation; // factor holt runs below the full rate by
+    int decimationPhase; // sample within the decimator blocks
+    bool isDecimatorStale;
+    simd::float_4 lastOutputSamples[4]; // before the dither, for restarting the decimators
+
+    // a new decimation factor fades in over the old one, which keeps running from a copy of
+    // its state until the fade is over
+    HoltEngine fadingHolt;
+    Decimator fadingDecimators[4];
+    rwlib::Oversampler<simd::float_4> fadingOversampler[4];
+    int fadingDecimation;
+    int fadingPhase;
+    int fadeLength; // samples
+    int fadeRemaining;
+
+    // process kernel, specialised at compile time for the current quality setting and the
+    // number of engaged poles
+    typedef void (Holt::*ProcessKernel)(const ProcessArgs& args);
+    ProcessKernel kernel;
+    int kernelQuality;
+    int kernelNumPoles;
 
     Holt()
     {
@@ -263,24 +438,40 @@ struct Holt : Module {
         configParam(POLES_PARAM, 0.f, 1.f, 1.f, "Poles");
 
         quality = loadQuality();
+        oversampling = lastOversampling = 1;
+        decimationMode = DECIMATION_OFF;
+        kernelQuality = kernelNumPoles = -1;
+        decimation = 1;
+        onReset();
     }
 
     void onSampleRateChange() override
     {
-        float sampleRate = APP->engine->getSampleRate();
+        sampleRate = APP->engine->getSampleRate();
 
         overallscale = 1.0;
         overallscale /= 44100.0;
         overallscale *= sampleRate;
+
+        // tail: ring out of the resonant filter at full resonance
+        silenceDetector.setTail(1.0 * sampleRate, sampleRate);
+
+        fadeLength = (int)(0.01f * sampleRate);
     }
 
     void onReset() override
     {
-        for (int i = 0; i < 16; i++) {
-            holt[i] = HoltEngine();
-        }
+        holt.reset();
 
-        fpNShape = 0.0;
+        for (int i = 0; i < 4; i++) {
+            fpNShape[i] = 0.f;
+            oversampler[i].setFactor(oversampling);
+            oversampler[i].reset();
+            lastOutputSamples[i] = 0.f;
+        }
+        decimationPhase = 0;
+        isDecimatorStale = true;
+        fadeRemaining = 0;
 
         onSampleRateChange();
         updateParams();
@@ -293,6 +484,12 @@ struct Holt : Module {
         // quality
         json_object_set_new(rootJ, "quality", json_integer(quality));
 
+        // oversampling
+        json_object_set_new(rootJ, "oversampling", json_integer(oversampling));
+
+        // decimation
+        json_object_set_new(rootJ, "decimation", json_integer(decimationMode));
+
         return rootJ;
     }
 
@@ -302,6 +499,16 @@ struct Holt : Module {
         json_t* qualityJ = json_object_get(rootJ, "quality");
         if (qualityJ)
             quality = json_integer_value(qualityJ);
+
+        // oversampling
+        json_t* oversamplingJ = json_object_get(rootJ, "oversampling");
+        if (oversamplingJ)
+            oversampling = rwlib::validOversampling(json_integer_value(oversamplingJ));
+
+        // decimation
+        json_t* decimationJ = json_object_get(rootJ, "decimation");
+        if (decimationJ)
+            decimationMode = json_integer_value(decimationJ);
     }
 
     void updateParams()
@@ -319,41 +526,210 @@ struct Holt : Module {
         polesParam = clamp(polesParam, 0.01f, 0.99f);
     }
 
+    // The lowest rate that still covers the audio band (44.1 kHz and up), as long as the cutoff
+    // stays far enough below it that the four stages respond there as at the full rate (within
+    // about 1 %). Going down a rate again needs some more margin, so a modulated cutoff near
+    // the limit doesn't switch back and forth, and the factor holds until the last switch has
+    // faded in.
+    int getDecimation()
+    {
+        const float maxCutoff = 0.15f; // radians per sample at the reduced rate
+
+        if (decimationMode == DECIMATION_OFF) {
+            return 1;
+        }
+        if (fadeRemaining > 0) {
+            return decimation;
+        }
+        int factor = decimation;
+        while (factor > 1 && (holt.cutoff * factor > maxCutoff || sampleRate / factor < 44100.f)) {
+            factor /= 2;
+        }
+        while (factor < Decimator::maxFactor && sampleRate / (factor * 2) >= 44100.f && holt.cutoff * factor * 2 <= maxCutoff * 0.75f) {
+            factor *= 2;
+        }
+        return factor;
+    }
+
+    template <int QUALITY>
+    static ProcessKernel getKernel(int numPoles)
+    {
+        switch (numPoles) {
+        case 1:
+            return &Holt::processKernel<QUALITY, 1>;
+        case 2:
+            return &Holt::processKernel<QUALITY, 2>;
+        case 3:
+            return &Holt::processKernel<QUALITY, 3>;
+        default:
+            return &Holt::processKernel<QUALITY, 4>;
+        }
+    }
+
+    void selectKernel(int numPoles)
+    {
+        kernel = (quality == HIGH) ? getKernel<HIGH>(numPoles) : getKernel<ECO>(numPoles);
+        kernelQuality = quality;
+        kernelNumPoles = numPoles;
+    }
+
+    // a new factor restarts the decimators from where the signals are, and fades in over the
+    // old one
+    void setDecimation(int factor)
+    {
+        fadingHolt = holt;
+        for (int i = 0; i < 4; i++) {
+            fadingDecimators[i] = decimators[i];
+            fadingOversampler[i] = oversampler[i];
+        }
+        fadingDecimation = decimation;
+        fadingPhase = decimationPhase;
+        fadeRemaining = fadeLength;
+
+        decimation = factor;
+        isDecimatorStale = true;
+    }
+
     void process(const ProcessArgs& args) override
     {
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
+
+        // skip the dsp once the inputs have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs[IN_INPUT]))) {
+            dspStats.sleep();
+            clearOutputs(outputs);
+            return;
+        }
+
         updateParams();
+        holt.setParams(frequencyParam, resonanceParam);
 
-        long double in;
+        int numPoles = HoltEngine::getNumPoles(polesParam);
+        if (quality != kernelQuality || numPoles != kernelNumPoles) {
+            selectKernel(numPoles);
+        }
+        int factor = getDecimation();
+        if (factor != decimation) {
+            setDecimation(factor);
+        }
 
-        // for each poly channel
-        for (int i = 0, numChannels = std::max(1, inputs[IN_INPUT].getChannels()); i < numChannels; ++i) {
+        (this->*kernel)(args);
+    }
 
-            // input
-            in = inputs[IN_INPUT].getPolyVoltage(i) * gainCut;
+    // one sample of a group through holt, the clipper and mojo, at the full rate or once per
+    // block of the decimator (after holt the signal is well below the reduced rate, so the
+    // saturation can run there too)
+    template <int QUALITY, int NUM_POLES>
+    simd::float_4 processHolt(HoltEngine& engine, Decimator& decimator, rwlib::Oversampler<simd::float_4>& oversampler, int factor, int phase, simd::float_4 in, float lastPoleWet, int g, int numLanes)
+    {
+        simd::float_4 out;
+        if (factor > 1) {
+            decimator.inputSamples[phase] = in;
+            out = decimator.outputSamples[phase];
+            if (phase < factor - 1) {
+                return out;
+            }
+            in = decimator.downsample();
+        }
 
-            if (quality == HIGH) {
-                in = ditherNoise(in);
+        if (QUALITY == HIGH) {
+            in = airNoise.process(in, numLanes);
+        }
+        in = (factor > 1) ? engine.processDecimated<NUM_POLES>(in, lastPoleWet, g) : engine.process<NUM_POLES>(in, lastPoleWet, g);
+        in = HoltEngine::clip(in);
+
+        // mojo for swallowing excessive resonance, at the oversampled rate
+        if (oversampling > 1) {
+            simd::float_4 buffer[rwlib::Oversampler<simd::float_4>::maxFactor];
+            oversampler.upsample(in, buffer);
+            for (int j = 0; j < oversampling; j++) {
+                buffer[j] = mojo(buffer[j]);
             }
+            in = oversampler.downsample(buffer);
+        } else {
+            in = mojo(in);
+        }
 
-            // holt
-            in = holt[i].process(in, frequencyParam, resonanceParam, polesParam);
+        if (factor > 1) {
+            decimator.upsample(in);
+            return out;
+        }
+        return in;
+    }
 
-            // mojo for swallowing excessive resonance
-            in = mojo(in);
+    template <int QUALITY, int NUM_POLES>
+    void processKernel(const ProcessArgs& args)
+    {
+        // apply oversampling changes
+        if (oversampling != lastOversampling) {
+            for (int i = 0; i < 4; i++) {
+                oversampler[i].setFactor(oversampling);
+                fadingOversampler[i].setFactor(oversampling);
+            }
+            lastOversampling = oversampling;
+            dspStats.oversampling = oversampling;
+        }
+
+        float lastPoleWet = HoltEngine::getLastPoleWet(polesParam, NUM_POLES);
+        if (decimation > 1) {
+            holt.setDecimation(decimation);
+            if (isDecimatorStale) {
+                decimationPhase = 0;
+            }
+        }
+        bool isFading = fadeRemaining > 0;
+        float fade = 0.f; // share of the old factor
+        if (isFading) {
+            fadingHolt.setParams(frequencyParam, resonanceParam);
+            if (fadingDecimation > 1) {
+                fadingHolt.setDecimation(fadingDecimation);
+            }
+            fade = fadeRemaining / (float)fadeLength;
+        }
+
+        // all voices in at once, processed in place
+        PolyBuffer voices;
+        voices.read(inputs[IN_INPUT]);
+
+        // for each group of four poly channels
+        for (int c = 0; c < voices.channels; c += 4) {
+            int g = c / 4;
+
+            // input
+            simd::float_4 in = voices.getSimd(c) * (float)gainCut;
+            int numLanes = std::min(4, voices.channels - c);
+
+            // holt
+            if (decimation > 1 && isDecimatorStale) {
+                decimators[g].reset(decimation, in, lastOutputSamples[g]);
+                holt.previousInput[g] = in;
+            }
+            simd::float_4 out = processHolt<QUALITY, NUM_POLES>(holt, decimators[g], oversampler[g], decimation, decimationPhase, in, lastPoleWet, g, numLanes);
+            if (isFading) {
+                simd::float_4 fadingOut = processHolt<QUALITY, NUM_POLES>(fadingHolt, fadingDecimators[g], fadingOversampler[g], fadingDecimation, fadingPhase, in, lastPoleWet, g, numLanes);
+                out += fade * (fadingOut - out);
+            }
+            in = lastOutputSamples[g] = out;
 
-            if (quality == HIGH) {
-                //stereo 32 bit dither, made small and tidy.
-                int expon;
-                frexpf((float)in, &expon);
-                long double dither = (rand() / (RAND_MAX * 7.737125245533627e+25)) * pow(2, expon + 62);
-                in += (dither - fpNShape);
-                fpNShape = dither;
+            if (QUALITY == HIGH) {
+                DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
+                in = ditherNoiseShaped(in, ditherSource, fpNShape[g]);
             }
 
             // output
-            outputs[OUT_OUTPUT].setChannels(numChannels);
-            outputs[OUT_OUTPUT].setVoltage(in * gainBoost, i);
+            voices.setSimd(in * (float)gainBoost, c);
+        }
+
+        if (decimation > 1) {
+            decimationPhase = (decimationPhase + 1) % decimation;
+            isDecimatorStale = false;
         }
+        if (isFading) {
+            fadingPhase = (fadingPhase + 1) % fadingDecimation;
+            fadeRemaining--;
+        }
+
+        voices.write(outputs[OUT_OUTPUT]);
     }
 };
 
@@ -377,6 +753,38 @@ struct HoltWidget : ModuleWidget {
         }
     };
 
+    // oversampling item
+    struct OversamplingItem : MenuItem {
+        Holt* module;
+        int oversampling;
+
+        void onAction(const event::Action& e) override
+        {
+            module->oversampling = oversampling;
+        }
+
+        void step() override
+        {
+            rightText = (module->oversampling == oversampling) ? "✔" : "";
+        }
+    };
+
+    // decimation item
+    struct DecimationItem : MenuItem {
+        Holt* module;
+        int decimationMode;
+
+        void onAction(const event::Action& e) override
+        {
+            module->decimationMode = decimationMode;
+        }
+
+        void step() override
+        {
+            rightText = (module->decimationMode == decimationMode) ? "✔" : "";
+        }
+    };
+
     void appendContextMenu(Menu* menu) override
     {
         Holt* module = dynamic_cast<Holt*>(this->module);
@@ -399,12 +807,51 @@ struct HoltWidget : ModuleWidget {
         high->module = module;
         high->quality = 1;
         menu->addChild(high);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        MenuLabel* oversamplingLabel = new MenuLabel(); // menu label
+        oversamplingLabel->text = "Oversampling";
+        menu->addChild(oversamplingLabel);
+
+        const char* oversamplingNames[] = { "Off", "2x", "4x", "8x" };
+        for (int i = 0; i < 4; i++) {
+            OversamplingItem* oversamplingItem = new OversamplingItem();
+            oversamplingItem->text = oversamplingNames[i];
+            oversamplingItem->module = module;
+            oversamplingItem->oversampling = 1 << i;
+            menu->addChild(oversamplingItem);
+        }
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        MenuLabel* decimationLabel = new MenuLabel(); // menu label
+        decimationLabel->text = "Reduced rate at low cutoff";
+        menu->addChild(decimationLabel);
+
+        DecimationItem* decimationOff = new DecimationItem(); // off
+        decimationOff->text = "Off";
+        decimationOff->module = module;
+        decimationOff->decimationMode = DECIMATION_OFF;
+        menu->addChild(decimationOff);
+
+        DecimationItem* decimationAuto = new DecimationItem(); // auto
+        decimationAuto->text = "Auto (88.2 kHz and up)";
+        decimationAuto->module = module;
+        decimationAuto->decimationMode = DECIMATION_AUTO;
+        menu->addChild(decimationAuto);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
     }
 
     HoltWidget(Holt* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/holt_dark.svg")));
+        setPanel(loadArtwork("holt_dark.svg"));
 
         // screws
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH, 0)));
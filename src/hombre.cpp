@@ -48,20 +48,31 @@ struct Hombre : Module {
     float voicingParam;
     float intensityParam;
 
-    // state variables (as arrays in order to handle up to 16 polyphonic channels)
-    double p[16][4001];
-    double slide[16];
-    int gcount[16];
-    long double fpNShape[16];
+    // state variables: the delay memory holds one group of four voices per sample, so each
+    // tap reads four voices at once; the voicing slides and the buffers scroll in step for
+    // all voices
+    rwlib::DelayBuffer<simd::float_4, 4001> p[4];
+    double slide;
+    int gcount;
+    int numActiveGroups;
+    simd::float_4 fpNShape[4];
 
     // other variables, which do not need to be updated every cycle
     double overallscale;
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
+    rwlib::DitherNoise ditherSource;
     double target;
     int widthA;
     int widthB;
     double wet;
     double dry;
 
+    // process kernel, specialised at compile time for the current quality setting
+    typedef void (Hombre::*ProcessKernel)(const ProcessArgs& args);
+    ProcessKernel kernel;
+    int kernelQuality;
+
     Hombre()
     {
         config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -69,6 +80,7 @@ struct Hombre : Module {
         configParam(INTENSITY_PARAM, 0.f, 1.f, 0.5f, "Intensity");
 
         quality = loadQuality();
+        kernelQuality = -1;
         onReset();
     }
 
@@ -76,14 +88,13 @@ struct Hombre : Module {
     {
         onSampleRateChange();
 
-        for (int i = 0; i < 16; i++) {
-            for (int count = 0; count < 4000; count++) {
-                p[i][count] = 0.0;
-            }
-            gcount[i] = 0;
-            slide[i] = 0.5;
-            fpNShape[i] = 0.0;
+        for (int i = 0; i < 4; i++) {
+            p[i].clear();
+            fpNShape[i] = 0.f;
         }
+        slide = 0.5;
+        gcount = 0;
+        numActiveGroups = 0;
     }
 
     void onSampleRateChange() override
@@ -94,6 +105,9 @@ struct Hombre : Module {
         overallscale /= 44100.0;
         overallscale *= sampleRate;
 
+        // tail: bounded by the delay lines
+        silenceDetector.setTail(4001.0, sampleRate);
+
         widthA = (int)(1.0 * overallscale);
         widthB = (int)(7.0 * overallscale); //max 364 at 44.1, 792 at 96K
     }
@@ -116,7 +130,32 @@ struct Hombre : Module {
             quality = json_integer_value(qualityJ);
     }
 
+    void selectKernel()
+    {
+        kernel = (quality == HIGH) ? &Hombre::processKernel<HIGH> : &Hombre::processKernel<ECO>;
+        kernelQuality = quality;
+    }
+
     void process(const ProcessArgs& args) override
+    {
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
+
+        // skip the dsp once the inputs have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs[IN_INPUT]))) {
+            dspStats.sleep();
+            clearOutputs(outputs);
+            return;
+        }
+
+        if (quality != kernelQuality) {
+            selectKernel();
+        }
+
+        (this->*kernel)(args);
+    }
+
+    template <int QUALITY>
+    void processKernel(const ProcessArgs& args)
     {
         if (outputs[OUT_OUTPUT].isConnected()) {
 
@@ -132,112 +171,88 @@ struct Hombre : Module {
             wet = intensityParam;
             dry = 1.0 - wet;
 
-            double offsetA;
-            double offsetB;
-            double total;
-            int count;
-            long double inputSample;
-            double drySample;
-
-            // input
-            int numChannels = std::max(1, inputs[IN_INPUT].getChannels());
-
-            // for each poly channel
-            for (int i = 0; i < numChannels; i++) {
-
-                // input
-                inputSample = inputs[IN_INPUT].getPolyVoltage(i);
-
-                // pad gain
-                inputSample *= gainCut;
-
-                if (quality == HIGH) {
-                    if (inputSample < 1.2e-38 && -inputSample < 1.2e-38) {
-                        static int noisesource = 0;
-                        //this declares a variable before anything else is compiled. It won't keep assigning
-                        //it to 0 for every sample, it's as if the declaration doesn't exist in this context,
-                        //but it lets me add this denormalization fix in a single place rather than updating
-                        //it in three different locations. The variable isn't thread-safe but this is only
-                        //a random seed and we can share it with whatever.
-                        noisesource = noisesource % 1700021;
-                        noisesource++;
-                        int residue = noisesource * noisesource;
-                        residue = residue % 170003;
-                        residue *= residue;
-                        residue = residue % 17011;
-                        residue *= residue;
-                        residue = residue % 1709;
-                        residue *= residue;
-                        residue = residue % 173;
-                        residue *= residue;
-                        residue = residue % 17;
-                        double applyresidue = residue;
-                        applyresidue *= 0.00000001;
-                        applyresidue *= 0.00000001;
-                        inputSample = applyresidue;
-                    }
-                }
+            // the tap offsets, once for all voices
+            slide = (slide * 0.9997) + (target * 0.0003);
 
-                drySample = inputSample;
+            //adjust for sample rate
+            double offsetA = ((pow(slide, 2)) * 77) + 3.2;
+            double offsetB = (3.85 * offsetA) + 41;
+            offsetA *= overallscale;
+            offsetB *= overallscale;
 
-                slide[i] = (slide[i] * 0.9997) + (target * 0.0003);
+            if (gcount < 1 || gcount > 2000) {
+                gcount = 2000;
+            }
+            int count = gcount;
+            int countA = (int)(gcount + floor(offsetA));
+            int countB = (int)(gcount + floor(offsetB));
+
+            // all voices in at once, processed in place
+            PolyBuffer voices;
+            voices.read(inputs[IN_INPUT]);
+
+            // groups that come in start from a silent buffer
+            int numGroups = (voices.channels + 3) / 4;
+            for (int g = numActiveGroups; g < numGroups; g++) {
+                p[g].clear();
+                fpNShape[g] = 0.f;
+            }
+            numActiveGroups = numGroups;
 
-                //adjust for sample rate
-                offsetA = ((pow(slide[i], 2)) * 77) + 3.2;
-                offsetB = (3.85 * offsetA) + 41;
-                offsetA *= overallscale;
-                offsetB *= overallscale;
+            // for each group of four poly channels
+            for (int c = 0; c < voices.channels; c += 4) {
+                int g = c / 4;
 
-                if (gcount[i] < 1 || gcount[i] > 2000) {
-                    gcount[i] = 2000;
-                }
-                count = gcount[i];
+                // zero a little more of the delay memory left stale by the last clear
+                p[g].sweep();
 
-                //double buffer
-                p[i][count + 2000] = p[i][count] = inputSample;
+                // input, pad gain
+                simd::float_4 inputSample = voices.getSimd(c) * (float)gainCut;
 
-                count = (int)(gcount[i] + floor(offsetA));
+                if (QUALITY == HIGH) {
+                    inputSample = denormalize(inputSample, std::min(4, voices.channels - c));
+                }
 
-                total = p[i][count] * 0.391; //less as value moves away from .0
-                total += p[i][count + widthA]; //we can assume always using this in one way or another?
-                total += p[i][count + widthA + widthA] * 0.391; //greater as value moves away from .0
+                simd::float_4 drySample = inputSample;
 
-                inputSample += ((total * 0.274));
+                //double buffer
+                p[g].write(count, inputSample);
+                p[g].write(count + 2000, inputSample);
 
-                count = (int)(gcount[i] + floor(offsetB));
+                simd::float_4 total = p[g].read(countA) * 0.391f; //less as value moves away from .0
+                total += p[g].read(countA + widthA); //we can assume always using this in one way or another?
+                total += p[g].read(countA + widthA + widthA) * 0.391f; //greater as value moves away from .0
 
-                total = p[i][count] * 0.918; //less as value moves away from .0
-                total += p[i][count + widthB]; //we can assume always using this in one way or another?
-                total += p[i][count + widthB + widthB] * 0.918; //greater as value moves away from .0
+                inputSample += ((total * 0.274f));
 
-                inputSample -= ((total * 0.629));
+                total = p[g].read(countB) * 0.918f; //less as value moves away from .0
+                total += p[g].read(countB + widthB); //we can assume always using this in one way or another?
+                total += p[g].read(countB + widthB + widthB) * 0.918f; //greater as value moves away from .0
 
-                inputSample /= 4;
+                inputSample -= ((total * 0.629f));
 
-                //still scrolling through the samples, remember
-                gcount[i]--;
+                inputSample *= 0.25f;
 
                 if (wet != 1.0) {
-                    inputSample = (inputSample * wet) + (drySample * dry);
+                    inputSample = (inputSample * (float)wet) + (drySample * (float)dry);
                 }
 
-                if (quality == HIGH) {
-                    //stereo 32 bit dither, made small and tidy.
-                    int expon;
-                    frexpf((float)inputSample, &expon);
-                    long double dither = (rand() / (RAND_MAX * 7.737125245533627e+25)) * pow(2, expon + 62);
-                    inputSample += (dither - fpNShape[i]);
-                    fpNShape[i] = dither;
-                    //end 32 bit dither
+                if (QUALITY == HIGH) {
+                    DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
+                    inputSample = ditherNoiseShaped(inputSample, ditherSource, fpNShape[g]);
                 }
 
                 // bring gain back up
-                inputSample *= gainBoost;
+                inputSample *= (float)gainBoost;
 
                 // output
-                outputs[OUT_OUTPUT].setChannels(numChannels);
-                outputs[OUT_OUTPUT].setVoltage(inputSample, i);
+                voices.setSimd(inputSample, c);
             }
+
+            //still scrolling through the samples, remember
+            gcount--;
+
+            voices.write(outputs[OUT_OUTPUT]);
         }
     }
 };
@@ -282,12 +297,18 @@ struct HombreWidget : ModuleWidget {
         high->module = module;
         high->quality = 1;
         menu->addChild(high);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
     }
 
     HombreWidget(Hombre* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/hombre_dark.svg")));
+        setPanel(loadArtwork("hombre_dark.svg"));
 
         // screws
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH * 1.5, 0)));
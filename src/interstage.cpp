@@ -39,6 +39,7 @@ struct Interstage : Module {
     const double gainCut = 0.03125;
     const double gainBoost = 32.0;
     int quality;
+    int oversampling;
 
     // state variables (as arrays in order to handle up to 16 polyphonic channels)
     double iirSampleAL[16];
@@ -59,11 +60,21 @@ struct Interstage : Module {
     long double lastSampleR[16];
     bool flipR[16];
     uint32_t fpdR[16];
+    rwlib::PolyOversampler oversamplerL;
+    rwlib::PolyOversampler oversamplerR;
 
     // other variables, which do not need to be updated every cycle
     double overallscale;
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
     double firstStage;
     double iirAmount;
+    int lastOversampling;
+
+    // process kernel, specialised at compile time for the current quality setting
+    typedef void (Interstage::*ProcessKernel)(const ProcessArgs& args);
+    ProcessKernel kernel;
+    int kernelQuality;
 
     // constants
     const double threshold = 0.381966011250105;
@@ -73,6 +84,8 @@ struct Interstage : Module {
         config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
 
         quality = loadQuality();
+        oversampling = lastOversampling = 1;
+        kernelQuality = -1;
         onReset();
     }
 
@@ -88,6 +101,11 @@ struct Interstage : Module {
             flipR[i] = true;
             fpdR[i] = 17;
         }
+
+        oversamplerL.setFactor(oversampling);
+        oversamplerL.reset();
+        oversamplerR.setFactor(oversampling);
+        oversamplerR.reset();
     }
 
     void onSampleRateChange() override
@@ -97,9 +115,13 @@ struct Interstage : Module {
         overallscale = 1.0;
         overallscale /= 44100.0;
         overallscale *= sampleRate;
+        overallscale *= oversampling;
 
         firstStage = 0.381966011250105 / overallscale;
         iirAmount = 0.00295 / overallscale;
+
+        // tail: none beyond the hold, the filters settle within a few milliseconds
+        silenceDetector.setTail(0.0, sampleRate);
     }
 
     json_t* dataToJson() override
@@ -109,6 +131,9 @@ struct Interstage : Module {
         // quality
         json_object_set_new(rootJ, "quality", json_integer(quality));
 
+        // oversampling
+        json_object_set_new(rootJ, "oversampling", json_integer(oversampling));
+
         return rootJ;
     }
 
@@ -118,30 +143,30 @@ struct Interstage : Module {
         json_t* qualityJ = json_object_get(rootJ, "quality");
         if (qualityJ)
             quality = json_integer_value(qualityJ);
+
+        // oversampling
+        json_t* oversamplingJ = json_object_get(rootJ, "oversampling");
+        if (oversamplingJ)
+            oversampling = rwlib::validOversampling(json_integer_value(oversamplingJ));
     }
 
-    void processChannel(Input& input, Output& output, double iirSampleA[], double iirSampleB[], double iirSampleC[], double iirSampleD[], double iirSampleE[], double iirSampleF[], long double lastSample[], bool flip[], uint32_t fpd[])
+    template <int QUALITY>
+    void processChannel(Input& input, Output& output, double iirSampleA[], double iirSampleB[], double iirSampleC[], double iirSampleD[], double iirSampleE[], double iirSampleF[], long double lastSample[], bool flip[], uint32_t fpd[], rwlib::PolyOversampler& oversampler)
     {
         if (output.isConnected()) {
 
-            long double inputSample;
-            long double drySample;
-
-            // number of polyphonic channels
-            int numChannels = std::max(1, input.getChannels());
-
-            // for each poly channel
-            for (int i = 0; i < numChannels; i++) {
-
-                // input
-                inputSample = input.getPolyVoltage(i);
+            // input to output of a single voice, without dither and makeup gain
+            auto processSample = [&](long double inputSample, int i) {
+                long double drySample;
 
                 // pad gain
                 inputSample *= gainCut;
 
-                if (quality == HIGH) {
-                    if (fabs(inputSample) < 1.18e-37)
+                if (QUALITY == HIGH) {
+                    if (fabs(inputSample) < 1.18e-37) {
                         inputSample = fpd[i] * 1.18e-37;
+                        dspStats.denormalGuards++;
+                    }
                 }
 
                 drySample = inputSample;
@@ -185,7 +210,12 @@ struct Interstage : Module {
 
                 lastSample[i] = inputSample;
 
-                if (quality == HIGH) {
+                return inputSample;
+            };
+
+            auto ditherAndBoost = [&](long double inputSample, int i) {
+                if (QUALITY == HIGH) {
+                    DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
                     //begin 32 bit stereo floating point dither
                     int expon;
                     frexpf((float)inputSample, &expon);
@@ -199,17 +229,102 @@ struct Interstage : Module {
                 // bring gain back up
                 inputSample *= gainBoost;
 
-                // output
-                output.setChannels(numChannels);
-                output.setVoltage(inputSample, i);
+                return inputSample;
+            };
+
+            long double inputSample;
+
+            // number of polyphonic channels
+            int numChannels = std::max(1, input.getChannels());
+
+            if (oversampling == 1) {
+
+                // all voices in at once, processed in place
+                PolyBuffer voices;
+                voices.read(input);
+
+                // for each poly channel
+                for (int i = 0; i < numChannels; i++) {
+
+                    // input
+                    inputSample = voices[i];
+
+                    inputSample = processSample(inputSample, i);
+                    inputSample = ditherAndBoost(inputSample, i);
+
+                    // output
+                    voices[i] = inputSample;
+                }
+
+                voices.write(output);
+            } else {
+                float buffer[rwlib::PolyOversampler::maxFactor][rwlib::maxLanes];
+
+                // all voices in at once, processed in place
+                PolyBuffer voices;
+                voices.read(input);
+
+                oversampler.upsample(voices.voltages, buffer, numChannels);
+
+                // work the magic at the oversampled rate
+                for (int j = 0; j < oversampling; j++) {
+                    for (int i = 0; i < numChannels; i++) {
+                        buffer[j][i] = processSample(buffer[j][i], i);
+                    }
+                }
+
+                oversampler.downsample(buffer, voices.voltages, numChannels);
+
+                for (int i = 0; i < numChannels; i++) {
+                    inputSample = ditherAndBoost(voices[i], i);
+
+                    // output
+                    voices[i] = inputSample;
+                }
+
+                voices.write(output);
             }
         }
     }
 
+    void selectKernel()
+    {
+        kernel = (quality == HIGH) ? &Interstage::processKernel<HIGH> : &Interstage::processKernel<ECO>;
+        kernelQuality = quality;
+    }
+
     void process(const ProcessArgs& args) override
     {
-        processChannel(inputs[IN_L_INPUT], outputs[OUT_L_OUTPUT], iirSampleAL, iirSampleBL, iirSampleCL, iirSampleDL, iirSampleEL, iirSampleFL, lastSampleL, flipL, fpdL);
-        processChannel(inputs[IN_R_INPUT], outputs[OUT_R_OUTPUT], iirSampleAR, iirSampleBR, iirSampleCR, iirSampleDR, iirSampleER, iirSampleFR, lastSampleR, flipR, fpdR);
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
+
+        // skip the dsp once the inputs have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs[IN_L_INPUT]) && isSilent(inputs[IN_R_INPUT]))) {
+            dspStats.sleep();
+            clearOutputs(outputs);
+            return;
+        }
+
+        if (quality != kernelQuality) {
+            selectKernel();
+        }
+
+        (this->*kernel)(args);
+    }
+
+    template <int QUALITY>
+    void processKernel(const ProcessArgs& args)
+    {
+        // apply oversampling changes
+        if (oversampling != lastOversampling) {
+            onSampleRateChange();
+            oversamplerL.setFactor(oversampling);
+            oversamplerR.setFactor(oversampling);
+            lastOversampling = oversampling;
+            dspStats.oversampling = oversampling;
+        }
+
+        processChannel<QUALITY>(inputs[IN_L_INPUT], outputs[OUT_L_OUTPUT], iirSampleAL, iirSampleBL, iirSampleCL, iirSampleDL, iirSampleEL, iirSampleFL, lastSampleL, flipL, fpdL, oversamplerL);
+        processChannel<QUALITY>(inputs[IN_R_INPUT], outputs[OUT_R_OUTPUT], iirSampleAR, iirSampleBR, iirSampleCR, iirSampleDR, iirSampleER, iirSampleFR, lastSampleR, flipR, fpdR, oversamplerR);
     }
 };
 
@@ -231,6 +346,22 @@ struct InterstageWidget : ModuleWidget {
         }
     };
 
+    // oversampling item
+    struct OversamplingItem : MenuItem {
+        Interstage* module;
+        int oversampling;
+
+        void onAction(const event::Action& e) override
+        {
+            module->oversampling = oversampling;
+        }
+
+        void step() override
+        {
+            rightText = (module->oversampling == oversampling) ? "✔" : "";
+        }
+    };
+
     void appendContextMenu(Menu* menu) override
     {
         Interstage* module = dynamic_cast<Interstage*>(this->module);
@@ -253,12 +384,33 @@ struct InterstageWidget : ModuleWidget {
         high->module = module;
         high->quality = 1;
         menu->addChild(high);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        MenuLabel* oversamplingLabel = new MenuLabel(); // menu label
+        oversamplingLabel->text = "Oversampling";
+        menu->addChild(oversamplingLabel);
+
+        const char* oversamplingNames[] = { "Off", "2x", "4x", "8x" };
+        for (int i = 0; i < 4; i++) {
+            OversamplingItem* oversamplingItem = new OversamplingItem();
+            oversamplingItem->text = oversamplingNames[i];
+            oversamplingItem->module = module;
+            oversamplingItem->oversampling = 1 << i;
+            menu->addChild(oversamplingItem);
+        }
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
     }
 
     InterstageWidget(Interstage* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/interstage_dark.svg")));
+        setPanel(loadArtwork("interstage_dark.svg"));
 
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH * 1.5, 0)));
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH * 1.5, RACK_GRID_HEIGHT - RACK_GRID_WIDTH)));
@@ -82,6 +82,15 @@ struct Monitoring : Module {
 
     //other
     double overallscale;
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
+
+    // process kernel, specialised at compile time for the current processing, cans and dither modes
+    typedef void (Monitoring::*ProcessKernel)(long double& inputSampleL, long double& inputSampleR);
+    ProcessKernel kernel;
+    int kernelProcessingMode;
+    int kernelCansMode;
+    int kernelDitherMode;
 
     Monitoring()
     {
@@ -97,23 +106,25 @@ struct Monitoring : Module {
     {
         onSampleRateChange();
 
-        subsL = SubsOnly();
-        subsR = SubsOnly();
-        slewL = SlewOnly();
-        slewR = SlewOnly();
-        peaksL = PeaksOnly();
-        peaksR = PeaksOnly();
-        bandpassL = BiquadBandpass();
-        bandpassR = BiquadBandpass();
-        cans = Cans();
-        darkL = Dark();
-        darkR = Dark();
+        subsL.reset();
+        subsR.reset();
+        slewL.reset();
+        slewR.reset();
+        peaksL.reset();
+        peaksR.reset();
+        bandpassL.reset();
+        bandpassR.reset();
+        cans.reset();
+        darkL.reset();
+        darkR.reset();
 
         processingMode = 0;
         cansMode = 0;
         lastProcessingMode = 0;
         ditherMode = 0;
 
+        kernelProcessingMode = kernelCansMode = kernelDitherMode = -1;
+
         fpd = 17;
     }
 
@@ -124,15 +135,152 @@ struct Monitoring : Module {
         overallscale = 1.0;
         overallscale /= 44100.0;
         overallscale *= sampleRate;
+
+        // tail: decay of the subsonic filters and the cans room
+        silenceDetector.setTail(1.0 * sampleRate, sampleRate);
+    }
+
+    template <int PROCESSING_MODE, bool CANS, int DITHER_MODE>
+    void processKernel(long double& inputSampleL, long double& inputSampleR)
+    {
+        // prepare mid and side
+        long double mid = inputSampleL + inputSampleR;
+        long double side = inputSampleL - inputSampleR;
+
+        // processing modes
+        switch (PROCESSING_MODE) {
+        case OFF:
+            break;
+
+        case SUBS:
+            inputSampleL = subsL.process(inputSampleL, overallscale);
+            inputSampleR = subsR.process(inputSampleR, overallscale);
+            break;
+
+        case SLEW:
+            inputSampleL = slewL.process(inputSampleL);
+            inputSampleR = slewR.process(inputSampleR);
+            break;
+
+        case PEAKS:
+            inputSampleL = peaksL.process(inputSampleL, overallscale);
+            inputSampleR = peaksR.process(inputSampleR, overallscale);
+            break;
+
+        case MID:
+            inputSampleL = mid * 0.5;
+            inputSampleR = mid * 0.5;
+            break;
+
+        case SIDE:
+            inputSampleL = side * 0.5;
+            inputSampleR = -side * 0.5;
+            break;
+
+        case VINYL:
+            inputSampleL = bandpassL.process(inputSampleL);
+            inputSampleR = bandpassR.process(inputSampleR);
+            break;
+
+        case AURAT:
+            inputSampleL = bandpassL.process(inputSampleL);
+            inputSampleR = bandpassR.process(inputSampleR);
+            break;
+
+        case PHONE:
+            inputSampleL = bandpassL.process(mid * 0.5);
+            inputSampleR = bandpassR.process(mid * 0.5);
+            break;
+        }
+
+        // cans
+        if (CANS) {
+            cans.process(inputSampleL, inputSampleR, overallscale);
+        }
+
+        // dither
+        switch (DITHER_MODE) {
+        case DITHER_OFF:
+            break;
+        case DITHER_16:
+            inputSampleL = darkL.process(inputSampleL, overallscale, false);
+            inputSampleR = darkR.process(inputSampleR, overallscale, false);
+            break;
+        case DITHER_24:
+            inputSampleL = darkL.process(inputSampleL, overallscale, true);
+            inputSampleR = darkR.process(inputSampleR, overallscale, true);
+            break;
+        }
+    }
+
+    template <int PROCESSING_MODE>
+    ProcessKernel selectKernel(bool cansOn, int ditherMode)
+    {
+        static const ProcessKernel kernels[2][3] = {
+            { &Monitoring::processKernel<PROCESSING_MODE, false, DITHER_OFF>, &Monitoring::processKernel<PROCESSING_MODE, false, DITHER_24>, &Monitoring::processKernel<PROCESSING_MODE, false, DITHER_16> },
+            { &Monitoring::processKernel<PROCESSING_MODE, true, DITHER_OFF>, &Monitoring::processKernel<PROCESSING_MODE, true, DITHER_24>, &Monitoring::processKernel<PROCESSING_MODE, true, DITHER_16> }
+        };
+        return kernels[cansOn][clamp(ditherMode, DITHER_OFF, DITHER_16)];
+    }
+
+    void selectKernel()
+    {
+        bool cansOn = (cansMode != CANS_OFF);
+
+        if (cansOn) {
+            cans.setMode(cansMode);
+        }
+
+        switch (processingMode) {
+        case SUBS:
+            kernel = selectKernel<SUBS>(cansOn, ditherMode);
+            break;
+        case SLEW:
+            kernel = selectKernel<SLEW>(cansOn, ditherMode);
+            break;
+        case PEAKS:
+            kernel = selectKernel<PEAKS>(cansOn, ditherMode);
+            break;
+        case MID:
+            kernel = selectKernel<MID>(cansOn, ditherMode);
+            break;
+        case SIDE:
+            kernel = selectKernel<SIDE>(cansOn, ditherMode);
+            break;
+        case VINYL:
+            kernel = selectKernel<VINYL>(cansOn, ditherMode);
+            break;
+        case AURAT:
+            kernel = selectKernel<AURAT>(cansOn, ditherMode);
+            break;
+        case PHONE:
+            kernel = selectKernel<PHONE>(cansOn, ditherMode);
+            break;
+        default:
+            kernel = selectKernel<OFF>(cansOn, ditherMode);
+        }
+
+        kernelProcessingMode = processingMode;
+        kernelCansMode = cansMode;
+        kernelDitherMode = ditherMode;
     }
 
     void process(const ProcessArgs& args) override
     {
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
+
         // dither light
         ditherMode = params[DITHER_PARAM].getValue();
         lights[DITHER_24_LIGHT].setBrightness(ditherMode == DITHER_24 ? 1.f : 0.f);
         lights[DITHER_16_LIGHT].setBrightness(ditherMode == DITHER_16 ? 1.f : 0.f);
 
+        // skip the dsp once the inputs have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs[IN_L_INPUT]) && isSilent(inputs[IN_R_INPUT]))) {
+            dspStats.sleep();
+            clearOutputs(outputs);
+            return;
+        }
+
         if (outputs[OUT_L_OUTPUT].isConnected() || outputs[OUT_R_OUTPUT].isConnected()) {
 
             // get params
@@ -156,6 +304,10 @@ struct Monitoring : Module {
                 lastProcessingMode = processingMode;
             }
 
+            if (processingMode != kernelProcessingMode || cansMode != kernelCansMode || ditherMode != kernelDitherMode) {
+                selectKernel();
+            }
+
             // get input
             long double inputSampleL = inputs[IN_L_INPUT].getVoltage();
             long double inputSampleR = inputs[IN_R_INPUT].getVoltage();
@@ -164,75 +316,7 @@ struct Monitoring : Module {
             inputSampleL /= gainFactor;
             inputSampleR /= gainFactor;
 
-            // prepare mid and side
-            long double mid = inputSampleL + inputSampleR;
-            long double side = inputSampleL - inputSampleR;
-
-            // processing modes
-            switch (processingMode) {
-            case OFF:
-                break;
-
-            case SUBS:
-                inputSampleL = subsL.process(inputSampleL, overallscale);
-                inputSampleR = subsR.process(inputSampleR, overallscale);
-                break;
-
-            case SLEW:
-                inputSampleL = slewL.process(inputSampleL);
-                inputSampleR = slewR.process(inputSampleR);
-                break;
-
-            case PEAKS:
-                inputSampleL = peaksL.process(inputSampleL, overallscale);
-                inputSampleR = peaksR.process(inputSampleR, overallscale);
-                break;
-
-            case MID:
-                inputSampleL = mid * 0.5;
-                inputSampleR = mid * 0.5;
-                break;
-
-            case SIDE:
-                inputSampleL = side * 0.5;
-                inputSampleR = -side * 0.5;
-                break;
-
-            case VINYL:
-                inputSampleL = bandpassL.process(inputSampleL);
-                inputSampleR = bandpassR.process(inputSampleR);
-                break;
-
-            case AURAT:
-                inputSampleL = bandpassL.process(inputSampleL);
-                inputSampleR = bandpassR.process(inputSampleR);
-                break;
-
-            case PHONE:
-                inputSampleL = bandpassL.process(mid * 0.5);
-                inputSampleR = bandpassR.process(mid * 0.5);
-                break;
-            }
-
-            // cans
-            if (cansMode) {
-                cans.setMode(cansMode);
-                cans.process(inputSampleL, inputSampleR, overallscale);
-            }
-
-            // dither
-            switch (ditherMode) {
-            case DITHER_OFF:
-                break;
-            case DITHER_16:
-                inputSampleL = darkL.process(inputSampleL, overallscale, false);
-                inputSampleR = darkR.process(inputSampleR, overallscale, false);
-                break;
-            case DITHER_24:
-                inputSampleL = darkL.process(inputSampleL, overallscale, true);
-                inputSampleR = darkR.process(inputSampleR, overallscale, true);
-                break;
-            }
+            (this->*kernel)(inputSampleL, inputSampleR);
 
             // bring gain back up
             inputSampleL *= gainFactor;
@@ -247,10 +331,22 @@ struct Monitoring : Module {
 
 struct MonitoringWidget : ModuleWidget {
 
+    void appendContextMenu(Menu* menu) override
+    {
+        Monitoring* module = dynamic_cast<Monitoring*>(this->module);
+        assert(module);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
+    }
+
     MonitoringWidget(Monitoring* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/monitoring_dark.svg")));
+        setPanel(loadArtwork("monitoring_dark.svg"));
 
         //screws
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH, 0)));
@@ -60,32 +60,32 @@ struct Mv : Module {
     float drywetParam;
 
     // state variables
-    double aAL[15150];
-    double aBL[14618];
-    double aCL[14358];
-    double aDL[13818];
-    double aEL[13562];
-    double aFL[13046];
-    double aGL[11966];
-    double aHL[11130];
-    double aIL[10598];
-    double aJL[9810];
-    double aKL[9522];
-    double aLL[8982];
-    double aML[8786];
-    double aNL[8462];
-    double aOL[8310];
-    double aPL[7982];
-    double aQL[7322];
-    double aRL[6818];
-    double aSL[6506];
-    double aTL[6002];
-    double aUL[5838];
-    double aVL[5502];
-    double aWL[5010];
-    double aXL[4850];
-    double aYL[4296];
-    double aZL[4180];
+    rwlib::DelayBuffer<double, 15150> aAL;
+    rwlib::DelayBuffer<double, 14618> aBL;
+    rwlib::DelayBuffer<double, 14358> aCL;
+    rwlib::DelayBuffer<double, 13818> aDL;
+    rwlib::DelayBuffer<double, 13562> aEL;
+    rwlib::DelayBuffer<double, 13046> aFL;
+    rwlib::DelayBuffer<double, 11966> aGL;
+    rwlib::DelayBuffer<double, 11130> aHL;
+    rwlib::DelayBuffer<double, 10598> aIL;
+    rwlib::DelayBuffer<double, 9810> aJL;
+    rwlib::DelayBuffer<double, 9522> aKL;
+    rwlib::DelayBuffer<double, 8982> aLL;
+    rwlib::DelayBuffer<double, 8786> aML;
+    rwlib::DelayBuffer<double, 8462> aNL;
+    rwlib::DelayBuffer<double, 8310> aOL;
+    rwlib::DelayBuffer<double, 7982> aPL;
+    rwlib::DelayBuffer<double, 7322> aQL;
+    rwlib::DelayBuffer<double, 6818> aRL;
+    rwlib::DelayBuffer<double, 6506> aSL;
+    rwlib::DelayBuffer<double, 6002> aTL;
+    rwlib::DelayBuffer<double, 5838> aUL;
+    rwlib::DelayBuffer<double, 5502> aVL;
+    rwlib::DelayBuffer<double, 5010> aWL;
+    rwlib::DelayBuffer<double, 4850> aXL;
+    rwlib::DelayBuffer<double, 4296> aYL;
+    rwlib::DelayBuffer<double, 4180> aZL;
 
     double avgAL;
     double avgBL;
@@ -116,32 +116,32 @@ struct Mv : Module {
 
     double feedbackL;
 
-    double aAR[15150];
-    double aBR[14618];
-    double aCR[14358];
-    double aDR[13818];
-    double aER[13562];
-    double aFR[13046];
-    double aGR[11966];
-    double aHR[11130];
-    double aIR[10598];
-    double aJR[9810];
-    double aKR[9522];
-    double aLR[8982];
-    double aMR[8786];
-    double aNR[8462];
-    double aOR[8310];
-    double aPR[7982];
-    double aQR[7322];
-    double aRR[6818];
-    double aSR[6506];
-    double aTR[6002];
-    double aUR[5838];
-    double aVR[5502];
-    double aWR[5010];
-    double aXR[4850];
-    double aYR[4296];
-    double aZR[4180];
+    rwlib::DelayBuffer<double, 15150> aAR;
+    rwlib::DelayBuffer<double, 14618> aBR;
+    rwlib::DelayBuffer<double, 14358> aCR;
+    rwlib::DelayBuffer<double, 13818> aDR;
+    rwlib::DelayBuffer<double, 13562> aER;
+    rwlib::DelayBuffer<double, 13046> aFR;
+    rwlib::DelayBuffer<double, 11966> aGR;
+    rwlib::DelayBuffer<double, 11130> aHR;
+    rwlib::DelayBuffer<double, 10598> aIR;
+    rwlib::DelayBuffer<double, 9810> aJR;
+    rwlib::DelayBuffer<double, 9522> aKR;
+    rwlib::DelayBuffer<double, 8982> aLR;
+    rwlib::DelayBuffer<double, 8786> aMR;
+    rwlib::DelayBuffer<double, 8462> aNR;
+    rwlib::DelayBuffer<double, 8310> aOR;
+    rwlib::DelayBuffer<double, 7982> aPR;
+    rwlib::DelayBuffer<double, 7322> aQR;
+    rwlib::DelayBuffer<double, 6818> aRR;
+    rwlib::DelayBuffer<double, 6506> aSR;
+    rwlib::DelayBuffer<double, 6002> aTR;
+    rwlib::DelayBuffer<double, 5838> aUR;
+    rwlib::DelayBuffer<double, 5502> aVR;
+    rwlib::DelayBuffer<double, 5010> aWR;
+    rwlib::DelayBuffer<double, 4850> aXR;
+    rwlib::DelayBuffer<double, 4296> aYR;
+    rwlib::DelayBuffer<double, 4180> aZR;
 
     double avgAR;
     double avgBR;
@@ -202,6 +202,16 @@ struct Mv : Module {
 
     uint32_t fpd;
 
+    // other
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
+    double tailFeedbackLevel;
+
+    // process kernel, specialised at compile time for the current quality setting
+    typedef void (Mv::*ProcessKernel)(const ProcessArgs& args);
+    ProcessKernel kernel;
+    int kernelQuality;
+
     Mv()
     {
         config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -215,116 +225,66 @@ struct Mv : Module {
         configParam(REGEN_CV_PARAM, -1.f, 1.f, 0.f, "Regeneration CV");
 
         quality = loadQuality();
+        kernelQuality = -1;
         onReset();
     }
 
     void onReset() override
     {
-        int count;
-        for (count = 0; count < 15149; count++) {
-            aAL[count] = 0.0;
-            aAR[count] = 0.0;
-        }
-        for (count = 0; count < 14617; count++) {
-            aBL[count] = 0.0;
-            aBR[count] = 0.0;
-        }
-        for (count = 0; count < 14357; count++) {
-            aCL[count] = 0.0;
-            aCR[count] = 0.0;
-        }
-        for (count = 0; count < 13817; count++) {
-            aDL[count] = 0.0;
-            aDR[count] = 0.0;
-        }
-        for (count = 0; count < 13561; count++) {
-            aEL[count] = 0.0;
-            aER[count] = 0.0;
-        }
-        for (count = 0; count < 13045; count++) {
-            aFL[count] = 0.0;
-            aFR[count] = 0.0;
-        }
-        for (count = 0; count < 11965; count++) {
-            aGL[count] = 0.0;
-            aGR[count] = 0.0;
-        }
-        for (count = 0; count < 11129; count++) {
-            aHL[count] = 0.0;
-            aHR[count] = 0.0;
-        }
-        for (count = 0; count < 10597; count++) {
-            aIL[count] = 0.0;
-            aIR[count] = 0.0;
-        }
-        for (count = 0; count < 9809; count++) {
-            aJL[count] = 0.0;
-            aJR[count] = 0.0;
-        }
-        for (count = 0; count < 9521; count++) {
-            aKL[count] = 0.0;
-            aKR[count] = 0.0;
-        }
-        for (count = 0; count < 8981; count++) {
-            aLL[count] = 0.0;
-            aLR[count] = 0.0;
-        }
-        for (count = 0; count < 8785; count++) {
-            aML[count] = 0.0;
-            aMR[count] = 0.0;
-        }
-        for (count = 0; count < 8461; count++) {
-            aNL[count] = 0.0;
-            aNR[count] = 0.0;
-        }
-        for (count = 0; count < 8309; count++) {
-            aOL[count] = 0.0;
-            aOR[count] = 0.0;
-        }
-        for (count = 0; count < 7981; count++) {
-            aPL[count] = 0.0;
-            aPR[count] = 0.0;
-        }
-        for (count = 0; count < 7321; count++) {
-            aQL[count] = 0.0;
-            aQR[count] = 0.0;
-        }
-        for (count = 0; count < 6817; count++) {
-            aRL[count] = 0.0;
-            aRR[count] = 0.0;
-        }
-        for (count = 0; count < 6505; count++) {
-            aSL[count] = 0.0;
-            aSR[count] = 0.0;
-        }
-        for (count = 0; count < 6001; count++) {
-            aTL[count] = 0.0;
-            aTR[count] = 0.0;
-        }
-        for (count = 0; count < 5837; count++) {
-            aUL[count] = 0.0;
-            aUR[count] = 0.0;
-        }
-        for (count = 0; count < 5501; count++) {
-            aVL[count] = 0.0;
-            aVR[count] = 0.0;
-        }
-        for (count = 0; count < 5009; count++) {
-            aWL[count] = 0.0;
-            aWR[count] = 0.0;
-        }
-        for (count = 0; count < 4849; count++) {
-            aXL[count] = 0.0;
-            aXR[count] = 0.0;
-        }
-        for (count = 0; count < 4295; count++) {
-            aYL[count] = 0.0;
-            aYR[count] = 0.0;
-        }
-        for (count = 0; count < 4179; count++) {
-            aZL[count] = 0.0;
-            aZR[count] = 0.0;
-        }
+        onSampleRateChange();
+
+        aAL.clear();
+        aAR.clear();
+        aBL.clear();
+        aBR.clear();
+        aCL.clear();
+        aCR.clear();
+        aDL.clear();
+        aDR.clear();
+        aEL.clear();
+        aER.clear();
+        aFL.clear();
+        aFR.clear();
+        aGL.clear();
+        aGR.clear();
+        aHL.clear();
+        aHR.clear();
+        aIL.clear();
+        aIR.clear();
+        aJL.clear();
+        aJR.clear();
+        aKL.clear();
+        aKR.clear();
+        aLL.clear();
+        aLR.clear();
+        aML.clear();
+        aMR.clear();
+        aNL.clear();
+        aNR.clear();
+        aOL.clear();
+        aOR.clear();
+        aPL.clear();
+        aPR.clear();
+        aQL.clear();
+        aQR.clear();
+        aRL.clear();
+        aRR.clear();
+        aSL.clear();
+        aSR.clear();
+        aTL.clear();
+        aTR.clear();
+        aUL.clear();
+        aUR.clear();
+        aVL.clear();
+        aVR.clear();
+        aWL.clear();
+        aWR.clear();
+        aXL.clear();
+        aXR.clear();
+        aYL.clear();
+        aYR.clear();
+        aZL.clear();
+        aZR.clear();
 
         alpA = 1;
         delayA = 7573;
@@ -439,6 +399,8 @@ struct Mv : Module {
 
     void onSampleRateChange() override
     {
+        // tail depends on the regeneration, recalculated in process
+        tailFeedbackLevel = -1.0;
     }
 
     json_t* dataToJson() override
@@ -459,10 +421,94 @@ struct Mv : Module {
             quality = json_integer_value(qualityJ);
     }
 
+    // zero a little more of the delay memory left stale by the last reset
+    void sweepDelays()
+    {
+        aAL.sweep();
+        aAR.sweep();
+        aBL.sweep();
+        aBR.sweep();
+        aCL.sweep();
+        aCR.sweep();
+        aDL.sweep();
+        aDR.sweep();
+        aEL.sweep();
+        aER.sweep();
+        aFL.sweep();
+        aFR.sweep();
+        aGL.sweep();
+        aGR.sweep();
+        aHL.sweep();
+        aHR.sweep();
+        aIL.sweep();
+        aIR.sweep();
+        aJL.sweep();
+        aJR.sweep();
+        aKL.sweep();
+        aKR.sweep();
+        aLL.sweep();
+        aLR.sweep();
+        aML.sweep();
+        aMR.sweep();
+        aNL.sweep();
+        aNR.sweep();
+        aOL.sweep();
+        aOR.sweep();
+        aPL.sweep();
+        aPR.sweep();
+        aQL.sweep();
+        aQR.sweep();
+        aRL.sweep();
+        aRR.sweep();
+        aSL.sweep();
+        aSR.sweep();
+        aTL.sweep();
+        aTR.sweep();
+        aUL.sweep();
+        aUR.sweep();
+        aVL.sweep();
+        aVR.sweep();
+        aWL.sweep();
+        aWR.sweep();
+        aXL.sweep();
+        aXR.sweep();
+        aYL.sweep();
+        aYR.sweep();
+        aZL.sweep();
+        aZR.sweep();
+    }
+
+    void selectKernel()
+    {
+        kernel = (quality == HIGH) ? &Mv::processKernel<HIGH> : &Mv::processKernel<ECO>;
+        kernelQuality = quality;
+    }
+
     void process(const ProcessArgs& args) override
+    {
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
+
+        // skip the dsp once the inputs have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs[IN_L_INPUT]) && isSilent(inputs[IN_R_INPUT]))) {
+            dspStats.sleep();
+            clearOutputs(outputs);
+            return;
+        }
+
+        if (quality != kernelQuality) {
+            selectKernel();
+        }
+
+        (this->*kernel)(args);
+    }
+
+    template <int QUALITY>
+    void processKernel(const ProcessArgs& args)
     {
         if (outputs[OUT_L_OUTPUT].isConnected() || outputs[OUT_R_OUTPUT].isConnected()) {
 
+            sweepDelays();
+
             depthParam = inputs[DEPTH_CV_INPUT].getVoltage() * params[DEPTH_CV_PARAM].getValue() / 5;
             depthParam += params[DEPTH_PARAM].getValue();
             depthParam = clamp(depthParam, 0.01f, 0.99f);
@@ -499,6 +545,17 @@ struct Mv : Module {
             if (feedbacklevel > 0.99)
                 feedbacklevel = 1.0;
 
+            if (feedbacklevel != tailFeedbackLevel) {
+                // tail: the allpass chain (236424 samples at full depth) rings out over ~20 passes at
+                // its fixed 0.5 gain, plus another pass for every 6 dB the regeneration feeds back
+                double passes = 20.0;
+                if (feedbacklevel > 0.0 && feedbacklevel < 1.0) {
+                    passes += -120.0 / (20.0 * log10(feedbacklevel));
+                }
+                silenceDetector.setTail(passes * 236424.0, args.sampleRate);
+                tailFeedbackLevel = feedbacklevel;
+            }
+
             double wet = drywetParam;
 
             // get inputs
@@ -509,7 +566,7 @@ struct Mv : Module {
             inputSampleL *= gainCut;
             inputSampleR *= gainCut;
 
-            if (quality == HIGH) {
+            if (QUALITY == HIGH) {
                 //for live air, we always apply the dither noise. Then, if our result is
                 //effectively digital black, we'll subtract it again. We want a 'air' hiss
                 static int noisesourceL = 0;
@@ -574,20 +631,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayA) {
                     allpasstemp = delayA;
                 }
-                inputSampleL -= aAL[allpasstemp] * 0.5;
-                aAL[alpA] = inputSampleL;
+                inputSampleL -= aAL.read(allpasstemp) * 0.5;
+                aAL.write(alpA, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aAR[allpasstemp] * 0.5;
-                aAR[alpA] = inputSampleR;
+                inputSampleR -= aAR.read(allpasstemp) * 0.5;
+                aAR.write(alpA, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpA--;
                 if (alpA < 0 || alpA > delayA) {
                     alpA = delayA;
                 }
-                inputSampleL += (aAL[alpA]);
-                inputSampleR += (aAR[alpA]);
+                inputSampleL += (aAL.read(alpA));
+                inputSampleR += (aAR.read(alpA));
                 if (damp > 26) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgAL;
@@ -605,20 +662,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayB) {
                     allpasstemp = delayB;
                 }
-                inputSampleL -= aBL[allpasstemp] * 0.5;
-                aBL[alpB] = inputSampleL;
+                inputSampleL -= aBL.read(allpasstemp) * 0.5;
+                aBL.write(alpB, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aBR[allpasstemp] * 0.5;
-                aBR[alpB] = inputSampleR;
+                inputSampleR -= aBR.read(allpasstemp) * 0.5;
+                aBR.write(alpB, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpB--;
                 if (alpB < 0 || alpB > delayB) {
                     alpB = delayB;
                 }
-                inputSampleL += (aBL[alpB]);
-                inputSampleR += (aBR[alpB]);
+                inputSampleL += (aBL.read(alpB));
+                inputSampleR += (aBR.read(alpB));
                 if (damp > 25) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgBL;
@@ -636,20 +693,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayC) {
                     allpasstemp = delayC;
                 }
-                inputSampleL -= aCL[allpasstemp] * 0.5;
-                aCL[alpC] = inputSampleL;
+                inputSampleL -= aCL.read(allpasstemp) * 0.5;
+                aCL.write(alpC, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aCR[allpasstemp] * 0.5;
-                aCR[alpC] = inputSampleR;
+                inputSampleR -= aCR.read(allpasstemp) * 0.5;
+                aCR.write(alpC, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpC--;
                 if (alpC < 0 || alpC > delayC) {
                     alpC = delayC;
                 }
-                inputSampleL += (aCL[alpC]);
-                inputSampleR += (aCR[alpC]);
+                inputSampleL += (aCL.read(alpC));
+                inputSampleR += (aCR.read(alpC));
                 if (damp > 24) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgCL;
@@ -667,20 +724,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayD) {
                     allpasstemp = delayD;
                 }
-                inputSampleL -= aDL[allpasstemp] * 0.5;
-                aDL[alpD] = inputSampleL;
+                inputSampleL -= aDL.read(allpasstemp) * 0.5;
+                aDL.write(alpD, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aDR[allpasstemp] * 0.5;
-                aDR[alpD] = inputSampleR;
+                inputSampleR -= aDR.read(allpasstemp) * 0.5;
+                aDR.write(alpD, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpD--;
                 if (alpD < 0 || alpD > delayD) {
                     alpD = delayD;
                 }
-                inputSampleL += (aDL[alpD]);
-                inputSampleR += (aDR[alpD]);
+                inputSampleL += (aDL.read(alpD));
+                inputSampleR += (aDR.read(alpD));
                 if (damp > 23) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgDL;
@@ -698,20 +755,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayE) {
                     allpasstemp = delayE;
                 }
-                inputSampleL -= aEL[allpasstemp] * 0.5;
-                aEL[alpE] = inputSampleL;
+                inputSampleL -= aEL.read(allpasstemp) * 0.5;
+                aEL.write(alpE, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aER[allpasstemp] * 0.5;
-                aER[alpE] = inputSampleR;
+                inputSampleR -= aER.read(allpasstemp) * 0.5;
+                aER.write(alpE, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpE--;
                 if (alpE < 0 || alpE > delayE) {
                     alpE = delayE;
                 }
-                inputSampleL += (aEL[alpE]);
-                inputSampleR += (aER[alpE]);
+                inputSampleL += (aEL.read(alpE));
+                inputSampleR += (aER.read(alpE));
                 if (damp > 22) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgEL;
@@ -729,20 +786,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayF) {
                     allpasstemp = delayF;
                 }
-                inputSampleL -= aFL[allpasstemp] * 0.5;
-                aFL[alpF] = inputSampleL;
+                inputSampleL -= aFL.read(allpasstemp) * 0.5;
+                aFL.write(alpF, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aFR[allpasstemp] * 0.5;
-                aFR[alpF] = inputSampleR;
+                inputSampleR -= aFR.read(allpasstemp) * 0.5;
+                aFR.write(alpF, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpF--;
                 if (alpF < 0 || alpF > delayF) {
                     alpF = delayF;
                 }
-                inputSampleL += (aFL[alpF]);
-                inputSampleR += (aFR[alpF]);
+                inputSampleL += (aFL.read(alpF));
+                inputSampleR += (aFR.read(alpF));
                 if (damp > 21) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgFL;
@@ -760,20 +817,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayG) {
                     allpasstemp = delayG;
                 }
-                inputSampleL -= aGL[allpasstemp] * 0.5;
-                aGL[alpG] = inputSampleL;
+                inputSampleL -= aGL.read(allpasstemp) * 0.5;
+                aGL.write(alpG, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aGR[allpasstemp] * 0.5;
-                aGR[alpG] = inputSampleR;
+                inputSampleR -= aGR.read(allpasstemp) * 0.5;
+                aGR.write(alpG, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpG--;
                 if (alpG < 0 || alpG > delayG) {
                     alpG = delayG;
                 }
-                inputSampleL += (aGL[alpG]);
-                inputSampleR += (aGR[alpG]);
+                inputSampleL += (aGL.read(alpG));
+                inputSampleR += (aGR.read(alpG));
                 if (damp > 20) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgGL;
@@ -791,20 +848,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayH) {
                     allpasstemp = delayH;
                 }
-                inputSampleL -= aHL[allpasstemp] * 0.5;
-                aHL[alpH] = inputSampleL;
+                inputSampleL -= aHL.read(allpasstemp) * 0.5;
+                aHL.write(alpH, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aHR[allpasstemp] * 0.5;
-                aHR[alpH] = inputSampleR;
+                inputSampleR -= aHR.read(allpasstemp) * 0.5;
+                aHR.write(alpH, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpH--;
                 if (alpH < 0 || alpH > delayH) {
                     alpH = delayH;
                 }
-                inputSampleL += (aHL[alpH]);
-                inputSampleR += (aHR[alpH]);
+                inputSampleL += (aHL.read(alpH));
+                inputSampleR += (aHR.read(alpH));
                 if (damp > 19) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgHL;
@@ -822,20 +879,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayI) {
                     allpasstemp = delayI;
                 }
-                inputSampleL -= aIL[allpasstemp] * 0.5;
-                aIL[alpI] = inputSampleL;
+                inputSampleL -= aIL.read(allpasstemp) * 0.5;
+                aIL.write(alpI, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aIR[allpasstemp] * 0.5;
-                aIR[alpI] = inputSampleR;
+                inputSampleR -= aIR.read(allpasstemp) * 0.5;
+                aIR.write(alpI, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpI--;
                 if (alpI < 0 || alpI > delayI) {
                     alpI = delayI;
                 }
-                inputSampleL += (aIL[alpI]);
-                inputSampleR += (aIR[alpI]);
+                inputSampleL += (aIL.read(alpI));
+                inputSampleR += (aIR.read(alpI));
                 if (damp > 18) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgIL;
@@ -853,20 +910,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayJ) {
                     allpasstemp = delayJ;
                 }
-                inputSampleL -= aJL[allpasstemp] * 0.5;
-                aJL[alpJ] = inputSampleL;
+                inputSampleL -= aJL.read(allpasstemp) * 0.5;
+                aJL.write(alpJ, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aJR[allpasstemp] * 0.5;
-                aJR[alpJ] = inputSampleR;
+                inputSampleR -= aJR.read(allpasstemp) * 0.5;
+                aJR.write(alpJ, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpJ--;
                 if (alpJ < 0 || alpJ > delayJ) {
                     alpJ = delayJ;
                 }
-                inputSampleL += (aJL[alpJ]);
-                inputSampleR += (aJR[alpJ]);
+                inputSampleL += (aJL.read(alpJ));
+                inputSampleR += (aJR.read(alpJ));
                 if (damp > 17) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgJL;
@@ -884,20 +941,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayK) {
                     allpasstemp = delayK;
                 }
-                inputSampleL -= aKL[allpasstemp] * 0.5;
-                aKL[alpK] = inputSampleL;
+                inputSampleL -= aKL.read(allpasstemp) * 0.5;
+                aKL.write(alpK, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aKR[allpasstemp] * 0.5;
-                aKR[alpK] = inputSampleR;
+                inputSampleR -= aKR.read(allpasstemp) * 0.5;
+                aKR.write(alpK, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpK--;
                 if (alpK < 0 || alpK > delayK) {
                     alpK = delayK;
                 }
-                inputSampleL += (aKL[alpK]);
-                inputSampleR += (aKR[alpK]);
+                inputSampleL += (aKL.read(alpK));
+                inputSampleR += (aKR.read(alpK));
                 if (damp > 16) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgKL;
@@ -915,20 +972,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayL) {
                     allpasstemp = delayL;
                 }
-                inputSampleL -= aLL[allpasstemp] * 0.5;
-                aLL[alpL] = inputSampleL;
+                inputSampleL -= aLL.read(allpasstemp) * 0.5;
+                aLL.write(alpL, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aLR[allpasstemp] * 0.5;
-                aLR[alpL] = inputSampleR;
+                inputSampleR -= aLR.read(allpasstemp) * 0.5;
+                aLR.write(alpL, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpL--;
                 if (alpL < 0 || alpL > delayL) {
                     alpL = delayL;
                 }
-                inputSampleL += (aLL[alpL]);
-                inputSampleR += (aLR[alpL]);
+                inputSampleL += (aLL.read(alpL));
+                inputSampleR += (aLR.read(alpL));
                 if (damp > 15) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgLL;
@@ -946,20 +1003,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayM) {
                     allpasstemp = delayM;
                 }
-                inputSampleL -= aML[allpasstemp] * 0.5;
-                aML[alpM] = inputSampleL;
+                inputSampleL -= aML.read(allpasstemp) * 0.5;
+                aML.write(alpM, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aMR[allpasstemp] * 0.5;
-                aMR[alpM] = inputSampleR;
+                inputSampleR -= aMR.read(allpasstemp) * 0.5;
+                aMR.write(alpM, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpM--;
                 if (alpM < 0 || alpM > delayM) {
                     alpM = delayM;
                 }
-                inputSampleL += (aML[alpM]);
-                inputSampleR += (aMR[alpM]);
+                inputSampleL += (aML.read(alpM));
+                inputSampleR += (aMR.read(alpM));
                 if (damp > 14) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgML;
@@ -977,20 +1034,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayN) {
                     allpasstemp = delayN;
                 }
-                inputSampleL -= aNL[allpasstemp] * 0.5;
-                aNL[alpN] = inputSampleL;
+                inputSampleL -= aNL.read(allpasstemp) * 0.5;
+                aNL.write(alpN, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aNR[allpasstemp] * 0.5;
-                aNR[alpN] = inputSampleR;
+                inputSampleR -= aNR.read(allpasstemp) * 0.5;
+                aNR.write(alpN, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpN--;
                 if (alpN < 0 || alpN > delayN) {
                     alpN = delayN;
                 }
-                inputSampleL += (aNL[alpN]);
-                inputSampleR += (aNR[alpN]);
+                inputSampleL += (aNL.read(alpN));
+                inputSampleR += (aNR.read(alpN));
                 if (damp > 13) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgNL;
@@ -1008,20 +1065,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayO) {
                     allpasstemp = delayO;
                 }
-                inputSampleL -= aOL[allpasstemp] * 0.5;
-                aOL[alpO] = inputSampleL;
+                inputSampleL -= aOL.read(allpasstemp) * 0.5;
+                aOL.write(alpO, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aOR[allpasstemp] * 0.5;
-                aOR[alpO] = inputSampleR;
+                inputSampleR -= aOR.read(allpasstemp) * 0.5;
+                aOR.write(alpO, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpO--;
                 if (alpO < 0 || alpO > delayO) {
                     alpO = delayO;
                 }
-                inputSampleL += (aOL[alpO]);
-                inputSampleR += (aOR[alpO]);
+                inputSampleL += (aOL.read(alpO));
+                inputSampleR += (aOR.read(alpO));
                 if (damp > 12) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgOL;
@@ -1039,20 +1096,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayP) {
                     allpasstemp = delayP;
                 }
-                inputSampleL -= aPL[allpasstemp] * 0.5;
-                aPL[alpP] = inputSampleL;
+                inputSampleL -= aPL.read(allpasstemp) * 0.5;
+                aPL.write(alpP, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aPR[allpasstemp] * 0.5;
-                aPR[alpP] = inputSampleR;
+                inputSampleR -= aPR.read(allpasstemp) * 0.5;
+                aPR.write(alpP, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpP--;
                 if (alpP < 0 || alpP > delayP) {
                     alpP = delayP;
                 }
-                inputSampleL += (aPL[alpP]);
-                inputSampleR += (aPR[alpP]);
+                inputSampleL += (aPL.read(alpP));
+                inputSampleR += (aPR.read(alpP));
                 if (damp > 11) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgPL;
@@ -1070,20 +1127,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayQ) {
                     allpasstemp = delayQ;
                 }
-                inputSampleL -= aQL[allpasstemp] * 0.5;
-                aQL[alpQ] = inputSampleL;
+                inputSampleL -= aQL.read(allpasstemp) * 0.5;
+                aQL.write(alpQ, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aQR[allpasstemp] * 0.5;
-                aQR[alpQ] = inputSampleR;
+                inputSampleR -= aQR.read(allpasstemp) * 0.5;
+                aQR.write(alpQ, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpQ--;
                 if (alpQ < 0 || alpQ > delayQ) {
                     alpQ = delayQ;
                 }
-                inputSampleL += (aQL[alpQ]);
-                inputSampleR += (aQR[alpQ]);
+                inputSampleL += (aQL.read(alpQ));
+                inputSampleR += (aQR.read(alpQ));
                 if (damp > 10) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgQL;
@@ -1101,20 +1158,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayR) {
                     allpasstemp = delayR;
                 }
-                inputSampleL -= aRL[allpasstemp] * 0.5;
-                aRL[alpR] = inputSampleL;
+                inputSampleL -= aRL.read(allpasstemp) * 0.5;
+                aRL.write(alpR, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aRR[allpasstemp] * 0.5;
-                aRR[alpR] = inputSampleR;
+                inputSampleR -= aRR.read(allpasstemp) * 0.5;
+                aRR.write(alpR, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpR--;
                 if (alpR < 0 || alpR > delayR) {
                     alpR = delayR;
                 }
-                inputSampleL += (aRL[alpR]);
-                inputSampleR += (aRR[alpR]);
+                inputSampleL += (aRL.read(alpR));
+                inputSampleR += (aRR.read(alpR));
                 if (damp > 9) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgRL;
@@ -1132,20 +1189,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayS) {
                     allpasstemp = delayS;
                 }
-                inputSampleL -= aSL[allpasstemp] * 0.5;
-                aSL[alpS] = inputSampleL;
+                inputSampleL -= aSL.read(allpasstemp) * 0.5;
+                aSL.write(alpS, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aSR[allpasstemp] * 0.5;
-                aSR[alpS] = inputSampleR;
+                inputSampleR -= aSR.read(allpasstemp) * 0.5;
+                aSR.write(alpS, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpS--;
                 if (alpS < 0 || alpS > delayS) {
                     alpS = delayS;
                 }
-                inputSampleL += (aSL[alpS]);
-                inputSampleR += (aSR[alpS]);
+                inputSampleL += (aSL.read(alpS));
+                inputSampleR += (aSR.read(alpS));
                 if (damp > 8) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgSL;
@@ -1163,20 +1220,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayT) {
                     allpasstemp = delayT;
                 }
-                inputSampleL -= aTL[allpasstemp] * 0.5;
-                aTL[alpT] = inputSampleL;
+                inputSampleL -= aTL.read(allpasstemp) * 0.5;
+                aTL.write(alpT, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aTR[allpasstemp] * 0.5;
-                aTR[alpT] = inputSampleR;
+                inputSampleR -= aTR.read(allpasstemp) * 0.5;
+                aTR.write(alpT, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpT--;
                 if (alpT < 0 || alpT > delayT) {
                     alpT = delayT;
                 }
-                inputSampleL += (aTL[alpT]);
-                inputSampleR += (aTR[alpT]);
+                inputSampleL += (aTL.read(alpT));
+                inputSampleR += (aTR.read(alpT));
                 if (damp > 7) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgTL;
@@ -1194,20 +1251,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayU) {
                     allpasstemp = delayU;
                 }
-                inputSampleL -= aUL[allpasstemp] * 0.5;
-                aUL[alpU] = inputSampleL;
+                inputSampleL -= aUL.read(allpasstemp) * 0.5;
+                aUL.write(alpU, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aUR[allpasstemp] * 0.5;
-                aUR[alpU] = inputSampleR;
+                inputSampleR -= aUR.read(allpasstemp) * 0.5;
+                aUR.write(alpU, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpU--;
                 if (alpU < 0 || alpU > delayU) {
                     alpU = delayU;
                 }
-                inputSampleL += (aUL[alpU]);
-                inputSampleR += (aUR[alpU]);
+                inputSampleL += (aUL.read(alpU));
+                inputSampleR += (aUR.read(alpU));
                 if (damp > 6) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgUL;
@@ -1225,20 +1282,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayV) {
                     allpasstemp = delayV;
                 }
-                inputSampleL -= aVL[allpasstemp] * 0.5;
-                aVL[alpV] = inputSampleL;
+                inputSampleL -= aVL.read(allpasstemp) * 0.5;
+                aVL.write(alpV, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aVR[allpasstemp] * 0.5;
-                aVR[alpV] = inputSampleR;
+                inputSampleR -= aVR.read(allpasstemp) * 0.5;
+                aVR.write(alpV, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpV--;
                 if (alpV < 0 || alpV > delayV) {
                     alpV = delayV;
                 }
-                inputSampleL += (aVL[alpV]);
-                inputSampleR += (aVR[alpV]);
+                inputSampleL += (aVL.read(alpV));
+                inputSampleR += (aVR.read(alpV));
                 if (damp > 5) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgVL;
@@ -1256,20 +1313,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayW) {
                     allpasstemp = delayW;
                 }
-                inputSampleL -= aWL[allpasstemp] * 0.5;
-                aWL[alpW] = inputSampleL;
+                inputSampleL -= aWL.read(allpasstemp) * 0.5;
+                aWL.write(alpW, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aWR[allpasstemp] * 0.5;
-                aWR[alpW] = inputSampleR;
+                inputSampleR -= aWR.read(allpasstemp) * 0.5;
+                aWR.write(alpW, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpW--;
                 if (alpW < 0 || alpW > delayW) {
                     alpW = delayW;
                 }
-                inputSampleL += (aWL[alpW]);
-                inputSampleR += (aWR[alpW]);
+                inputSampleL += (aWL.read(alpW));
+                inputSampleR += (aWR.read(alpW));
                 if (damp > 4) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgWL;
@@ -1287,20 +1344,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayX) {
                     allpasstemp = delayX;
                 }
-                inputSampleL -= aXL[allpasstemp] * 0.5;
-                aXL[alpX] = inputSampleL;
+                inputSampleL -= aXL.read(allpasstemp) * 0.5;
+                aXL.write(alpX, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aXR[allpasstemp] * 0.5;
-                aXR[alpX] = inputSampleR;
+                inputSampleR -= aXR.read(allpasstemp) * 0.5;
+                aXR.write(alpX, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpX--;
                 if (alpX < 0 || alpX > delayX) {
                     alpX = delayX;
                 }
-                inputSampleL += (aXL[alpX]);
-                inputSampleR += (aXR[alpX]);
+                inputSampleL += (aXL.read(alpX));
+                inputSampleR += (aXR.read(alpX));
                 if (damp > 3) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgXL;
@@ -1318,20 +1375,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayY) {
                     allpasstemp = delayY;
                 }
-                inputSampleL -= aYL[allpasstemp] * 0.5;
-                aYL[alpY] = inputSampleL;
+                inputSampleL -= aYL.read(allpasstemp) * 0.5;
+                aYL.write(alpY, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aYR[allpasstemp] * 0.5;
-                aYR[alpY] = inputSampleR;
+                inputSampleR -= aYR.read(allpasstemp) * 0.5;
+                aYR.write(alpY, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpY--;
                 if (alpY < 0 || alpY > delayY) {
                     alpY = delayY;
                 }
-                inputSampleL += (aYL[alpY]);
-                inputSampleR += (aYR[alpY]);
+                inputSampleL += (aYL.read(alpY));
+                inputSampleR += (aYR.read(alpY));
                 if (damp > 2) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgYL;
@@ -1349,20 +1406,20 @@ struct Mv : Module {
                 if (allpasstemp < 0 || allpasstemp > delayZ) {
                     allpasstemp = delayZ;
                 }
-                inputSampleL -= aZL[allpasstemp] * 0.5;
-                aZL[alpZ] = inputSampleL;
+                inputSampleL -= aZL.read(allpasstemp) * 0.5;
+                aZL.write(alpZ, inputSampleL);
                 inputSampleL *= 0.5;
 
-                inputSampleR -= aZR[allpasstemp] * 0.5;
-                aZR[alpZ] = inputSampleR;
+                inputSampleR -= aZR.read(allpasstemp) * 0.5;
+                aZR.write(alpZ, inputSampleR);
                 inputSampleR *= 0.5;
 
                 alpZ--;
                 if (alpZ < 0 || alpZ > delayZ) {
                     alpZ = delayZ;
                 }
-                inputSampleL += (aZL[alpZ]);
-                inputSampleR += (aZR[alpZ]);
+                inputSampleL += (aZL.read(alpZ));
+                inputSampleR += (aZR.read(alpZ));
                 if (damp > 1) {
                     avgtemp = inputSampleL;
                     inputSampleL += avgZL;
@@ -1403,7 +1460,8 @@ struct Mv : Module {
             inputSampleL *= gainBoost;
             inputSampleR *= gainBoost;
 
-            if (quality == HIGH) {
+            if (QUALITY == HIGH) {
+                DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
                 //begin 64 bit stereo floating point dither
                 int expon;
                 frexp((double)inputSampleL, &expon);
@@ -1465,12 +1523,18 @@ struct MvWidget : ModuleWidget {
         high->module = module;
         high->quality = 1;
         menu->addChild(high);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
     }
 
     MvWidget(Mv* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/mv_dark.svg")));
+        setPanel(loadArtwork("mv_dark.svg"));
 
         // screws
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH, 0)));
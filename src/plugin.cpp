@@ -1,4 +1,9 @@
 #include "plugin.hpp"
+#include <mutex>
+#include <set>
+#if defined ARCH_WIN
+#include <windows.h>
+#endif
 
 Plugin* pluginInstance;
 
@@ -6,6 +11,9 @@ void init(Plugin* p)
 {
     pluginInstance = p;
 
+    // read Rackwindows.json once, before any module asks for its defaults
+    loadSettings();
+
     // Add modules here
     // p->addModel(modelAcceleration);
     p->addModel(modelBitshiftgain);
@@ -27,255 +35,390 @@ void init(Plugin* p)
     p->addModel(modelTremolo);
     p->addModel(modelVibrato);
 
+    // pick the widest SIMD kernels this CPU supports
+    INFO("Rackwindows: using %s kernels", rwlib::initSimdKernels());
+
     // Any other plugin initialization may go here.
     // As an alternative, consider lazy-loading assets and lookup tables when your module is created to reduce startup times of Rack.
 }
 
 /* Other stuff */
 
+/* #settings
+======================================================================================== */
+// Rackwindows.json is parsed once in init() and kept in memory, so module constructors and
+// menus only touch the cache. A change only updates the cache. flushSettings() rewrites the
+// whole file (through a temp file and a rename) on the UI thread, when the menu that made the
+// change closes (see SettingsItem), so nothing is left to write during static destruction,
+// when Rack's globals may already be gone.
+struct Settings {
+    std::mutex mutex;
+    json_t* rootJ = NULL;
+    std::string filename; // resolved in load(), while asset::user() can be called
+    bool isDirty = false;
+
+    ~Settings()
+    {
+        if (rootJ) {
+            json_decref(rootJ);
+        }
+    }
+
+    void load()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (rootJ) {
+            json_decref(rootJ);
+        }
+        filename = asset::user("Rackwindows.json");
+        FILE* file = fopen(filename.c_str(), "r");
+        if (file) {
+            json_error_t error;
+            rootJ = json_loadf(file, 0, &error);
+            fclose(file);
+        } else {
+            rootJ = NULL;
+        }
+        if (!rootJ || !json_is_object(rootJ)) {
+            // missing or invalid setting json file
+            if (rootJ) {
+                json_decref(rootJ);
+            }
+            rootJ = json_object();
+            write();
+        }
+    }
+
+    // caller holds the mutex
+    void write()
+    {
+        std::string tempFilename = filename + ".tmp";
+        FILE* file = fopen(tempFilename.c_str(), "w");
+        if (!file) {
+            return;
+        }
+        int err = json_dumpf(rootJ, file, JSON_INDENT(2) | JSON_REAL_PRECISION(9));
+        err |= fclose(file);
+        if (err) {
+            remove(tempFilename.c_str());
+            return;
+        }
+#if defined ARCH_WIN
+        // rename() does not replace an existing file on Windows, MoveFileEx() does in one step
+        MoveFileExA(tempFilename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+        rename(tempFilename.c_str(), filename.c_str());
+#endif
+        isDirty = false;
+    }
+
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (isDirty && !filename.empty()) {
+            write();
+        }
+    }
+
+    // caller holds the mutex
+    void set(const char* key, json_t* valueJ)
+    {
+        if (!rootJ) {
+            rootJ = json_object();
+        }
+        json_object_set_new(rootJ, key, valueJ);
+        isDirty = true;
+    }
+
+    void setBool(const char* key, bool value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        set(key, json_boolean(value));
+    }
+
+    void setInt(const char* key, int value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        set(key, json_integer(value));
+    }
+
+    bool getBool(const char* key)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        json_t* valueJ = rootJ ? json_object_get(rootJ, key) : NULL;
+        return valueJ ? json_boolean_value(valueJ) : false;
+    }
+
+    int getInt(const char* key)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        json_t* valueJ = rootJ ? json_object_get(rootJ, key) : NULL;
+        return valueJ ? json_integer_value(valueJ) : 0;
+    }
+};
+
+static Settings settings;
+
+void loadSettings()
+{
+    settings.load();
+}
+
+void flushSettings()
+{
+    settings.flush();
+}
+
 /* #quality mode
 ======================================================================================== */
 void saveQuality(bool quality)
 {
-    json_t* settingsJ = json_object();
-    json_object_set_new(settingsJ, "quality", json_boolean(quality));
-    std::string settingsFilename = asset::user("Rackwindows.json");
-    FILE* file = fopen(settingsFilename.c_str(), "w");
-    if (file) {
-        json_dumpf(settingsJ, file, JSON_INDENT(2) | JSON_REAL_PRECISION(9));
-        fclose(file);
-    }
-    json_decref(settingsJ);
+    settings.setBool("quality", quality);
 }
 
 bool loadQuality()
 {
-    bool ret = false;
-    std::string settingsFilename = asset::user("Rackwindows.json");
-    FILE* file = fopen(settingsFilename.c_str(), "r");
-    if (!file) {
-        saveQuality(false);
-        return ret;
-    }
-    json_error_t error;
-    json_t* settingsJ = json_loadf(file, 0, &error);
-    if (!settingsJ) {
-        // invalid setting json file
-        fclose(file);
-        saveQuality(false);
-        return ret;
-    }
-    json_t* qualityJ = json_object_get(settingsJ, "quality");
-    if (qualityJ)
-        ret = json_boolean_value(qualityJ);
-
-    fclose(file);
-    json_decref(settingsJ);
-    return ret;
+    return settings.getBool("quality");
 }
 
 void saveHighQualityAsDefault(bool highQualityAsDefault)
 {
-    json_t* settingsJ = json_object();
-    json_object_set_new(settingsJ, "highQualityAsDefault", json_boolean(highQualityAsDefault));
-    std::string settingsFilename = asset::user("Rackwindows.json");
-    FILE* file = fopen(settingsFilename.c_str(), "w");
-    if (file) {
-        json_dumpf(settingsJ, file, JSON_INDENT(2) | JSON_REAL_PRECISION(9));
-        fclose(file);
-    }
-    json_decref(settingsJ);
+    settings.setBool("highQualityAsDefault", highQualityAsDefault);
 }
 
 // https://github.com/MarcBoule/Geodesics/blob/master/src/Geodesics.cpp
 bool loadHighQualityAsDefault()
 {
-    bool ret = false;
-    std::string settingsFilename = asset::user("Rackwindows.json");
-    FILE* file = fopen(settingsFilename.c_str(), "r");
-    if (!file) {
-        saveHighQualityAsDefault(false);
-        return ret;
-    }
-    json_error_t error;
-    json_t* settingsJ = json_loadf(file, 0, &error);
-    if (!settingsJ) {
-        // invalid setting json file
-        fclose(file);
-        saveHighQualityAsDefault(false);
-        return ret;
-    }
-    json_t* highQualityAsDefaultJ = json_object_get(settingsJ, "highQualityAsDefault");
-    if (highQualityAsDefaultJ)
-        ret = json_boolean_value(highQualityAsDefaultJ);
-
-    fclose(file);
-    json_decref(settingsJ);
-    return ret;
+    return settings.getBool("highQualityAsDefault");
 }
 
 /* #console type (Console, Console MM)
 ======================================================================================== */
+// stored as a boolean for compatibility with existing settings files
 void saveConsoleType(int consoleType)
 {
-    json_t* settingsJ = json_object();
-    json_object_set_new(settingsJ, "consoleType", json_boolean(consoleType));
-    std::string settingsFilename = asset::user("Rackwindows.json");
-    FILE* file = fopen(settingsFilename.c_str(), "w");
-    if (file) {
-        json_dumpf(settingsJ, file, JSON_INDENT(2) | JSON_REAL_PRECISION(9));
-        fclose(file);
-    }
-    json_decref(settingsJ);
+    settings.setBool("consoleType", consoleType);
 }
 
 int loadConsoleType()
 {
-    bool ret = false;
-    std::string settingsFilename = asset::user("Rackwindows.json");
-    FILE* file = fopen(settingsFilename.c_str(), "r");
-    if (!file) {
-        saveConsoleType(false);
-        return ret;
-    }
-    json_error_t error;
-    json_t* settingsJ = json_loadf(file, 0, &error);
-    if (!settingsJ) {
-        // invalid setting json file
-        fclose(file);
-        saveConsoleType(false);
-        return ret;
-    }
-    json_t* consoleTypeJ = json_object_get(settingsJ, "consoleType");
-    if (consoleTypeJ)
-        ret = json_boolean_value(consoleTypeJ);
-
-    fclose(file);
-    json_decref(settingsJ);
-    return ret;
+    return settings.getBool("consoleType");
 }
 
 /* #slew type (Rasp)
 ======================================================================================== */
 void saveSlewType(int slewType)
 {
-    json_t* settingsJ = json_object();
-    json_object_set_new(settingsJ, "slewType", json_integer(slewType));
-    std::string settingsFilename = asset::user("Rackwindows.json");
-    FILE* file = fopen(settingsFilename.c_str(), "w");
-    if (file) {
-        json_dumpf(settingsJ, file, JSON_INDENT(2) | JSON_REAL_PRECISION(9));
-        fclose(file);
-    }
-    json_decref(settingsJ);
+    settings.setInt("slewType", slewType);
 }
 
 int loadSlewType()
 {
-    bool ret = false;
-    std::string settingsFilename = asset::user("Rackwindows.json");
-    FILE* file = fopen(settingsFilename.c_str(), "r");
-    if (!file) {
-        saveSlewType(false);
-        return ret;
-    }
-    json_error_t error;
-    json_t* settingsJ = json_loadf(file, 0, &error);
-    if (!settingsJ) {
-        // invalid setting json file
-        fclose(file);
-        saveSlewType(false);
-        return ret;
-    }
-    json_t* slewTypeJ = json_object_get(settingsJ, "slewType");
-    if (slewTypeJ)
-        ret = json_integer_value(slewTypeJ);
-
-    fclose(file);
-    json_decref(settingsJ);
-    return ret;
+    return settings.getInt("slewType");
 }
 
 /* #direct output mode (Console MM)
 ======================================================================================== */
-void saveDirectOutMode(bool directOutMode)
+void saveDirectOutMode(int directOutMode)
 {
-    json_t* settingsJ = json_object();
-    json_object_set_new(settingsJ, "directOutMode", json_boolean(directOutMode));
-    std::string settingsFilename = asset::user("Rackwindows.json");
-    FILE* file = fopen(settingsFilename.c_str(), "w");
-    if (file) {
-        json_dumpf(settingsJ, file, JSON_INDENT(2) | JSON_REAL_PRECISION(9));
-        fclose(file);
-    }
-    json_decref(settingsJ);
+    settings.setBool("directOutMode", directOutMode);
 }
 
 int loadDirectOutMode()
 {
-    bool ret = false;
-    std::string settingsFilename = asset::user("Rackwindows.json");
-    FILE* file = fopen(settingsFilename.c_str(), "r");
-    if (!file) {
-        saveDirectOutMode(false);
-        return ret;
-    }
-    json_error_t error;
-    json_t* settingsJ = json_loadf(file, 0, &error);
-    if (!settingsJ) {
-        // invalid setting json file
-        fclose(file);
-        saveDirectOutMode(false);
-        return ret;
-    }
-    json_t* directOutModeJ = json_object_get(settingsJ, "directOutMode");
-    if (directOutModeJ)
-        ret = json_boolean_value(directOutModeJ);
-
-    fclose(file);
-    json_decref(settingsJ);
-    return ret;
+    return settings.getBool("directOutMode");
 }
 
 /* #delay mode (Golem)
 ======================================================================================== */
+// stored as a boolean for compatibility with existing settings files
 void saveDelayMode(int delayMode)
 {
-    json_t* settingsJ = json_object();
-    json_object_set_new(settingsJ, "delayMode", json_boolean(delayMode));
-    std::string settingsFilename = asset::user("Rackwindows.json");
-    FILE* file = fopen(settingsFilename.c_str(), "w");
-    if (file) {
-        json_dumpf(settingsJ, file, JSON_INDENT(2) | JSON_REAL_PRECISION(9));
-        fclose(file);
-    }
-    json_decref(settingsJ);
+    settings.setBool("delayMode", delayMode);
 }
 
 int loadDelayMode()
 {
-    bool ret = false;
-    std::string settingsFilename = asset::user("Rackwindows.json");
-    FILE* file = fopen(settingsFilename.c_str(), "r");
-    if (!file) {
-        saveDelayMode(false);
-        return ret;
+    return settings.getBool("delayMode");
+}
+
+/* #dsp stats
+======================================================================================== */
+// every DspStats, so one menu action can dump all instances
+static std::mutex dspStatsMutex;
+static std::set<DspStats*> dspStatsInstances;
+
+DspStats::DspStats()
+{
+    std::lock_guard<std::mutex> lock(dspStatsMutex);
+    dspStatsInstances.insert(this);
+}
+
+DspStats::~DspStats()
+{
+    std::lock_guard<std::mutex> lock(dspStatsMutex);
+    dspStatsInstances.erase(this);
+}
+
+// the engine thread leaves the window alone while disabled, so it is cleared before enabling
+void DspStats::setEnabled(bool enabled)
+{
+    if (enabled && !this->enabled) {
+        cycles = peakCycles = ditherCycles = 0;
+        samples = silentSamples = denormalGuards = 0;
+        voices = 0;
+        isSleeping = false;
+        summary = Summary();
+    }
+    this->enabled = enabled;
+}
+
+// engine thread, once per second of audio
+void DspStats::summarise()
+{
+    uint32_t activeSamples = samples - silentSamples;
+    Summary s;
+    s.cyclesPerSample = activeSamples ? (float)cycles / activeSamples : 0.f;
+    s.peakCycles = peakCycles;
+    s.voices = voices;
+    s.ditherShare = cycles ? (float)ditherCycles / cycles : 0.f;
+    s.denormalGuards = denormalGuards;
+    s.silentShare = (float)silentSamples / samples;
+    s.oversampling = oversampling;
+    s.isValid = true;
+    summary = s;
+
+    cycles = peakCycles = ditherCycles = 0;
+    samples = silentSamples = denormalGuards = 0;
+    voices = 0;
+}
+
+void writeDspStats()
+{
+    json_t* modulesJ = json_array();
+    {
+        std::lock_guard<std::mutex> lock(dspStatsMutex);
+        for (DspStats* stats : dspStatsInstances) {
+            if (!stats->summary.isValid || !stats->module) {
+                continue;
+            }
+            const DspStats::Summary& s = stats->summary;
+            json_t* moduleJ = json_object();
+            json_object_set_new(moduleJ, "slug", json_string(stats->module->model->slug.c_str()));
+            json_object_set_new(moduleJ, "id", json_integer(stats->module->id));
+            json_object_set_new(moduleJ, "collecting", json_boolean(stats->enabled));
+            json_object_set_new(moduleJ, "cyclesPerSample", json_real(s.cyclesPerSample));
+            json_object_set_new(moduleJ, "peakCycles", json_real(s.peakCycles));
+            json_object_set_new(moduleJ, "voices", json_integer(s.voices));
+            json_object_set_new(moduleJ, "oversampling", json_integer(s.oversampling));
+            json_object_set_new(moduleJ, "ditherShare", json_real(s.ditherShare));
+            json_object_set_new(moduleJ, "denormalGuardsPerSecond", json_real(s.denormalGuards));
+            json_object_set_new(moduleJ, "silentShare", json_real(s.silentShare));
+            json_array_append_new(modulesJ, moduleJ);
+        }
     }
-    json_error_t error;
-    json_t* settingsJ = json_loadf(file, 0, &error);
-    if (!settingsJ) {
-        // invalid setting json file
+
+    json_t* rootJ = json_object();
+    json_object_set_new(rootJ, "modules", modulesJ);
+    std::string filename = asset::user("Rackwindows-stats.json");
+    FILE* file = fopen(filename.c_str(), "w");
+    if (file) {
+        json_dumpf(rootJ, file, JSON_INDENT(2) | JSON_REAL_PRECISION(6));
         fclose(file);
-        saveDelayMode(false);
-        return ret;
+        INFO("Rackwindows: wrote %s", filename.c_str());
+    } else {
+        WARN("Rackwindows: could not write %s", filename.c_str());
+    }
+    json_decref(rootJ);
+}
+
+struct DspStatsEnabledItem : MenuItem {
+    DspStats* stats;
+
+    void onAction(const event::Action& e) override
+    {
+        stats->setEnabled(!stats->enabled);
+    }
+
+    void step() override
+    {
+        rightText = CHECKMARK(stats->enabled);
+        MenuItem::step();
+    }
+};
+
+// one line of the summary, refreshed while the menu is open
+struct DspStatsLabel : MenuLabel {
+    enum Line {
+        CYCLES,
+        VOICES,
+        OVERSAMPLING,
+        DITHER,
+        DENORMAL_GUARDS,
+        ASLEEP,
+        NUM_LINES
+    };
+
+    DspStats* stats;
+    int line;
+
+    void step() override
+    {
+        static const char* names[NUM_LINES] = { "Cycles/sample", "Voices", "Oversampling", "High quality dither", "Denormal guards", "Asleep" };
+        const DspStats::Summary& s = stats->summary;
+        std::string value = "-";
+        if (s.isValid) {
+            switch (line) {
+            case CYCLES:
+                value = string::f("%.0f (peak %.0f)", s.cyclesPerSample, s.peakCycles);
+                break;
+            case VOICES:
+                value = string::f("%d", s.voices);
+                break;
+            case OVERSAMPLING:
+                value = string::f("%dx", s.oversampling);
+                break;
+            case DITHER:
+                value = string::f("%.1f%% of cycles", s.ditherShare * 100.f);
+                break;
+            case DENORMAL_GUARDS:
+                value = string::f("%.0f/s", s.denormalGuards);
+                break;
+            default:
+                value = string::f("%.1f%% of samples", s.silentShare * 100.f);
+                break;
+            }
+        }
+        text = std::string(names[line]) + ": " + value;
+        MenuLabel::step();
+    }
+};
+
+struct DspStatsWriteItem : MenuItem {
+    void onAction(const event::Action& e) override
+    {
+        writeDspStats();
     }
-    json_t* delayModeJ = json_object_get(settingsJ, "delayMode");
-    if (delayModeJ)
-        ret = json_boolean_value(delayModeJ);
+};
+
+Menu* DspStatsItem::createChildMenu()
+{
+    Menu* menu = new Menu;
+
+    DspStatsEnabledItem* enabled = createMenuItem<DspStatsEnabledItem>("Collect");
+    enabled->stats = stats;
+    menu->addChild(enabled);
+
+    for (int line = 0; line < DspStatsLabel::NUM_LINES; line++) {
+        DspStatsLabel* label = new DspStatsLabel;
+        label->stats = stats;
+        label->line = line;
+        menu->addChild(label);
+    }
+
+    menu->addChild(createMenuItem<DspStatsWriteItem>("Write all to Rackwindows-stats.json"));
 
-    fclose(file);
-    json_decref(settingsJ);
-    return ret;
+    return menu;
 }
 
 /* #themes
@@ -283,42 +426,13 @@ int loadDelayMode()
 // https://github.com/MarcBoule/Geodesics/blob/master/src/Geodesics.cpp
 void saveDarkAsDefault(bool darkAsDefault)
 {
-    json_t* settingsJ = json_object();
-    json_object_set_new(settingsJ, "darkAsDefault", json_boolean(darkAsDefault));
-    std::string settingsFilename = asset::user("Rackwindows.json");
-    FILE* file = fopen(settingsFilename.c_str(), "w");
-    if (file) {
-        json_dumpf(settingsJ, file, JSON_INDENT(2) | JSON_REAL_PRECISION(9));
-        fclose(file);
-    }
-    json_decref(settingsJ);
+    settings.setBool("darkAsDefault", darkAsDefault);
 }
 
 // https://github.com/MarcBoule/Geodesics/blob/master/src/Geodesics.cpp
 bool loadDarkAsDefault()
 {
-    bool ret = false;
-    std::string settingsFilename = asset::user("Rackwindows.json");
-    FILE* file = fopen(settingsFilename.c_str(), "r");
-    if (!file) {
-        saveDarkAsDefault(false);
-        return ret;
-    }
-    json_error_t error;
-    json_t* settingsJ = json_loadf(file, 0, &error);
-    if (!settingsJ) {
-        // invalid setting json file
-        fclose(file);
-        saveDarkAsDefault(false);
-        return ret;
-    }
-    json_t* darkAsDefaultJ = json_object_get(settingsJ, "darkAsDefault");
-    if (darkAsDefaultJ)
-        ret = json_boolean_value(darkAsDefaultJ);
-
-    fclose(file);
-    json_decref(settingsJ);
-    return ret;
+    return settings.getBool("darkAsDefault");
 }
 
 // https://github.com/ValleyAudio/ValleyRackFree/blob/v1.0/src/Common/DSP/NonLinear.hpp
@@ -1,8 +1,13 @@
 #pragma once
 #include "components.hpp"
 #include <math.h>
+#include <cstring>
 #include <rack.hpp>
 #include "rwlib.h"
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 using namespace rack;
 
@@ -32,6 +37,21 @@ extern Model* modelVibrato;
 
 /* Other stuff */
 
+/* #settings
+======================================================================================== */
+void loadSettings();
+
+// writes the changes made by save*() since the last flush to Rackwindows.json; UI thread
+void flushSettings();
+
+// base of the menu items that change a setting, the change is written when their menu closes
+struct SettingsItem : MenuItem {
+    ~SettingsItem()
+    {
+        flushSettings();
+    }
+};
+
 /* #quality mode
 ======================================================================================== */
 void saveQuality(bool quality);
@@ -39,7 +59,7 @@ bool loadQuality();
 void saveHighQualityAsDefault(bool highQualityAsDefault);
 bool loadHighQualityAsDefault();
 
-struct highQualityDefaultItem : MenuItem {
+struct highQualityDefaultItem : SettingsItem {
     void onAction(const event::Action& e) override
     {
         saveHighQualityAsDefault(rightText.empty()); // implicitly toggled
@@ -66,6 +86,336 @@ int loadSlewType();
 void saveDelayMode(int delayMode);
 int loadDelayMode();
 
+/* #silence detection
+======================================================================================== */
+// true if every channel of the input is digital silence (a disconnected input is silent)
+inline bool isSilent(Input& input)
+{
+    for (int c = 0; c < input.getChannels(); c++) {
+        if (input.getVoltage(c) != 0.f)
+            return false;
+    }
+    return true;
+}
+
+inline bool isSilent(std::vector<Input>& inputs)
+{
+    for (Input& input : inputs) {
+        if (!isSilent(input))
+            return false;
+    }
+    return true;
+}
+
+// zero the outputs of a sleeping module, keeping their channel counts (mono outputs may
+// report 0 channels but still hold a voltage)
+inline void clearOutputs(std::vector<Output>& outputs)
+{
+    for (Output& output : outputs) {
+        for (int c = 0; c < std::max(1, output.getChannels()); c++) {
+            output.setVoltage(0.f, c);
+        }
+    }
+}
+
+/* #poly io
+======================================================================================== */
+// All voices of a port in one aligned block. Read once, let the engine work on the voices in
+// place (one by one or as float_4 spans) and write them back once, instead of calling
+// getPolyVoltage() and setVoltage() per voice per sample.
+struct PolyBuffer {
+    alignas(16) float voltages[PORT_MAX_CHANNELS];
+    int channels;
+
+    // at least one voice, so a disconnected input reads as a single voice at 0 V; voices up
+    // to the next multiple of four are zeroed so float_4 spans never pick up stale values
+    void read(Input& input)
+    {
+        channels = std::max(1, input.getChannels());
+        std::memcpy(voltages, input.getVoltages(), channels * sizeof(float));
+        for (int c = channels; c < ((channels + 3) & ~3); c++) {
+            voltages[c] = 0.f;
+        }
+    }
+
+    void write(Output& output)
+    {
+        output.setChannels(channels);
+        output.writeVoltages(voltages);
+    }
+
+    float& operator[](int c)
+    {
+        return voltages[c];
+    }
+
+    simd::float_4 getSimd(int firstChannel)
+    {
+        return simd::float_4::load(&voltages[firstChannel]);
+    }
+
+    void setSimd(simd::float_4 v, int firstChannel)
+    {
+        v.store(&voltages[firstChannel]);
+    }
+};
+
+/* #simd fpd (Console, Console MM)
+======================================================================================== */
+// The Airwindows per-voice fpd routines for four voices at a time, fpd pointing at the
+// xorshift state of the four lanes.
+
+// replaces digital black in the lanes set in isActive with a tiny positive value
+inline simd::float_4 guardDenormals(simd::float_4 inputSample, simd::float_4 isActive, const uint32_t* fpd, uint32_t& numGuards)
+{
+    simd::float_4 isDenormal = (simd::fabs(inputSample) < 1.18e-37f) & isActive;
+    int mask = simd::movemask(isDenormal);
+    if (mask) {
+        // fpd as unsigned, halved to fit a signed int
+        simd::float_4 noise = simd::float_4(simd::int32_4::load((const int32_t*)fpd) >> 1);
+        inputSample = simd::ifelse(isDenormal, noise * 2.36e-37f, inputSample);
+        numGuards += __builtin_popcount(mask);
+    }
+    return inputSample;
+}
+
+// 32 bit floating point dither
+inline simd::float_4 ditherFloat(simd::float_4 inputSample, uint32_t* fpd)
+{
+    simd::int32_4 state = simd::int32_4::load((const int32_t*)fpd);
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    state.store((int32_t*)fpd);
+
+    // fpd - 0x7fffffff, scaled by 2^expon of frexp(inputSample), i.e. twice the power of
+    // two below |inputSample| (1 for 0), and by 5.5e-36 * 2^62
+    simd::float_4 noise = simd::float_4(state ^ simd::int32_4((int32_t)0x80000000));
+    simd::float_4 exponent = simd::float_4::cast(simd::int32_4::cast(inputSample) & simd::int32_4(0x7f800000)) * 2.f;
+    exponent = simd::ifelse(inputSample == 0.f, 1.f, exponent);
+    return inputSample + noise * exponent * 2.5364273e-17f;
+}
+
+/* #simd noise shaping (Golem, Capacitor, Capacitor Stereo, Holt, Hombre, Rasp)
+======================================================================================== */
+// The denormal fix and 32 bit dither of the scalar kernels, for four voices at a time.
+
+// rwlib::denormalize() for the first numLanes lanes, where they are digital black
+inline simd::float_4 denormalize(simd::float_4 inputSample, int numLanes)
+{
+    if (simd::movemask(simd::fabs(inputSample) < 1.2e-38f) & ((1 << numLanes) - 1)) {
+        for (int k = 0; k < numLanes; k++) {
+            inputSample[k] = rwlib::denormalize(inputSample[k]);
+        }
+    }
+    return inputSample;
+}
+
+// noise shaped 32 bit dither
+inline simd::float_4 ditherNoiseShaped(simd::float_4 inputSample, rwlib::DitherNoise& ditherSource, simd::float_4& fpNShape)
+{
+    //stereo 32 bit dither, made small and tidy.
+    // noise * 2^expon of frexp(inputSample) (1 for 0), taken from the exponent bits, and
+    // by 2^62 / 7.737125245533627e+25
+    simd::float_4 noise(ditherSource.next(), ditherSource.next(), ditherSource.next(), ditherSource.next());
+    simd::float_4 exponent = simd::float_4::cast(simd::int32_4::cast(inputSample) & simd::int32_4(0x7f800000)) * 2.f;
+    exponent = simd::ifelse(inputSample == 0.f, 1.f, exponent);
+    simd::float_4 dither = noise * exponent * 5.9604645e-8f;
+    inputSample += dither - fpNShape;
+    fpNShape = dither;
+    return inputSample;
+}
+
+/* #vu metering
+======================================================================================== */
+// Level meter for a stereo pair of polyphonic inputs. Every sample only reduces the voices
+// lane-wise into float_4 block accumulators (peak and sum of squares); the ballistics run
+// once per light update in update(), like dsp::VuMeter2 in peak mode (instant attack,
+// release at lambda) plus an RMS level. Each voice reads (left + right) / 5, so the meter
+// follows the loudest voice. peak and rms are plain floats, a display widget can read them.
+struct BlockVuMeter {
+    simd::float_4 blockPeak;
+    simd::float_4 blockSquares;
+    int blockVoices; // voices accumulated since the last update, for the RMS mean
+    float peak; // amplitude, after ballistics
+    float rms; // amplitude, after ballistics
+    float lambda = 30.f; // release rate in 1/s
+
+    BlockVuMeter()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        blockPeak = blockSquares = 0.f;
+        blockVoices = 0;
+        peak = rms = 0.f;
+    }
+
+    // one sample
+    void accumulate(Input& left, Input& right)
+    {
+        int channelsL = left.getChannels();
+        int channelsR = right.getChannels();
+        int channels = std::max(channelsL, channelsR);
+        for (int c = 0; c < channels; c += 4) {
+            simd::float_4 voice = simd::float_4(c, c + 1, c + 2, c + 3);
+            simd::float_4 l = simd::ifelse(voice < channelsL, left.getVoltageSimd<simd::float_4>(c), 0.f);
+            simd::float_4 r = simd::ifelse(voice < channelsR, right.getVoltageSimd<simd::float_4>(c), 0.f);
+            simd::float_4 value = (l + r) * 0.2f;
+            blockPeak = simd::fmax(blockPeak, simd::fabs(value));
+            blockSquares += value * value;
+        }
+        blockVoices += channels;
+    }
+
+    // folds the block into peak and rms, deltaTime is the length of the block in seconds
+    void update(float deltaTime)
+    {
+        float decay = std::exp(-lambda * deltaTime);
+        float blockPeakMax = std::max(std::max(blockPeak[0], blockPeak[1]), std::max(blockPeak[2], blockPeak[3]));
+        peak = (blockPeakMax >= peak) ? blockPeakMax : blockPeakMax + (peak - blockPeakMax) * decay;
+
+        float blockPower = (blockVoices > 0) ? (blockSquares[0] + blockSquares[1] + blockSquares[2] + blockSquares[3]) / blockVoices : 0.f;
+        float power = blockPower + (rms * rms - blockPower) * decay;
+        rms = std::sqrt(power);
+
+        blockPeak = blockSquares = 0.f;
+        blockVoices = 0;
+    }
+
+    // peak level between dbMin (0) and dbMax (1), as dsp::VuMeter2::getBrightness()
+    float getBrightness(float dbMin, float dbMax)
+    {
+        float db = 20.f * std::log10(std::max(peak, 1e-10f));
+        return math::clamp(math::rescale(db, dbMin, dbMax, 0.f, 1.f), 0.f, 1.f);
+    }
+};
+
+/* #dsp stats
+======================================================================================== */
+// Optional hot-path instrumentation, switched on per instance from the "DSP stats" submenu of
+// the context menu. While it's off, a sample costs one branch. Time is read from the CPU's
+// timestamp counter (which ticks at the nominal clock rate, so "cycles" are approximate under
+// turbo or power saving) and summarised once per second of audio. The submenu shows the last
+// summary and can write the summaries of all instances to Rackwindows-stats.json.
+inline uint64_t readTimestamp()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+struct DspStats {
+    // the last full second of audio, read by the menu and the JSON dump
+    struct Summary {
+        float cyclesPerSample = 0.f; // mean of the samples that ran the dsp
+        float peakCycles = 0.f; // slowest single sample
+        int voices = 0; // most channels seen on any input
+        float ditherShare = 0.f; // share of the cycles spent in high quality dither
+        float denormalGuards = 0.f; // denormal guard triggers per second
+        float silentShare = 0.f; // share of the samples skipped as silent
+        int oversampling = 1;
+        bool isValid = false;
+    };
+
+    bool enabled = false;
+    Summary summary;
+
+    // set or counted by the modules
+    int oversampling = 1;
+    uint32_t denormalGuards = 0;
+    uint64_t ditherCycles = 0;
+
+    // running window, engine thread only
+    uint64_t cycles = 0;
+    uint64_t peakCycles = 0;
+    uint32_t samples = 0;
+    uint32_t silentSamples = 0;
+    int voices = 0;
+    bool isSleeping = false;
+    Module* module = NULL;
+
+    // every instance is listed for the JSON dump
+    DspStats();
+    ~DspStats();
+    DspStats(const DspStats&) = delete;
+    DspStats& operator=(const DspStats&) = delete;
+
+    // times one call to process(), put first in process()
+    struct Block {
+        DspStats& stats;
+        Module* module;
+        float sampleRate;
+        bool isTiming; // read once, the menu may switch collecting on or off meanwhile
+        uint64_t start;
+
+        Block(DspStats& stats, Module* module, const Module::ProcessArgs& args) : stats(stats), module(module), sampleRate(args.sampleRate), isTiming(stats.enabled), start(isTiming ? readTimestamp() : 0) {}
+
+        ~Block()
+        {
+            if (isTiming) {
+                stats.add(module, readTimestamp() - start, sampleRate);
+            }
+        }
+    };
+
+    // times a part of the block (the dither) into a counter
+    struct Section {
+        uint64_t& counter;
+        bool isTiming;
+        uint64_t start;
+
+        Section(DspStats& stats, uint64_t& counter) : counter(counter), isTiming(stats.enabled), start(isTiming ? readTimestamp() : 0) {}
+
+        ~Section()
+        {
+            if (isTiming) {
+                counter += readTimestamp() - start;
+            }
+        }
+    };
+
+    // the module skipped its dsp for this sample
+    void sleep()
+    {
+        isSleeping = true;
+    }
+
+    void add(Module* module, uint64_t sampleCycles, float sampleRate)
+    {
+        this->module = module;
+        if (isSleeping) {
+            silentSamples++;
+            isSleeping = false;
+        } else {
+            cycles += sampleCycles;
+            peakCycles = std::max(peakCycles, sampleCycles);
+            for (Input& input : module->inputs) {
+                voices = std::max(voices, input.getChannels());
+            }
+        }
+        if (++samples >= sampleRate) {
+            summarise();
+        }
+    }
+
+    // turns collecting on or off, starting a fresh window
+    void setEnabled(bool enabled);
+    void summarise();
+};
+
+void writeDspStats();
+
+// "DSP stats" submenu
+struct DspStatsItem : MenuItem {
+    DspStats* stats;
+    Menu* createChildMenu() override;
+};
+
 /* #themes
 ======================================================================================== */
 static const std::string lightPanelID = "Light Panel";
@@ -75,7 +425,7 @@ static const std::string darkPanelID = "Dark Panel";
 void saveDarkAsDefault(bool darkAsDefault);
 bool loadDarkAsDefault();
 
-struct DarkDefaultItem : MenuItem {
+struct DarkDefaultItem : SettingsItem {
     void onAction(const event::Action& e) override
     {
         saveDarkAsDefault(rightText.empty()); // implicitly toggled
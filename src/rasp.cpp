@@ -16,6 +16,7 @@ See ./LICENSE.md for all licenses
 ************************************************************************************************/
 
 #include "plugin.hpp"
+#include <new>
 
 // quality options
 #define ECO 0
@@ -26,6 +27,11 @@ See ./LICENSE.md for all licenses
 #define SLEW 1
 #define SLEW3 2
 
+// stage order, by which outputs are connected
+#define SLEW_AND_ACCELERATION 0 // both, side by side
+#define ACCELERATION_THEN_SLEW 1 // clamp only
+#define SLEW_THEN_ACCELERATION 2 // limit only
+
 // polyphony
 #define MAX_POLY_CHANNELS 16
 
@@ -60,16 +66,81 @@ struct Rasp : Module {
     float clampParam;
     float limitParam;
 
-    // state variables
-    rwlib::Slew slew[MAX_POLY_CHANNELS];
-    rwlib::Slew2 slew2[MAX_POLY_CHANNELS];
-    rwlib::Slew3 slew3[MAX_POLY_CHANNELS];
-    rwlib::Acceleration acceleration[MAX_POLY_CHANNELS];
-    long double fpNShapeClamp[MAX_POLY_CHANNELS];
-    long double fpNShapeLimit[MAX_POLY_CHANNELS];
+    // Stages of one group of four voices, composed at compile time: the clamp stage is the
+    // selected slew, the limit stage is Acceleration. Each one knows its setting and output.
+    struct StageSettings {
+        simd::float_4 threshold;
+        simd::float_4 intensity;
+    };
+
+    template <template <typename> class TSlew>
+    struct Voices {
+        TSlew<simd::float_4> slew;
+        rwlib::Acceleration<simd::float_4> acceleration;
+    };
+
+    struct ClampStage {
+        static const int OUTPUT = CLAMP_OUTPUT;
+
+        template <typename TVoices>
+        static inline simd::float_4 process(TVoices& voices, simd::float_4 inputSample, const StageSettings& settings)
+        {
+            return voices.slew.process(inputSample, settings.threshold);
+        }
+    };
+
+    struct LimitStage {
+        static const int OUTPUT = LIMIT_OUTPUT;
+
+        template <typename TVoices>
+        static inline simd::float_4 process(TVoices& voices, simd::float_4 inputSample, const StageSettings& settings)
+        {
+            return voices.acceleration.process(inputSample, settings.intensity);
+        }
+    };
+
+    // the first stage feeds the second
+    template <typename TFirst, typename TSecond>
+    struct Chain {
+        template <typename TVoices>
+        static inline void process(TVoices& voices, simd::float_4 inputSample, const StageSettings& settings, simd::float_4* outputSamples)
+        {
+            outputSamples[TFirst::OUTPUT] = TFirst::process(voices, inputSample, settings);
+            outputSamples[TSecond::OUTPUT] = TSecond::process(voices, outputSamples[TFirst::OUTPUT], settings);
+        }
+    };
+
+    // both stages take the input
+    template <typename TFirst, typename TSecond>
+    struct Parallel {
+        template <typename TVoices>
+        static inline void process(TVoices& voices, simd::float_4 inputSample, const StageSettings& settings, simd::float_4* outputSamples)
+        {
+            outputSamples[TFirst::OUTPUT] = TFirst::process(voices, inputSample, settings);
+            outputSamples[TSecond::OUTPUT] = TSecond::process(voices, inputSample, settings);
+        }
+    };
+
+    // state variables, only for the selected slew type: constructed by the kernel in place
+    // when the slew type changes or on reset, Slew2 needs the most room
+    alignas(16) unsigned char voiceState[MAX_POLY_CHANNELS / 4 * sizeof(Voices<rwlib::Slew2>)];
+    bool isVoiceStateStale;
+    simd::float_4 fpNShapeClamp[MAX_POLY_CHANNELS / 4];
+    simd::float_4 fpNShapeLimit[MAX_POLY_CHANNELS / 4];
 
     // other
     double overallscale;
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
+    rwlib::DitherNoise ditherSource;
+
+    // process kernel, specialised at compile time for the current quality setting, slew type
+    // and stage order
+    typedef void (Rasp::*ProcessKernel)(const ProcessArgs& args);
+    ProcessKernel kernel;
+    int kernelQuality;
+    int kernelSlewType;
+    int kernelOrder;
 
     Rasp()
     {
@@ -79,6 +150,7 @@ struct Rasp : Module {
 
         quality = ECO;
         slewType = SLEW2;
+        kernelQuality = kernelSlewType = kernelOrder = -1;
         onReset();
     }
 
@@ -89,15 +161,10 @@ struct Rasp : Module {
         clampParam = 0.f;
         limitParam = 0.f;
 
-        for (int i = 0; i < MAX_POLY_CHANNELS; i++) {
-            {
-                slew[i] = rwlib::Slew();
-                slew2[i] = rwlib::Slew2();
-                slew3[i] = rwlib::Slew3();
-                acceleration[i] = rwlib::Acceleration();
-                fpNShapeClamp[i] = 0.0;
-                fpNShapeLimit[i] = 0.0;
-            }
+        isVoiceStateStale = true;
+        for (int i = 0; i < MAX_POLY_CHANNELS / 4; i++) {
+            fpNShapeClamp[i] = 0.f;
+            fpNShapeLimit[i] = 0.f;
         }
     }
 
@@ -108,6 +175,9 @@ struct Rasp : Module {
         overallscale = 1.0;
         overallscale /= 44100.0;
         overallscale *= sampleRate;
+
+        // tail: none beyond the hold, the slew stages settle within a few samples
+        silenceDetector.setTail(0.0, sampleRate);
     }
 
     json_t* dataToJson() override
@@ -136,8 +206,84 @@ struct Rasp : Module {
             slewType = json_integer_value(slewTypeJ);
     }
 
+    // one kernel per quality, slew type and stage order
+    template <int QUALITY, template <typename> class TSlew>
+    static ProcessKernel getKernel(int order)
+    {
+        switch (order) {
+        case ACCELERATION_THEN_SLEW:
+            return &Rasp::processKernel<QUALITY, TSlew, Chain<LimitStage, ClampStage>>;
+        case SLEW_THEN_ACCELERATION:
+            return &Rasp::processKernel<QUALITY, TSlew, Chain<ClampStage, LimitStage>>;
+        default:
+            return &Rasp::processKernel<QUALITY, TSlew, Parallel<ClampStage, LimitStage>>;
+        }
+    }
+
+    template <int QUALITY>
+    static ProcessKernel getKernel(int slewType, int order)
+    {
+        switch (slewType) {
+        case SLEW:
+            return getKernel<QUALITY, rwlib::Slew>(order);
+        case SLEW3:
+            return getKernel<QUALITY, rwlib::Slew3>(order);
+        default:
+            return getKernel<QUALITY, rwlib::Slew2>(order);
+        }
+    }
+
+    void selectKernel(int order)
+    {
+        kernel = quality ? getKernel<HIGH>(slewType, order) : getKernel<ECO>(slewType, order);
+
+        // the new slew type starts from a fresh state
+        if (slewType != kernelSlewType) {
+            isVoiceStateStale = true;
+        }
+        kernelQuality = quality;
+        kernelSlewType = slewType;
+        kernelOrder = order;
+    }
+
     void process(const ProcessArgs& args) override
     {
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
+
+        // skip the dsp once the inputs have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs[IN_INPUT]))) {
+            dspStats.sleep();
+            clearOutputs(outputs);
+            return;
+        }
+
+        // with one output connected, the stage of the other one feeds it
+        bool isClampConnected = outputs[CLAMP_OUTPUT].isConnected();
+        bool isLimitConnected = outputs[LIMIT_OUTPUT].isConnected();
+        if (!isClampConnected && !isLimitConnected) {
+            return;
+        }
+        int order = !isLimitConnected ? ACCELERATION_THEN_SLEW : !isClampConnected ? SLEW_THEN_ACCELERATION : SLEW_AND_ACCELERATION;
+
+        if (quality != kernelQuality || slewType != kernelSlewType || order != kernelOrder) {
+            selectKernel(order);
+        }
+
+        (this->*kernel)(args);
+    }
+
+    template <int QUALITY, template <typename> class TSlew, typename TStages>
+    void processKernel(const ProcessArgs& args)
+    {
+        static_assert(sizeof(Voices<TSlew>) <= sizeof(Voices<rwlib::Slew2>), "voiceState is too small");
+        Voices<TSlew>* voices = reinterpret_cast<Voices<TSlew>*>(voiceState);
+        if (isVoiceStateStale) {
+            for (int i = 0; i < MAX_POLY_CHANNELS / 4; i++) {
+                new (&voices[i]) Voices<TSlew>();
+            }
+            isVoiceStateStale = false;
+        }
+
         // get params
         limitParam = params[LIMIT_PARAM].getValue();
         limitParam += inputs[LIMIT_CV_INPUT].getVoltage() / 5;
@@ -147,91 +293,44 @@ struct Rasp : Module {
         clampParam += inputs[CLAMP_CV_INPUT].getVoltage() / 5;
         clampParam = clamp(clampParam, 0.f, 1.f);
 
-        long double inputSample;
-        long double clampSample = 0.0;
-        long double limitSample = 0.0;
+        StageSettings settings;
+        settings.threshold = TSlew<simd::float_4>::getThreshold(clampParam, overallscale);
+        settings.intensity = rwlib::Acceleration<simd::float_4>::getIntensity(limitParam, overallscale);
 
-        // for each poly channel
-        for (int i = 0, numChannels = std::max(1, inputs[IN_INPUT].getChannels()); i < numChannels; ++i) {
+        // all voices in at once, processed in place for the clamp output
+        PolyBuffer clampVoices;
+        clampVoices.read(inputs[IN_INPUT]);
+        PolyBuffer limitVoices;
+        limitVoices.channels = clampVoices.channels;
 
-            // get input
-            inputSample = inputs[IN_INPUT].getPolyVoltage(i);
+        // four voices at a time
+        for (int c = 0, numChannels = clampVoices.channels; c < numChannels; c += 4) {
+            int g = c / 4;
 
-            // pad gain
-            inputSample *= gainCut;
+            // get input, pad gain
+            simd::float_4 inputSample = clampVoices.getSimd(c) * (float)gainCut;
 
-            if (quality == HIGH) {
-                inputSample = rwlib::denormalize(inputSample);
+            if (QUALITY == HIGH) {
+                inputSample = denormalize(inputSample, std::min(4, numChannels - c));
             }
 
             // work the magic
-            if (outputs[CLAMP_OUTPUT].isConnected()) {
-                if (outputs[LIMIT_OUTPUT].isConnected()) {
-                    switch (slewType) {
-                    case SLEW:
-                        clampSample = slew[i].process(inputSample, clampParam, overallscale);
-                        break;
-                    case SLEW2:
-                        clampSample = slew2[i].process(inputSample, clampParam, overallscale);
-                        break;
-                    case SLEW3:
-                        clampSample = slew3[i].process(inputSample, clampParam, overallscale);
-                    }
-                } else {
-                    limitSample = acceleration[i].process(inputSample, limitParam, 1.f, overallscale);
-                    switch (slewType) {
-                    case SLEW:
-                        clampSample = slew[i].process(limitSample, clampParam, overallscale);
-                        break;
-                    case SLEW2:
-                        clampSample = slew2[i].process(limitSample, clampParam, overallscale);
-                        break;
-                    case SLEW3:
-                        clampSample = slew3[i].process(limitSample, clampParam, overallscale);
-                    }
-                }
-            }
-            if (outputs[LIMIT_OUTPUT].isConnected()) {
-                if (outputs[CLAMP_OUTPUT].isConnected()) {
-                    limitSample = acceleration[i].process(inputSample, limitParam, 1.f, overallscale);
-                } else {
-                    switch (slewType) {
-                    case SLEW:
-                        clampSample = slew[i].process(inputSample, clampParam, overallscale);
-                        break;
-                    case SLEW2:
-                        clampSample = slew2[i].process(inputSample, clampParam, overallscale);
-                        break;
-                    case SLEW3:
-                        clampSample = slew3[i].process(inputSample, clampParam, overallscale);
-                    }
-                    limitSample = acceleration[i].process(clampSample, limitParam, 1.f, overallscale);
-                }
-            }
+            simd::float_4 outputSamples[NUM_OUTPUTS];
+            TStages::process(voices[g], inputSample, settings, outputSamples);
 
-            if (quality == HIGH) {
-                // 32 bit dither, made small and tidy.
-                int expon;
-                frexpf((float)clampSample, &expon);
-                long double dither = (rand() / (RAND_MAX * 7.737125245533627e+25)) * pow(2, expon + 62);
-                clampSample += (dither - fpNShapeClamp[i]);
-                fpNShapeClamp[i] = dither;
-                frexpf((float)limitSample, &expon);
-                dither = (rand() / (RAND_MAX * 7.737125245533627e+25)) * pow(2, expon + 62);
-                limitSample += (dither - fpNShapeLimit[i]);
-                fpNShapeLimit[i] = dither;
+            if (QUALITY == HIGH) {
+                DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
+                outputSamples[CLAMP_OUTPUT] = ditherNoiseShaped(outputSamples[CLAMP_OUTPUT], ditherSource, fpNShapeClamp[g]);
+                outputSamples[LIMIT_OUTPUT] = ditherNoiseShaped(outputSamples[LIMIT_OUTPUT], ditherSource, fpNShapeLimit[g]);
             }
 
-            // bring levels back up
-            clampSample *= gainBoost;
-            limitSample *= gainBoost;
-
-            // output
-            outputs[CLAMP_OUTPUT].setChannels(numChannels);
-            outputs[CLAMP_OUTPUT].setVoltage(clampSample, i);
-            outputs[LIMIT_OUTPUT].setChannels(numChannels);
-            outputs[LIMIT_OUTPUT].setVoltage(limitSample, i);
+            // bring levels back up, output
+            clampVoices.setSimd(outputSamples[CLAMP_OUTPUT] * (float)gainBoost, c);
+            limitVoices.setSimd(outputSamples[LIMIT_OUTPUT] * (float)gainBoost, c);
         }
+
+        clampVoices.write(outputs[CLAMP_OUTPUT]);
+        limitVoices.write(outputs[LIMIT_OUTPUT]);
     }
 };
 
@@ -315,12 +414,18 @@ struct RaspWidget : ModuleWidget {
         slew3->module = module;
         slew3->slewType = SLEW3;
         menu->addChild(slew3);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
     }
 
     RaspWidget(Rasp* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/rasp_dark.svg")));
+        setPanel(loadArtwork("rasp_dark.svg"));
 
         // screws
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH * 1.5, 0)));
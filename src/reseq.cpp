@@ -63,6 +63,8 @@ struct Reseq : Module {
 
     // other variables, which do not need to be updated every cycle
     double overallscale;
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
     double v1;
     double v2;
     double v3;
@@ -74,6 +76,11 @@ struct Reseq : Module {
     double wet;
     double falloff;
 
+    // process kernel, specialised at compile time for the current quality setting
+    typedef void (Reseq::*ProcessKernel)(const ProcessArgs& args);
+    ProcessKernel kernel;
+    int kernelQuality;
+
     Reseq()
     {
         config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -83,6 +90,7 @@ struct Reseq : Module {
         configParam(DRYWET_PARAM, 0.f, 1.f, 1.f, "Dry/Wet");
 
         quality = loadQuality();
+        kernelQuality = -1;
         onReset();
     }
 
@@ -110,6 +118,9 @@ struct Reseq : Module {
         overallscale = 1.0;
         overallscale /= 44100.0;
         overallscale *= sampleRate;
+
+        // tail: bounded by the length of the resonance buffers
+        silenceDetector.setTail(61.0, sampleRate);
     }
 
     json_t* dataToJson() override
@@ -195,16 +206,21 @@ struct Reseq : Module {
         }
     }
 
+    template <int QUALITY>
     void processChannel(Input& input, Output& output)
     {
         // number of polyphonic channels
         int numChannels = std::max(1, inputs[IN_INPUT].getChannels());
 
+        // all voices in at once, processed in place
+        PolyBuffer voices;
+        voices.read(input);
+
         // for each poly channel
         for (int i = 0; i < numChannels; ++i) {
 
             // input
-            long double inputSample = input.getPolyVoltage(i);
+            long double inputSample = voices[i];
 
             // pad gain
             inputSample /= gainFactor;
@@ -243,9 +259,11 @@ struct Reseq : Module {
             }
             //done updating the kernel for this go-round
 
-            if (quality == HIGH) {
-                if (fabs(inputSample) < 1.18e-43)
+            if (QUALITY == HIGH) {
+                if (fabs(inputSample) < 1.18e-43) {
                     inputSample = fpd[i] * 1.18e-43;
+                    dspStats.denormalGuards++;
+                }
             }
 
             long double drySample = inputSample;
@@ -381,7 +399,8 @@ struct Reseq : Module {
                 inputSample = (inputSample * wet) + (drySample * (1.0 - wet));
             }
 
-            if (quality == HIGH) {
+            if (QUALITY == HIGH) {
+                DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
                 //begin 64 bit stereo floating point dither
                 int expon;
                 frexp((double)inputSample, &expon);
@@ -396,18 +415,44 @@ struct Reseq : Module {
             inputSample *= gainFactor;
 
             // output
-            outputs[OUT_OUTPUT].setChannels(numChannels);
-            outputs[OUT_OUTPUT].setVoltage(inputSample, i);
+            voices[i] = inputSample;
 
         } // end poly channel loop
+
+        voices.write(outputs[OUT_OUTPUT]);
+    }
+
+    void selectKernel()
+    {
+        kernel = (quality == HIGH) ? &Reseq::processKernel<HIGH> : &Reseq::processKernel<ECO>;
+        kernelQuality = quality;
     }
 
     void process(const ProcessArgs& args) override
+    {
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
+
+        // skip the dsp once the inputs have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs[IN_INPUT]))) {
+            dspStats.sleep();
+            clearOutputs(outputs);
+            return;
+        }
+
+        if (quality != kernelQuality) {
+            selectKernel();
+        }
+
+        (this->*kernel)(args);
+    }
+
+    template <int QUALITY>
+    void processKernel(const ProcessArgs& args)
     {
         if (outputs[OUT_OUTPUT].isConnected()) {
 
             updateParams();
-            processChannel(inputs[IN_INPUT], outputs[OUT_OUTPUT]);
+            processChannel<QUALITY>(inputs[IN_INPUT], outputs[OUT_OUTPUT]);
         }
     }
 };
@@ -452,12 +497,18 @@ struct ReseqWidget : ModuleWidget {
         high->module = module;
         high->quality = 1;
         menu->addChild(high);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
     }
 
     ReseqWidget(Reseq* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/reseq_dark.svg")));
+        setPanel(loadArtwork("reseq_dark.svg"));
 
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH, 0)));
         addChild(createWidget<ScrewBlack>(Vec(box.size.x - 2 * RACK_GRID_WIDTH, 0)));
@@ -2,6 +2,10 @@
 #define RWLIB_H
 
 #include "math.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "simd_kernels.hpp"
 
 namespace rwlib {
 
@@ -42,76 +46,75 @@ inline long double denormalize(long double inputSample)
     return inputSample;
 }
 
+// cond ? a : b, the scalar counterpart of simd::ifelse() for the engines that are templated
+// on the sample type (SIMD types find theirs through argument-dependent lookup)
+inline double ifelse(bool cond, double a, double b)
+{
+    return cond ? a : b;
+}
+
 /* #acceleration
 ======================================================================================== */
+// Templated on the sample type, so one instance runs a voice on double or four voices on a
+// SIMD vector (e.g. float_4). Always fully wet.
+template <typename T>
 struct Acceleration {
 
-    double ataLastOut;
-    double s1;
-    double s2;
-    double s3;
-    double o1;
-    double o2;
-    double o3;
-    double m1;
-    double m2;
-    double des;
+    T ataLastOut;
+    T s1;
+    T s2;
+    T s3;
+    T o1;
+    T o2;
+    T o3;
 
     Acceleration()
     {
-        ataLastOut = 0.0;
-        s1 = s2 = s3 = 0.0;
-        o1 = o2 = o3 = 0.0;
-        m1 = m2 = des = 0.0;
+        reset();
     }
 
-    long double process(long double inputSample, float limitParam = 0.f, float drywetParam = 1.f, double overallscale = 1.0)
+    void reset()
     {
-        double intensity = pow(limitParam, 3) * (32 / overallscale);
-        double wet = drywetParam;
-        double dry = 1.0 - wet;
-
-        double sense;
-        double smooth;
-        double accumulatorSample;
+        ataLastOut = T(0.0);
+        s1 = s2 = s3 = T(0.0);
+        o1 = o2 = o3 = T(0.0);
+    }
 
-        double drySample = inputSample;
+    // once per sample for all voices
+    static double getIntensity(float limitParam, double overallscale)
+    {
+        return pow(limitParam, 3) * (32 / overallscale);
+    }
 
+    inline T process(T inputSample, T intensity)
+    {
         s3 = s2;
         s2 = s1;
         s1 = inputSample;
-        smooth = (s3 + s2 + s1) / 3.0;
-        m1 = (s1 - s2) * ((s1 - s2) / 1.3);
-        m2 = (s2 - s3) * ((s1 - s2) / 1.3);
-        sense = fabs(m1 - m2);
+        T smooth = (s3 + s2 + s1) / T(3.0);
+        T m1 = (s1 - s2) * ((s1 - s2) / T(1.3));
+        T m2 = (s2 - s3) * ((s1 - s2) / T(1.3));
+        T sense = fabs(m1 - m2);
         sense = (intensity * intensity * sense);
         o3 = o2;
         o2 = o1;
         o1 = sense;
-        if (o2 > sense)
-            sense = o2;
-        if (o3 > sense)
-            sense = o3;
+        sense = fmax(sense, o2);
+        sense = fmax(sense, o3);
         //sense on the most intense
 
-        if (sense > 1.0)
-            sense = 1.0;
+        sense = fmin(sense, T(1.0));
 
-        inputSample *= (1.0 - sense);
+        inputSample *= (T(1.0) - sense);
 
         inputSample += (smooth * sense);
 
-        sense /= 2.0;
+        sense *= T(0.5);
 
-        accumulatorSample = (ataLastOut * sense) + (inputSample * (1.0 - sense));
+        T accumulatorSample = (ataLastOut * sense) + (inputSample * (T(1.0) - sense));
         ataLastOut = inputSample;
-        inputSample = accumulatorSample;
-
-        if (wet != 1.0) {
-            inputSample = (inputSample * wet) + (drySample * dry);
-        }
 
-        return inputSample;
+        return accumulatorSample;
     }
 }; /* end Acceleration */
 
@@ -124,6 +127,11 @@ struct BiquadBandpass {
     double norm;
 
     BiquadBandpass()
+    {
+        reset();
+    }
+
+    void reset()
     {
         for (int i = 0; i < 11; i++) {
             biquad[i] = 0.0;
@@ -199,6 +207,11 @@ struct Cans {
     int mode;
 
     Cans()
+    {
+        reset();
+    }
+
+    void reset()
     {
         iirSampleAL = 0.0;
         iirSampleAR = 0.0;
@@ -369,6 +382,95 @@ struct Cans {
     }
 }; /* end Cans */
 
+/* #capacitor
+======================================================================================== */
+// Capacitor's filters for NUM_GROUPS groups of voices. Templated on the sample type, so a
+// group is one voice on double or four voices on a SIMD vector (e.g. float_4). The state is
+// laid out per pole across all groups, so every step of the filter is one operation on a
+// whole group. The gearbox (which of the poles run this sample) is shared by all groups.
+
+template <typename T, int NUM_GROUPS>
+struct Capacitor {
+
+    // poles A to F, three of them run per sample
+    T iirHighpass[6][NUM_GROUPS];
+    T iirLowpass[6][NUM_GROUPS];
+    T lowpassAmount[NUM_GROUPS];
+    T highpassAmount[NUM_GROUPS];
+    T wet[NUM_GROUPS];
+    T lastLowpass[NUM_GROUPS];
+    T lastHighpass[NUM_GROUPS];
+    T lastWet[NUM_GROUPS];
+    int count;
+
+    Capacitor()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        for (int g = 0; g < NUM_GROUPS; g++) {
+            for (int i = 0; i < 6; i++) {
+                iirHighpass[i][g] = iirLowpass[i][g] = T(0.0);
+            }
+            lowpassAmount[g] = T(1.0);
+            highpassAmount[g] = T(0.0);
+            wet[g] = T(1.0);
+            lastLowpass[g] = lastHighpass[g] = lastWet[g] = T(1000.0);
+        }
+        count = 0;
+    }
+
+    // once per sample, before process()
+    inline void step()
+    {
+        count++;
+        if (count > 5)
+            count = 0;
+    }
+
+    // chase values move the amounts at a speed that slows down for big jumps
+    static inline T chase(T amount, T chaseValue, T& last)
+    {
+        //should not scale with sample rate, because values reaching 1 are important
+        //to its ability to bypass when set to max
+        T speed = T(300.0) / (fabs(last - chaseValue) + T(1.0));
+        last = chaseValue;
+        return ((amount * speed) + chaseValue) / (speed + T(1.0));
+    }
+
+    // lowpassChase and highpassChase are the squared cutoff settings
+    inline T process(T inputSample, T lowpassChase, T highpassChase, int g)
+    {
+        lowpassAmount[g] = chase(lowpassAmount[g], lowpassChase, lastLowpass[g]);
+        T invLowpass = T(1.0) - lowpassAmount[g];
+        highpassAmount[g] = chase(highpassAmount[g], highpassChase, lastHighpass[g]);
+        T invHighpass = T(1.0) - highpassAmount[g];
+
+        //Highpass Filter chunk. This is three poles of IIR highpass, with a 'gearbox' that progressively
+        //steepens the filter after minimizing artifacts.
+        // A every sample, then B/C alternating and D/E/F in turn (ABD ACE ABF ACD ABE ACF)
+        int poles[3] = { 0, 1 + (count & 1), 3 + count % 3 };
+        for (int i = 0; i < 3; i++) {
+            T& iirHighpassPole = iirHighpass[poles[i]][g];
+            T& iirLowpassPole = iirLowpass[poles[i]][g];
+            iirHighpassPole = (iirHighpassPole * invHighpass) + (inputSample * highpassAmount[g]);
+            inputSample -= iirHighpassPole;
+            iirLowpassPole = (iirLowpassPole * invLowpass) + (inputSample * lowpassAmount[g]);
+            inputSample = iirLowpassPole;
+        }
+        return inputSample;
+    }
+
+    // dry/wet with the same chase as the filters
+    inline T mix(T drySample, T wetSample, T wetChase, int g)
+    {
+        wet[g] = chase(wet[g], wetChase, lastWet[g]);
+        return (drySample * (T(1.0) - wet[g])) + (wetSample * wet[g]);
+    }
+}; /* end Capacitor */
+
 /* #dark
 ======================================================================================== */
 struct Dark {
@@ -376,6 +478,11 @@ struct Dark {
     float lastSample[100];
 
     Dark()
+    {
+        reset();
+    }
+
+    void reset()
     {
         for (int count = 0; count < 99; count++) {
             lastSample[count] = 0;
@@ -439,6 +546,101 @@ struct Dark {
     }
 }; /* end Dark */
 
+/* #delaybuffer
+======================================================================================== */
+// Delay memory that clears in O(1). Every sample is stamped with the generation it was
+// written in and clear() just starts a new generation, so anything older reads as zero.
+// sweep() then zeroes the stale samples a few at a time on the audio thread, walking a
+// high-water mark up the buffer; once it is through, every stamp matches again. Should the
+// 8 bit generation come round to stamps that are still unswept, the buffer is cleared in full.
+
+template <typename T, int SIZE>
+struct DelayBuffer {
+
+    T data[SIZE];
+    uint8_t stamps[SIZE];
+    uint8_t generation;
+    int generationsSinceSweep;
+    int swept;
+
+    // the data needs no zeroing here, nothing reads it before it has been written or swept
+    DelayBuffer()
+    {
+        std::memset(stamps, 0, sizeof(stamps));
+        generation = 0;
+        generationsSinceSweep = 0;
+        clear();
+    }
+
+    void clear()
+    {
+        if (++generationsSinceSweep == 255) {
+            for (int i = 0; i < SIZE; i++) {
+                data[i] = 0;
+            }
+            std::memset(stamps, 0, sizeof(stamps));
+            generation = 0;
+            generationsSinceSweep = 0;
+        }
+        generation++;
+        swept = 0;
+    }
+
+    // zero the next samples that have not been written since the last clear()
+    inline void sweep(int numSamples = 64)
+    {
+        if (swept == SIZE) {
+            return;
+        }
+        int end = swept + numSamples < SIZE ? swept + numSamples : SIZE;
+        for (int i = swept; i < end; i++) {
+            if (stamps[i] != generation) {
+                data[i] = 0;
+                stamps[i] = generation;
+            }
+        }
+        swept = end;
+        if (swept == SIZE) {
+            generationsSinceSweep = 0;
+        }
+    }
+
+    inline T read(int i) const
+    {
+        return stamps[i] == generation ? data[i] : T(0);
+    }
+
+    inline void write(int i, T value)
+    {
+        data[i] = value;
+        stamps[i] = generation;
+    }
+}; /* end DelayBuffer */
+
+/* #dithernoise
+======================================================================================== */
+// Noise source for the dither, used on the audio thread in place of rand(), which takes a
+// lock in most C libraries and shares one state between all instances. Each instance is
+// seeded differently (on the thread that constructs it), so the dither of several instances
+// stays uncorrelated.
+struct DitherNoise {
+    uint32_t state;
+
+    DitherNoise()
+    {
+        state = (uint32_t)rand() | 1;
+    }
+
+    // 0 to 1, like rand() / RAND_MAX
+    inline double next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state * (1.0 / 4294967295.0);
+    }
+}; /* end DitherNoise */
+
 /* #electrohat
 ======================================================================================== */
 struct ElectroHat {
@@ -656,6 +858,11 @@ struct GolemBCN {
     int count;
 
     GolemBCN()
+    {
+        reset();
+    }
+
+    void reset()
     {
         for (int i = 0; i < 4098; i++) {
             p[i] = 0.0;
@@ -720,6 +927,187 @@ struct GolemBCN {
     }
 }; /* end GolemBCN */
 
+/* #oversampler
+======================================================================================== */
+// 2x/4x/8x oversampling via cascaded polyphase IIR half-band filters (two parallel chains
+// of first-order allpasses, see Laurent de Soras' HIIR). Templated on the sample type, so
+// the same filters run on double for a single voice or on a SIMD vector (e.g. float_4)
+// for four voices at once. Coefficients are designed for stopband rejection > 110 dB; the
+// first stage is the steep one, the later stages only have to reject the images of an
+// already band-limited signal and get away with a lot fewer allpasses.
+
+// 1x <-> 2x, transition band 0.04
+static const double halfBandCoefs2x[10] = {
+    0.026872581726589895, 0.10211979750762737, 0.21186457986634402, 0.33896530820005222, 0.46822765324642385,
+    0.58941249499690829, 0.69777813051993742, 0.79313125288556097, 0.87850905287240721, 0.95921252955741709
+};
+// 2x <-> 4x, transition band 0.255
+static const double halfBandCoefs4x[4] = {
+    0.041893991997656171, 0.16890348243995201, 0.39056077292116592, 0.74389574826847815
+};
+// 4x <-> 8x, transition band 0.33
+static const double halfBandCoefs8x[3] = {
+    0.059479826505829031, 0.25419140620518577, 0.65712286471201731
+};
+
+template <typename T, int NUM_COEFS>
+struct HalfBand {
+
+    const double* coefs;
+    T x[NUM_COEFS];
+    T y[NUM_COEFS];
+
+    HalfBand(const double* coefs = halfBandCoefs2x)
+        : coefs(coefs)
+    {
+        reset();
+    }
+
+    // the state of a constant signal at value, silence by default
+    void reset(T value = T(0.0))
+    {
+        for (int i = 0; i < NUM_COEFS; i++) {
+            x[i] = y[i] = value;
+        }
+    }
+
+    // even coefficients feed the first path, odd ones the second
+    inline void allpass(T& sample0, T& sample1)
+    {
+        for (int i = 0; i < NUM_COEFS; i += 2) {
+            T temp0 = (sample0 - y[i]) * T(coefs[i]) + x[i];
+            x[i] = sample0;
+            y[i] = temp0;
+            sample0 = temp0;
+
+            if (i + 1 < NUM_COEFS) {
+                T temp1 = (sample1 - y[i + 1]) * T(coefs[i + 1]) + x[i + 1];
+                x[i + 1] = sample1;
+                y[i + 1] = temp1;
+                sample1 = temp1;
+            }
+        }
+    }
+
+    // one sample in, two samples out
+    inline void upsample(T inputSample, T* outputSamples)
+    {
+        T sample0 = inputSample;
+        T sample1 = inputSample;
+        allpass(sample0, sample1);
+        outputSamples[0] = sample0;
+        outputSamples[1] = sample1;
+    }
+
+    // two samples in, one sample out
+    inline T downsample(const T* inputSamples)
+    {
+        T sample0 = inputSamples[1];
+        T sample1 = inputSamples[0];
+        allpass(sample0, sample1);
+        return (sample0 + sample1) * T(0.5);
+    }
+};
+
+// factor 1, 2, 4 or 8, rounded down; anything below 2 (including 0 and negative values from
+// a damaged patch) is 1
+inline int validOversampling(int oversamplingFactor)
+{
+    return (oversamplingFactor >= 8) ? 8 : (oversamplingFactor >= 4) ? 4 : (oversamplingFactor >= 2) ? 2 : 1;
+}
+
+template <typename T>
+struct Oversampler {
+
+    static const int maxFactor = 8;
+
+    HalfBand<T, 10> upStage2x, downStage2x;
+    HalfBand<T, 4> upStage4x, downStage4x;
+    HalfBand<T, 3> upStage8x, downStage8x;
+    int factor;
+
+    Oversampler()
+        : upStage2x(halfBandCoefs2x), downStage2x(halfBandCoefs2x), upStage4x(halfBandCoefs4x), downStage4x(halfBandCoefs4x), upStage8x(halfBandCoefs8x), downStage8x(halfBandCoefs8x)
+    {
+        factor = 1;
+    }
+
+    // factor 1, 2, 4 or 8
+    void setFactor(int oversamplingFactor)
+    {
+        if (oversamplingFactor != factor) {
+            factor = validOversampling(oversamplingFactor);
+            reset();
+        }
+    }
+
+    void reset()
+    {
+        upStage2x.reset();
+        downStage2x.reset();
+        upStage4x.reset();
+        downStage4x.reset();
+        upStage8x.reset();
+        downStage8x.reset();
+    }
+
+    // writes `factor` samples to outputSamples
+    inline void upsample(T inputSample, T* outputSamples)
+    {
+        switch (factor) {
+        case 1:
+            outputSamples[0] = inputSample;
+            break;
+        case 2:
+            upStage2x.upsample(inputSample, outputSamples);
+            break;
+        case 4: {
+            T buffer[2];
+            upStage2x.upsample(inputSample, buffer);
+            upStage4x.upsample(buffer[0], outputSamples);
+            upStage4x.upsample(buffer[1], outputSamples + 2);
+        } break;
+        case 8: {
+            T buffer2x[2];
+            T buffer4x[4];
+            upStage2x.upsample(inputSample, buffer2x);
+            upStage4x.upsample(buffer2x[0], buffer4x);
+            upStage4x.upsample(buffer2x[1], buffer4x + 2);
+            for (int i = 0; i < 4; i++) {
+                upStage8x.upsample(buffer4x[i], outputSamples + 2 * i);
+            }
+        } break;
+        }
+    }
+
+    // reads `factor` samples from inputSamples
+    inline T downsample(const T* inputSamples)
+    {
+        switch (factor) {
+        case 2:
+            return downStage2x.downsample(inputSamples);
+        case 4: {
+            T buffer[2];
+            buffer[0] = downStage4x.downsample(inputSamples);
+            buffer[1] = downStage4x.downsample(inputSamples + 2);
+            return downStage2x.downsample(buffer);
+        }
+        case 8: {
+            T buffer2x[2];
+            T buffer4x[4];
+            for (int i = 0; i < 4; i++) {
+                buffer4x[i] = downStage8x.downsample(inputSamples + 2 * i);
+            }
+            buffer2x[0] = downStage4x.downsample(buffer4x);
+            buffer2x[1] = downStage4x.downsample(buffer4x + 2);
+            return downStage2x.downsample(buffer2x);
+        }
+        default:
+            return inputSamples[0];
+        }
+    }
+}; /* end Oversampler */
+
 /* #peaksonly
 ======================================================================================== */
 struct PeaksOnly {
@@ -732,6 +1120,11 @@ struct PeaksOnly {
     int ax, bx, cx, dx;
 
     PeaksOnly()
+    {
+        reset();
+    }
+
+    void reset()
     {
         for (int count = 0; count < 1502; count++) {
             a[count] = 0.0;
@@ -856,29 +1249,192 @@ struct PeaksOnly {
     }
 }; /* end PeaksOnly */
 
+/* #polyoversampler
+======================================================================================== */
+// Same filters as Oversampler, but for up to 16 voices held in plain float arrays and
+// running on the SIMD kernels picked for the host CPU, so all voices of a port go through
+// each allpass stage at once (one AVX-512 vector, two AVX2 vectors). Meant for modules whose
+// cores work voice by voice anyway.
+
+struct PolyOversampler {
+
+    static const int maxFactor = 8;
+
+    HalfBandState upStage2x, downStage2x;
+    HalfBandState upStage4x, downStage4x;
+    HalfBandState upStage8x, downStage8x;
+    int factor;
+
+    PolyOversampler()
+    {
+        factor = 1;
+        reset();
+    }
+
+    // factor 1, 2, 4 or 8
+    void setFactor(int oversamplingFactor)
+    {
+        if (oversamplingFactor != factor) {
+            factor = validOversampling(oversamplingFactor);
+            reset();
+        }
+    }
+
+    void reset()
+    {
+        HalfBandState* stages[] = { &upStage2x, &downStage2x, &upStage4x, &downStage4x, &upStage8x, &downStage8x };
+        for (HalfBandState* stage : stages) {
+            for (int i = 0; i < maxHalfBandCoefs; i++) {
+                for (int k = 0; k < maxLanes; k++) {
+                    stage->x[i][k] = stage->y[i][k] = 0.f;
+                }
+            }
+        }
+    }
+
+    // writes `factor` rows of numLanes samples to outputSamples
+    inline void upsample(const float* inputSamples, float outputSamples[][maxLanes], int numLanes)
+    {
+        const SimdKernels* k = simdKernels;
+
+        switch (factor) {
+        case 1:
+            for (int i = 0; i < numLanes; i++) {
+                outputSamples[0][i] = inputSamples[i];
+            }
+            break;
+        case 2:
+            k->halfBandUpsample(halfBandCoefs2x, 10, upStage2x, inputSamples, outputSamples[0], outputSamples[1], numLanes);
+            break;
+        case 4: {
+            float buffer[2][maxLanes];
+            k->halfBandUpsample(halfBandCoefs2x, 10, upStage2x, inputSamples, buffer[0], buffer[1], numLanes);
+            for (int i = 0; i < 2; i++) {
+                k->halfBandUpsample(halfBandCoefs4x, 4, upStage4x, buffer[i], outputSamples[2 * i], outputSamples[2 * i + 1], numLanes);
+            }
+        } break;
+        case 8: {
+            float buffer2x[2][maxLanes];
+            float buffer4x[4][maxLanes];
+            k->halfBandUpsample(halfBandCoefs2x, 10, upStage2x, inputSamples, buffer2x[0], buffer2x[1], numLanes);
+            for (int i = 0; i < 2; i++) {
+                k->halfBandUpsample(halfBandCoefs4x, 4, upStage4x, buffer2x[i], buffer4x[2 * i], buffer4x[2 * i + 1], numLanes);
+            }
+            for (int i = 0; i < 4; i++) {
+                k->halfBandUpsample(halfBandCoefs8x, 3, upStage8x, buffer4x[i], outputSamples[2 * i], outputSamples[2 * i + 1], numLanes);
+            }
+        } break;
+        }
+    }
+
+    // reads `factor` rows of numLanes samples from inputSamples
+    inline void downsample(float inputSamples[][maxLanes], float* outputSamples, int numLanes)
+    {
+        const SimdKernels* k = simdKernels;
+
+        switch (factor) {
+        case 2:
+            k->halfBandDownsample(halfBandCoefs2x, 10, downStage2x, inputSamples[0], inputSamples[1], outputSamples, numLanes);
+            break;
+        case 4: {
+            float buffer[2][maxLanes];
+            for (int i = 0; i < 2; i++) {
+                k->halfBandDownsample(halfBandCoefs4x, 4, downStage4x, inputSamples[2 * i], inputSamples[2 * i + 1], buffer[i], numLanes);
+            }
+            k->halfBandDownsample(halfBandCoefs2x, 10, downStage2x, buffer[0], buffer[1], outputSamples, numLanes);
+        } break;
+        case 8: {
+            float buffer2x[2][maxLanes];
+            float buffer4x[4][maxLanes];
+            for (int i = 0; i < 4; i++) {
+                k->halfBandDownsample(halfBandCoefs8x, 3, downStage8x, inputSamples[2 * i], inputSamples[2 * i + 1], buffer4x[i], numLanes);
+            }
+            for (int i = 0; i < 2; i++) {
+                k->halfBandDownsample(halfBandCoefs4x, 4, downStage4x, buffer4x[2 * i], buffer4x[2 * i + 1], buffer2x[i], numLanes);
+            }
+            k->halfBandDownsample(halfBandCoefs2x, 10, downStage2x, buffer2x[0], buffer2x[1], outputSamples, numLanes);
+        } break;
+        default:
+            for (int i = 0; i < numLanes; i++) {
+                outputSamples[i] = inputSamples[0][i];
+            }
+            break;
+        }
+    }
+}; /* end PolyOversampler */
+
+/* #silencedetector
+======================================================================================== */
+// Lets a module sleep through digital silence. The module keeps running for its tail (delay
+// lines, filter or reverb decay) plus a short hold after the last non-zero input sample, after
+// which process() reports that the dsp can be skipped. Any non-zero input wakes it at once.
+
+struct SilenceDetector {
+
+    long sleepAfter;
+    long silentSamples;
+
+    SilenceDetector()
+    {
+        sleepAfter = 0;
+        reset();
+    }
+
+    void reset()
+    {
+        silentSamples = 0;
+    }
+
+    // tail in samples at the current sample rate
+    void setTail(double tailSamples, double sampleRate)
+    {
+        sleepAfter = (long)(tailSamples + 0.05 * sampleRate);
+    }
+
+    // call once per sample, returns true while the module may sleep
+    inline bool process(bool isSilent)
+    {
+        if (!isSilent) {
+            silentSamples = 0;
+            return false;
+        }
+        if (silentSamples < sleepAfter) {
+            silentSamples++;
+            return false;
+        }
+        return true;
+    }
+}; /* end SilenceDetector */
+
 /* #Slew
 ======================================================================================== */
+// Slew, Slew2 and Slew3 are templated on the sample type like Acceleration, and take the
+// threshold from getThreshold(), which is the same for all three.
+template <typename T>
 struct Slew {
 
-    double lastSample;
+    T lastSample;
 
     Slew()
     {
-        lastSample = 0.0;
+        reset();
     }
 
-    long double process(long double inputSample, float clampParam = 0.f, double overallscale = 1.0)
+    void reset()
     {
-        double clamp;
-        double threshold = pow((1 - clampParam), 4) / overallscale;
-        double outputSample;
+        lastSample = T(0.0);
+    }
 
-        clamp = inputSample - lastSample;
-        outputSample = inputSample;
-        if (clamp > threshold)
-            outputSample = lastSample + threshold;
-        if (-clamp > threshold)
-            outputSample = lastSample - threshold;
+    // once per sample for all voices
+    static double getThreshold(float clampParam, double overallscale)
+    {
+        return pow((1 - clampParam), 4) / overallscale;
+    }
+
+    inline T process(T inputSample, T threshold)
+    {
+        // within threshold of the last sample
+        T outputSample = fmin(fmax(inputSample, lastSample - threshold), lastSample + threshold);
         lastSample = outputSample;
 
         return outputSample;
@@ -887,106 +1443,74 @@ struct Slew {
 
 /* #slew2
 ======================================================================================== */
+template <typename T>
 struct Slew2 {
 
-    double LataLast3Sample;
-    double LataLast2Sample;
-    double LataLast1Sample;
-    double LataHalfwaySample;
-    double LataHalfDrySample;
-    double LataHalfDiffSample;
-    double LataA;
-    double LataB;
-    double LataC;
-    double LataDecay;
-    double LataUpsampleHighTweak;
-    double LataDrySample;
-    double LataDiffSample;
-    double LataPrevDiffSample;
-
-    bool LataFlip; //end defining of antialiasing variables
+    T LataLast3Sample;
+    T LataLast2Sample;
+    T LataLast1Sample;
+    T LataA;
+    T LataB;
+    T LataPrevDiffSample; //end defining of antialiasing variables
 
-    double lastSample;
+    T lastSample;
 
     Slew2()
     {
-        LataLast3Sample = LataLast2Sample = LataLast1Sample = 0.0;
-        LataHalfwaySample = LataHalfDrySample = LataHalfDiffSample = 0.0;
-        LataA = LataB = LataC = LataDrySample = LataDiffSample = LataPrevDiffSample = 0.0;
-        LataUpsampleHighTweak = 0.0414213562373095048801688; //more adds treble to upsampling
-        LataDecay = 0.915965594177219015; //Catalan's constant, more adds focus and clarity
-        lastSample = 0.0;
+        reset();
+    }
+
+    void reset()
+    {
+        LataLast3Sample = LataLast2Sample = LataLast1Sample = T(0.0);
+        LataA = LataB = LataPrevDiffSample = T(0.0);
+        lastSample = T(0.0); //end reset of antialias parameters
+    }
 
-        LataFlip = false; //end reset of antialias parameters
+    static double getThreshold(float clampParam, double overallscale)
+    {
+        return Slew<T>::getThreshold(clampParam, overallscale);
     }
 
-    long double process(long double inputSample, float clampParam = 0.f, double overallscale = 1.0)
+    inline T process(T inputSample, T threshold)
     {
-        double clamp;
-        double threshold = pow((1 - clampParam), 4) / overallscale;
+        const T LataUpsampleHighTweak = T(0.0414213562373095048801688); //more adds treble to upsampling
+        const T LataDecay = T(0.915965594177219015); //Catalan's constant, more adds focus and clarity
 
-        LataDrySample = inputSample;
+        T LataDrySample = inputSample;
 
-        LataHalfDrySample = LataHalfwaySample = (inputSample + LataLast1Sample + ((-LataLast2Sample + LataLast3Sample) * LataUpsampleHighTweak)) / 2.0;
+        T LataHalfwaySample = (inputSample + LataLast1Sample + ((-LataLast2Sample + LataLast3Sample) * LataUpsampleHighTweak)) * T(0.5);
         LataLast3Sample = LataLast2Sample;
         LataLast2Sample = LataLast1Sample;
         LataLast1Sample = inputSample;
         //setting up oversampled special antialiasing
-        //begin first half- change inputSample -> LataHalfwaySample, LataDrySample -> LataHalfDrySample
-        clamp = LataHalfwaySample - LataHalfDrySample;
-        if (clamp > threshold)
-            LataHalfwaySample = lastSample + threshold;
-        if (-clamp > threshold)
-            LataHalfwaySample = lastSample - threshold;
+        //first half: the halfway sample is its own dry sample, so it is never clamped and
+        //leaves nothing to antialias
         lastSample = LataHalfwaySample;
-        //end first half
-        //begin antialiasing section for halfway sample
-        LataC = LataHalfwaySample - LataHalfDrySample;
-        if (LataFlip) {
-            LataA *= LataDecay;
-            LataB *= LataDecay;
-            LataA += LataC;
-            LataB -= LataC;
-            LataC = LataA;
-        } else {
-            LataB *= LataDecay;
-            LataA *= LataDecay;
-            LataB += LataC;
-            LataA -= LataC;
-            LataC = LataB;
-        }
-        LataHalfDiffSample = (LataC * LataDecay);
-        LataFlip = !LataFlip;
+        //antialiasing section for halfway sample, the flip is clear (it toggles twice per
+        //sample, so each half always takes the same side)
+        LataB *= LataDecay;
+        LataA *= LataDecay;
+        T LataHalfDiffSample = (LataB * LataDecay);
         //end antialiasing section for halfway sample
         //begin second half- inputSample and LataDrySample handled separately here
-        clamp = inputSample - lastSample;
-        if (clamp > threshold)
-            inputSample = lastSample + threshold;
-        if (-clamp > threshold)
-            inputSample = lastSample - threshold;
+        inputSample = fmin(fmax(inputSample, lastSample - threshold), lastSample + threshold);
         lastSample = inputSample;
         //end second half
-        //begin antialiasing section for input sample
-        LataC = inputSample - LataDrySample;
-        if (LataFlip) {
-            LataA *= LataDecay;
-            LataB *= LataDecay;
-            LataA += LataC;
-            LataB -= LataC;
-            LataC = LataA;
-        } else {
-            LataB *= LataDecay;
-            LataA *= LataDecay;
-            LataB += LataC;
-            LataA -= LataC;
-            LataC = LataB;
-        }
-        LataDiffSample = (LataC * LataDecay);
-        LataFlip = !LataFlip;
+        //begin antialiasing section for input sample, the flip is set
+        T LataC = inputSample - LataDrySample;
+        LataA *= LataDecay;
+        LataB *= LataDecay;
+        LataA += LataC;
+        LataB -= LataC;
+        T LataDiffSample = (LataA * LataDecay);
+        //while nothing is clamped they only decay, so they are flushed before going denormal
+        LataA = ifelse(fabs(LataA) < T(1e-30), T(0.0), LataA);
+        LataB = ifelse(fabs(LataB) < T(1e-30), T(0.0), LataB);
         //end antialiasing section for input sample
         inputSample = LataDrySample;
-        inputSample += ((LataDiffSample + LataHalfDiffSample + LataPrevDiffSample) / 0.734);
-        LataPrevDiffSample = LataDiffSample / 2.0;
+        inputSample += ((LataDiffSample + LataHalfDiffSample + LataPrevDiffSample) / T(0.734));
+        LataPrevDiffSample = LataDiffSample * T(0.5);
         //apply processing as difference to non-oversampled raw input
 
         return inputSample;
@@ -995,24 +1519,33 @@ struct Slew2 {
 
 /* #slew3
 ======================================================================================== */
+template <typename T>
 struct Slew3 {
 
-    double lastSampleA;
-    double lastSampleB;
-    double lastSampleC;
+    T lastSampleA;
+    T lastSampleB;
+    T lastSampleC;
 
     Slew3()
     {
-        lastSampleA = lastSampleB = lastSampleC = 0.0;
+        reset();
     }
 
-    long double process(long double inputSample, float clampParam = 0.0, double overallscale = 1.0)
+    void reset()
     {
-        double threshold = pow((1 - clampParam), 4) / overallscale;
+        lastSampleA = lastSampleB = lastSampleC = T(0.0);
+    }
 
+    static double getThreshold(float clampParam, double overallscale)
+    {
+        return Slew<T>::getThreshold(clampParam, overallscale);
+    }
+
+    inline T process(T inputSample, T threshold)
+    {
         // regular slew clamping added
-        double clamp = (lastSampleB - lastSampleC) * 0.381966011250105;
-        clamp -= (lastSampleA - lastSampleB) * 0.6180339887498948482045;
+        T clamp = (lastSampleB - lastSampleC) * T(0.381966011250105);
+        clamp -= (lastSampleA - lastSampleB) * T(0.6180339887498948482045);
         clamp += inputSample - lastSampleA;
 
         // now our output relates off lastSampleB
@@ -1020,13 +1553,11 @@ struct Slew3 {
         lastSampleB = lastSampleA;
         lastSampleA = inputSample;
 
-        if (clamp > threshold)
-            inputSample = lastSampleB + threshold;
-        if (-clamp > threshold)
-            inputSample = lastSampleB - threshold;
+        inputSample = ifelse(clamp > threshold, lastSampleB + threshold, inputSample);
+        inputSample = ifelse(-clamp > threshold, lastSampleB - threshold, inputSample);
 
         // split the difference between raw and smoothed for buffer
-        lastSampleA = (lastSampleA * 0.381966011250105) + (inputSample * 0.6180339887498948482045);
+        lastSampleA = (lastSampleA * T(0.381966011250105)) + (inputSample * T(0.6180339887498948482045));
 
         return inputSample;
     }
@@ -1039,6 +1570,11 @@ struct SlewOnly {
     double lastSample;
 
     SlewOnly()
+    {
+        reset();
+    }
+
+    void reset()
     {
         lastSample = 0.0;
     }
@@ -1091,6 +1627,11 @@ struct SubsOnly {
     double iirSampleZ;
 
     SubsOnly()
+    {
+        reset();
+    }
+
+    void reset()
     {
         iirSampleA = 0.0;
         iirSampleB = 0.0;
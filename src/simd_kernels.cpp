@@ -0,0 +1,23 @@
+#include "simd_kernels.hpp"
+
+namespace rwlib {
+
+const SimdKernels* simdKernels = &sse2::simdKernels;
+
+const char* initSimdKernels()
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    // __builtin_cpu_supports also checks that the OS saves the wider registers
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl")) {
+        simdKernels = &avx512::simdKernels;
+    } else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        simdKernels = &avx2::simdKernels;
+    } else {
+        simdKernels = &sse2::simdKernels;
+    }
+#endif
+    return simdKernels->name;
+}
+
+} /* end namespace rwlib */
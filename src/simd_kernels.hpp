@@ -0,0 +1,52 @@
+#ifndef SIMD_KERNELS_HPP
+#define SIMD_KERNELS_HPP
+
+namespace rwlib {
+
+/* #simd kernels
+======================================================================================== */
+// Hot inner loops that gain from wider vectors than the SSE baseline Rack plugins are
+// built for. The same source (simd_kernels_impl.hpp) is compiled once per instruction set
+// (see src/arch and the Makefile) and the best table for the host CPU is picked once in
+// init(). Kernels work lane-wise on plain float arrays of up to maxLanes voices, so the
+// compiler vectorises them at whatever width the object was built for.
+
+static const int maxLanes = 16;
+static const int maxHalfBandCoefs = 10;
+
+// allpass memory of one half-band stage for all lanes (modules are heap allocated without
+// over-alignment, so no alignas here)
+struct HalfBandState {
+    float x[maxHalfBandCoefs][maxLanes];
+    float y[maxHalfBandCoefs][maxLanes];
+};
+
+struct SimdKernels {
+    const char* name;
+
+    // one sample in, two samples out (per lane)
+    void (*halfBandUpsample)(const double* coefs, int numCoefs, HalfBandState& state, const float* in, float* out0, float* out1, int numLanes);
+
+    // two samples in, one sample out (per lane)
+    void (*halfBandDownsample)(const double* coefs, int numCoefs, HalfBandState& state, const float* in0, const float* in1, float* out, int numLanes);
+};
+
+namespace sse2 {
+extern const SimdKernels simdKernels;
+}
+namespace avx2 {
+extern const SimdKernels simdKernels;
+}
+namespace avx512 {
+extern const SimdKernels simdKernels;
+}
+
+// kernels for the host CPU, SSE2 until initSimdKernels() has run
+extern const SimdKernels* simdKernels;
+
+// select the widest supported kernel set, returns its name
+const char* initSimdKernels();
+
+} /* end namespace rwlib */
+
+#endif
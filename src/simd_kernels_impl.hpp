@@ -0,0 +1,88 @@
+// Kernel bodies shared by all instruction sets, included once by each file in src/arch
+// with SIMD_KERNELS_ARCH set to the namespace to build into and SIMD_KERNELS_NAME to the
+// name reported for it. Everything here lives in that namespace and must not call inline
+// functions or templates from other headers: the linker would be free to keep an AVX build
+// of them for code running on any CPU.
+
+#if !defined(SIMD_KERNELS_ARCH) || !defined(SIMD_KERNELS_NAME)
+#error "SIMD_KERNELS_ARCH and SIMD_KERNELS_NAME must be defined before including simd_kernels_impl.hpp"
+#endif
+
+#include "simd_kernels.hpp"
+
+namespace rwlib {
+namespace SIMD_KERNELS_ARCH {
+
+    // even coefficients feed the first path, odd ones the second
+    static void allpass(const double* coefs, int numCoefs, HalfBandState& state, float* __restrict sample0, float* __restrict sample1, int numLanes)
+    {
+        for (int i = 0; i < numCoefs; i += 2) {
+            const float coef0 = (float)coefs[i];
+            float* __restrict x0 = state.x[i];
+            float* __restrict y0 = state.y[i];
+
+            for (int k = 0; k < numLanes; k++) {
+                float temp0 = (sample0[k] - y0[k]) * coef0 + x0[k];
+                x0[k] = sample0[k];
+                y0[k] = temp0;
+                sample0[k] = temp0;
+            }
+
+            if (i + 1 < numCoefs) {
+                const float coef1 = (float)coefs[i + 1];
+                float* __restrict x1 = state.x[i + 1];
+                float* __restrict y1 = state.y[i + 1];
+
+                for (int k = 0; k < numLanes; k++) {
+                    float temp1 = (sample1[k] - y1[k]) * coef1 + x1[k];
+                    x1[k] = sample1[k];
+                    y1[k] = temp1;
+                    sample1[k] = temp1;
+                }
+            }
+        }
+    }
+
+    static void halfBandUpsample(const double* coefs, int numCoefs, HalfBandState& state, const float* in, float* out0, float* out1, int numLanes)
+    {
+        alignas(64) float sample0[maxLanes];
+        alignas(64) float sample1[maxLanes];
+
+        for (int k = 0; k < numLanes; k++) {
+            sample0[k] = in[k];
+            sample1[k] = in[k];
+        }
+
+        allpass(coefs, numCoefs, state, sample0, sample1, numLanes);
+
+        for (int k = 0; k < numLanes; k++) {
+            out0[k] = sample0[k];
+            out1[k] = sample1[k];
+        }
+    }
+
+    static void halfBandDownsample(const double* coefs, int numCoefs, HalfBandState& state, const float* in0, const float* in1, float* out, int numLanes)
+    {
+        alignas(64) float sample0[maxLanes];
+        alignas(64) float sample1[maxLanes];
+
+        for (int k = 0; k < numLanes; k++) {
+            sample0[k] = in1[k];
+            sample1[k] = in0[k];
+        }
+
+        allpass(coefs, numCoefs, state, sample0, sample1, numLanes);
+
+        for (int k = 0; k < numLanes; k++) {
+            out[k] = (sample0[k] + sample1[k]) * 0.5f;
+        }
+    }
+
+    extern const SimdKernels simdKernels = {
+        SIMD_KERNELS_NAME,
+        halfBandUpsample,
+        halfBandDownsample
+    };
+
+} /* end namespace SIMD_KERNELS_ARCH */
+} /* end namespace rwlib */
@@ -47,6 +47,7 @@ struct Tape : Module {
     const double gainCut = 0.1;
     const double gainBoost = 10.0;
     int quality;
+    int oversampling;
 
     // control parameters
     float slamParam;
@@ -57,9 +58,19 @@ struct Tape : Module {
     rwlib::Tape tapeR[MAX_POLY_CHANNELS];
     uint32_t fpdL[MAX_POLY_CHANNELS];
     uint32_t fpdR[MAX_POLY_CHANNELS];
+    rwlib::PolyOversampler oversamplerL;
+    rwlib::PolyOversampler oversamplerR;
 
     // other
     double overallscale;
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
+    int lastOversampling;
+
+    // process kernel, specialised at compile time for the current quality setting
+    typedef void (Tape::*ProcessKernel)(const ProcessArgs& args);
+    ProcessKernel kernel;
+    int kernelQuality;
 
     Tape()
     {
@@ -68,6 +79,8 @@ struct Tape : Module {
         configParam(BUMP_PARAM, 0.f, 1.f, 0.5f, "Bump", "%", 0, 100);
 
         quality = loadQuality();
+        oversampling = lastOversampling = 1;
+        kernelQuality = -1;
         onReset();
     }
 
@@ -81,6 +94,11 @@ struct Tape : Module {
 
             fpdL[i] = fpdR[i] = 17;
         }
+
+        oversamplerL.setFactor(oversampling);
+        oversamplerL.reset();
+        oversamplerR.setFactor(oversampling);
+        oversamplerR.reset();
     }
 
     void onSampleRateChange() override
@@ -90,11 +108,15 @@ struct Tape : Module {
         overallscale = 1.0;
         overallscale /= 44100.0;
         overallscale *= sampleRate;
+        overallscale *= oversampling;
 
         for (int i = 0; i < MAX_POLY_CHANNELS; i++) {
             tapeL[i].onSampleRateChange(overallscale);
             tapeR[i].onSampleRateChange(overallscale);
         }
+
+        // tail: decay of the head bump resonance
+        silenceDetector.setTail(0.5 * sampleRate, sampleRate);
     }
 
     json_t* dataToJson() override
@@ -104,6 +126,9 @@ struct Tape : Module {
         // quality
         json_object_set_new(rootJ, "quality", json_integer(quality));
 
+        // oversampling
+        json_object_set_new(rootJ, "oversampling", json_integer(oversampling));
+
         return rootJ;
     }
 
@@ -113,98 +138,159 @@ struct Tape : Module {
         json_t* qualityJ = json_object_get(rootJ, "quality");
         if (qualityJ)
             quality = json_integer_value(qualityJ);
+
+        // oversampling
+        json_t* oversamplingJ = json_object_get(rootJ, "oversampling");
+        if (oversamplingJ)
+            oversampling = rwlib::validOversampling(json_integer_value(oversamplingJ));
     }
 
-    void process(const ProcessArgs& args) override
+    template <int QUALITY>
+    long double processTape(long double inputSample, rwlib::Tape& tape, uint32_t& fpd)
     {
-        slamParam = params[SLAM_PARAM].getValue();
-        slamParam += inputs[SLAM_CV_INPUT].getVoltage() / 10;
-        slamParam = clamp(slamParam, 0.01f, 0.99f);
+        // pad gain
+        inputSample *= gainCut;
 
-        bumpParam = params[BUMP_PARAM].getValue();
-        bumpParam += inputs[BUMP_CV_INPUT].getVoltage() / 10;
-        bumpParam = clamp(bumpParam, 0.01f, 0.99f);
+        if (QUALITY == HIGH) {
+            if (fabs(inputSample) < 1.18e-37) {
+                inputSample = fpd * 1.18e-37;
+                dspStats.denormalGuards++;
+            }
+        }
+
+        // work the magic
+        return tape.process(inputSample, slamParam, bumpParam, overallscale);
+    }
+
+    template <int QUALITY>
+    long double ditherAndBoost(long double inputSample, uint32_t& fpd)
+    {
+        if (QUALITY == HIGH) {
+            DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
+            //32 bit stereo floating point dither
+            int expon;
+            frexpf((float)inputSample, &expon);
+            fpd ^= fpd << 13;
+            fpd ^= fpd >> 17;
+            fpd ^= fpd << 5;
+            inputSample += ((double(fpd) - uint32_t(0x7fffffff)) * 5.5e-36l * pow(2, expon + 62));
+        }
+
+        // bring gain back up
+        inputSample *= gainBoost;
+
+        return inputSample;
+    }
+
+    template <int QUALITY>
+    void processChannel(Input& input, Output& output, rwlib::Tape tape[], uint32_t fpd[], rwlib::PolyOversampler& oversampler)
+    {
+        long double inputSample;
 
         // number of polyphonic channels
-        int numChannelsL = std::max(1, inputs[IN_L_INPUT].getChannels());
-        int numChannelsR = std::max(1, inputs[IN_R_INPUT].getChannels());
+        int numChannels = std::max(1, input.getChannels());
 
-        // process left channel
-        if (outputs[OUT_L_OUTPUT].isConnected()) {
+        if (oversampling == 1) {
+
+            // all voices in at once, processed in place
+            PolyBuffer voices;
+            voices.read(input);
 
-            // for each poly channel left
-            for (int i = 0; i < numChannelsL; i++) {
+            // for each poly channel
+            for (int i = 0; i < numChannels; i++) {
 
                 // input
-                long double inputSampleL = inputs[IN_L_INPUT].getPolyVoltage(i);
+                inputSample = voices[i];
 
-                // pad gain
-                inputSampleL *= gainCut;
+                inputSample = processTape<QUALITY>(inputSample, tape[i], fpd[i]);
+                inputSample = ditherAndBoost<QUALITY>(inputSample, fpd[i]);
 
-                if (quality == HIGH) {
-                    if (fabs(inputSampleL) < 1.18e-37)
-                        inputSampleL = fpdL[i] * 1.18e-37;
-                }
+                // output
+                voices[i] = inputSample;
+            }
+
+            voices.write(output);
+        } else {
+            float buffer[rwlib::PolyOversampler::maxFactor][rwlib::maxLanes];
+
+            // all voices in at once, processed in place
+            PolyBuffer voices;
+            voices.read(input);
 
-                // work the magic
-                inputSampleL = tapeL[i].process(inputSampleL, slamParam, bumpParam, overallscale);
-
-                if (quality == HIGH) {
-                    //32 bit stereo floating point dither
-                    int expon;
-                    frexpf((float)inputSampleL, &expon);
-                    fpdL[i] ^= fpdL[i] << 13;
-                    fpdL[i] ^= fpdL[i] >> 17;
-                    fpdL[i] ^= fpdL[i] << 5;
-                    inputSampleL += ((double(fpdL[i]) - uint32_t(0x7fffffff)) * 5.5e-36l * pow(2, expon + 62));
+            oversampler.upsample(voices.voltages, buffer, numChannels);
+
+            // work the magic at the oversampled rate
+            for (int j = 0; j < oversampling; j++) {
+                for (int i = 0; i < numChannels; i++) {
+                    buffer[j][i] = processTape<QUALITY>(buffer[j][i], tape[i], fpd[i]);
                 }
+            }
+
+            oversampler.downsample(buffer, voices.voltages, numChannels);
 
-                // bring gain back up
-                inputSampleL *= gainBoost;
+            for (int i = 0; i < numChannels; i++) {
+                inputSample = ditherAndBoost<QUALITY>(voices[i], fpd[i]);
 
                 // output
-                outputs[OUT_L_OUTPUT].setChannels(numChannelsL);
-                outputs[OUT_L_OUTPUT].setVoltage(inputSampleL, i);
+                voices[i] = inputSample;
             }
+
+            voices.write(output);
         }
+    }
 
-        // process right channel
-        if (outputs[OUT_R_OUTPUT].isConnected()) {
+    void selectKernel()
+    {
+        kernel = (quality == HIGH) ? &Tape::processKernel<HIGH> : &Tape::processKernel<ECO>;
+        kernelQuality = quality;
+    }
+
+    void process(const ProcessArgs& args) override
+    {
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
 
-            // for each poly channel right
-            for (int i = 0; i < numChannelsR; i++) {
+        // skip the dsp once the inputs have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs[IN_L_INPUT]) && isSilent(inputs[IN_R_INPUT]))) {
+            dspStats.sleep();
+            clearOutputs(outputs);
+            return;
+        }
 
-                // input
-                long double inputSampleR = inputs[IN_R_INPUT].getPolyVoltage(i);
+        if (quality != kernelQuality) {
+            selectKernel();
+        }
 
-                // pad gain
-                inputSampleR *= gainCut;
+        (this->*kernel)(args);
+    }
 
-                if (quality == HIGH) {
-                    if (fabs(inputSampleR) < 1.18e-37)
-                        inputSampleR = fpdR[i] * 1.18e-37;
-                }
+    template <int QUALITY>
+    void processKernel(const ProcessArgs& args)
+    {
+        slamParam = params[SLAM_PARAM].getValue();
+        slamParam += inputs[SLAM_CV_INPUT].getVoltage() / 10;
+        slamParam = clamp(slamParam, 0.01f, 0.99f);
 
-                // work the magic
-                inputSampleR = tapeR[i].process(inputSampleR, slamParam, bumpParam, overallscale);
-
-                if (quality == HIGH) {
-                    //32 bit stereo floating point dither
-                    int expon;
-                    frexpf((float)inputSampleR, &expon);
-                    fpdR[i] ^= fpdR[i] << 13;
-                    fpdR[i] ^= fpdR[i] >> 17;
-                    fpdR[i] ^= fpdR[i] << 5;
-                    inputSampleR += ((double(fpdR[i]) - uint32_t(0x7fffffff)) * 5.5e-36l * pow(2, expon + 62));
-                }
+        bumpParam = params[BUMP_PARAM].getValue();
+        bumpParam += inputs[BUMP_CV_INPUT].getVoltage() / 10;
+        bumpParam = clamp(bumpParam, 0.01f, 0.99f);
 
-                // bring gain back up
-                inputSampleR *= gainBoost;
+        // apply oversampling changes
+        if (oversampling != lastOversampling) {
+            onSampleRateChange();
+            oversamplerL.setFactor(oversampling);
+            oversamplerR.setFactor(oversampling);
+            lastOversampling = oversampling;
+            dspStats.oversampling = oversampling;
+        }
 
-                // output
-                outputs[OUT_R_OUTPUT].setChannels(numChannelsR);
-                outputs[OUT_R_OUTPUT].setVoltage(inputSampleR, i);
-            }
+        // process left channel
+        if (outputs[OUT_L_OUTPUT].isConnected()) {
+            processChannel<QUALITY>(inputs[IN_L_INPUT], outputs[OUT_L_OUTPUT], tapeL, fpdL, oversamplerL);
+        }
+
+        // process right channel
+        if (outputs[OUT_R_OUTPUT].isConnected()) {
+            processChannel<QUALITY>(inputs[IN_R_INPUT], outputs[OUT_R_OUTPUT], tapeR, fpdR, oversamplerR);
         }
     }
 };
@@ -227,6 +313,22 @@ struct TapeWidget : ModuleWidget {
         }
     };
 
+    // oversampling item
+    struct OversamplingItem : MenuItem {
+        Tape* module;
+        int oversampling;
+
+        void onAction(const event::Action& e) override
+        {
+            module->oversampling = oversampling;
+        }
+
+        void step() override
+        {
+            rightText = (module->oversampling == oversampling) ? "✔" : "";
+        }
+    };
+
     void appendContextMenu(Menu* menu) override
     {
         Tape* module = dynamic_cast<Tape*>(this->module);
@@ -249,12 +351,33 @@ struct TapeWidget : ModuleWidget {
         high->module = module;
         high->quality = 1;
         menu->addChild(high);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        MenuLabel* oversamplingLabel = new MenuLabel(); // menu label
+        oversamplingLabel->text = "Oversampling";
+        menu->addChild(oversamplingLabel);
+
+        const char* oversamplingNames[] = { "Off", "2x", "4x", "8x" };
+        for (int i = 0; i < 4; i++) {
+            OversamplingItem* oversamplingItem = new OversamplingItem();
+            oversamplingItem->text = oversamplingNames[i];
+            oversamplingItem->module = module;
+            oversamplingItem->oversampling = 1 << i;
+            menu->addChild(oversamplingItem);
+        }
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
     }
 
     TapeWidget(Tape* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/tape_dark.svg")));
+        setPanel(loadArtwork("tape_dark.svg"));
 
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH, 0)));
         addChild(createWidget<ScrewBlack>(Vec(box.size.x - 2 * RACK_GRID_WIDTH, 0)));
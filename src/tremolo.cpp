@@ -50,18 +50,23 @@ struct Tremolo : Module {
     float speedParam;
     float depthParam;
 
+    // lfo state, shared by all voices (the speed and depth CV are monophonic)
+    double sweep;
+    double speedChase;
+    double depthChase;
+    double speedAmount;
+    double depthAmount;
+    double lastSpeed;
+    double lastDepth;
+
     // state variables (as arrays in order to handle up to 16 polyphonic channels)
-    double sweep[16];
-    double speedChase[16];
-    double depthChase[16];
-    double speedAmount[16];
-    double depthAmount[16];
-    double lastSpeed[16];
-    double lastDepth[16];
     long double fpNShape[16];
 
     // other variables, which do not need to be updated every cycle
     double overallscale;
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
+    rwlib::DitherNoise ditherSource;
     double speedSpeed;
     double depthSpeed;
     float lastSpeedParam;
@@ -70,6 +75,11 @@ struct Tremolo : Module {
     // constants
     const double tupi = 3.141592653589793238;
 
+    // process kernel, specialised at compile time for the current quality setting
+    typedef void (Tremolo::*ProcessKernel)(const ProcessArgs& args);
+    ProcessKernel kernel;
+    int kernelQuality;
+
     Tremolo()
     {
         config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -77,6 +87,7 @@ struct Tremolo : Module {
         configParam(DEPTH_PARAM, 0.f, 1.f, 0.f, "Depth");
 
         quality = loadQuality();
+        kernelQuality = -1;
         onReset();
     }
 
@@ -89,14 +100,15 @@ struct Tremolo : Module {
         lastSpeedParam = 0.0;
         lastDepthParam = 0.0;
 
+        sweep = 3.141592653589793238 / 2.0;
+        speedChase = 0.0;
+        depthChase = 0.0;
+        speedAmount = 1.0;
+        depthAmount = 0.0;
+        lastSpeed = 1000.0;
+        lastDepth = 1000.0;
+
         for (int i = 0; i < 16; i++) {
-            sweep[i] = 3.141592653589793238 / 2.0;
-            speedChase[i] = 0.0;
-            depthChase[i] = 0.0;
-            speedAmount[i] = 1.0;
-            depthAmount[i] = 0.0;
-            lastSpeed[i] = 1000.0;
-            lastDepth[i] = 1000.0;
             fpNShape[i] = 0.0;
         }
     }
@@ -108,6 +120,9 @@ struct Tremolo : Module {
         overallscale = 1.0;
         overallscale /= 44100.0;
         overallscale *= sampleRate;
+
+        // tail: none, the tremolo has no memory besides its lfo
+        silenceDetector.setTail(0.0, sampleRate);
     }
 
     json_t* dataToJson() override
@@ -128,7 +143,32 @@ struct Tremolo : Module {
             quality = json_integer_value(qualityJ);
     }
 
+    void selectKernel()
+    {
+        kernel = (quality == HIGH) ? &Tremolo::processKernel<HIGH> : &Tremolo::processKernel<ECO>;
+        kernelQuality = quality;
+    }
+
     void process(const ProcessArgs& args) override
+    {
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
+
+        // skip the dsp once the inputs have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs[IN_INPUT]))) {
+            dspStats.sleep();
+            clearOutputs(outputs);
+            return;
+        }
+
+        if (quality != kernelQuality) {
+            selectKernel();
+        }
+
+        (this->*kernel)(args);
+    }
+
+    template <int QUALITY>
+    void processKernel(const ProcessArgs& args)
     {
         if (outputs[OUT_OUTPUT].isConnected()) {
 
@@ -140,44 +180,68 @@ struct Tremolo : Module {
             depthParam += inputs[DEPTH_CV_INPUT].getVoltage() / 5;
             depthParam = clamp(depthParam, 0.01f, 0.99f);
 
-            double speed;
-            double depth;
-            double skew;
-            double density;
-            double control;
+            if (speedParam != lastSpeedParam) {
+                speedChase = pow(speedParam, 4);
+                speedSpeed = 300 / (fabs(lastSpeed - speedChase) + 1.0);
+                lastSpeed = speedChase;
+            }
+
+            if (depthParam != lastDepthParam) {
+                depthChase = depthParam;
+                depthSpeed = 300 / (fabs(lastDepth - depthChase) + 1.0);
+                lastDepth = depthChase;
+            }
+
+            // lfo and control signal, once for all voices
+            speedAmount = (((speedAmount * speedSpeed) + speedChase) / (speedSpeed + 1.0));
+            depthAmount = (((depthAmount * depthSpeed) + depthChase) / (depthSpeed + 1.0));
+            double speed = 0.0001 + (speedAmount / 1000.0);
+            speed /= overallscale;
+            double depth = 1.0 - pow(1.0 - depthAmount, 5);
+            double skew = 1.0 + pow(depthAmount, 9);
+            double density = ((1.0 - depthAmount) * 2.0) - 1.0;
+
+            double offset = sin(sweep);
+            sweep += speed;
+            if (sweep > tupi) {
+                sweep -= tupi;
+            }
+            double control = fabs(offset);
             double tempcontrol;
-            double thickness;
-            double out;
+            if (density > 0) {
+                tempcontrol = sin(control);
+                control = (control * (1.0 - density)) + (tempcontrol * density);
+            } else {
+                tempcontrol = 1 - cos(control);
+                control = (control * (1.0 + density)) + (tempcontrol * -density);
+            }
+            //produce either boosted or starved version of control signal
+            //will go from 0 to 1
+
+            double thickness = ((control * 2.0) - 1.0) * skew;
+            double out = fabs(thickness);
+
             double bridgerectifier;
-            double offset;
             long double inputSample;
             long double drySample;
 
             // number of polyphonic channels
             int numChannels = std::max(1, inputs[IN_INPUT].getChannels());
 
+            // all voices in at once, processed in place
+            PolyBuffer voices;
+            voices.read(inputs[IN_INPUT]);
+
             // for each poly channel
             for (int i = 0; i < numChannels; i++) {
 
-                if (speedParam != lastSpeedParam) {
-                    speedChase[i] = pow(speedParam, 4);
-                    speedSpeed = 300 / (fabs(lastSpeed[i] - speedChase[i]) + 1.0);
-                    lastSpeed[i] = speedChase[i];
-                }
-
-                if (depthParam != lastDepthParam) {
-                    depthChase[i] = depthParam;
-                    depthSpeed = 300 / (fabs(lastDepth[i] - depthChase[i]) + 1.0);
-                    lastDepth[i] = depthChase[i];
-                }
-
                 // input
-                inputSample = inputs[IN_INPUT].getPolyVoltage(i);
+                inputSample = voices[i];
 
                 // pad gain
                 inputSample *= gainCut;
 
-                if (quality == HIGH) {
+                if (QUALITY == HIGH) {
                     if (inputSample < 1.2e-38 && -inputSample < 1.2e-38) {
                         static int noisesource = 0;
                         //this declares a variable before anything else is compiled. It won't keep assigning
@@ -206,33 +270,6 @@ struct Tremolo : Module {
 
                 drySample = inputSample;
 
-                speedAmount[i] = (((speedAmount[i] * speedSpeed) + speedChase[i]) / (speedSpeed + 1.0));
-                depthAmount[i] = (((depthAmount[i] * depthSpeed) + depthChase[i]) / (depthSpeed + 1.0));
-                speed = 0.0001 + (speedAmount[i] / 1000.0);
-                speed /= overallscale;
-                depth = 1.0 - pow(1.0 - depthAmount[i], 5);
-                skew = 1.0 + pow(depthAmount[i], 9);
-                density = ((1.0 - depthAmount[i]) * 2.0) - 1.0;
-
-                offset = sin(sweep[i]);
-                sweep[i] += speed;
-                if (sweep[i] > tupi) {
-                    sweep[i] -= tupi;
-                }
-                control = fabs(offset);
-                if (density > 0) {
-                    tempcontrol = sin(control);
-                    control = (control * (1.0 - density)) + (tempcontrol * density);
-                } else {
-                    tempcontrol = 1 - cos(control);
-                    control = (control * (1.0 + density)) + (tempcontrol * -density);
-                }
-                //produce either boosted or starved version of control signal
-                //will go from 0 to 1
-
-                thickness = ((control * 2.0) - 1.0) * skew;
-                out = fabs(thickness);
-
                 //max value for sine function
                 bridgerectifier = fabs(inputSample);
                 if (bridgerectifier > 1.57079633)
@@ -255,11 +292,12 @@ struct Tremolo : Module {
                 //apply tremolo, apply gain boost to compensate for volume loss
                 inputSample = (drySample * (1 - depth)) + (inputSample * depth);
 
-                if (quality == HIGH) {
+                if (QUALITY == HIGH) {
+                    DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
                     //stereo 32 bit dither, made small and tidy.
                     int expon;
                     frexpf((float)inputSample, &expon);
-                    long double dither = (rand() / (RAND_MAX * 7.737125245533627e+25)) * pow(2, expon + 62);
+                    long double dither = (ditherSource.next() / 7.737125245533627e+25) * pow(2, expon + 62);
                     inputSample += (dither - fpNShape[i]);
                     fpNShape[i] = dither;
                 }
@@ -268,12 +306,13 @@ struct Tremolo : Module {
                 inputSample *= gainBoost;
 
                 // output
-                outputs[OUT_OUTPUT].setChannels(numChannels);
-                outputs[OUT_OUTPUT].setVoltage(inputSample, i);
+                voices[i] = inputSample;
             }
 
+            voices.write(outputs[OUT_OUTPUT]);
+
             // lights
-            lights[SPEED_LIGHT].setSmoothBrightness(fmaxf(0.0, (-sweep[0]) + 1), args.sampleTime);
+            lights[SPEED_LIGHT].setSmoothBrightness(fmaxf(0.0, (-sweep) + 1), args.sampleTime);
         }
     }
 };
@@ -318,12 +357,18 @@ struct TremoloWidget : ModuleWidget {
         high->module = module;
         high->quality = 1;
         menu->addChild(high);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
     }
 
     TremoloWidget(Tremolo* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/tremolo_dark.svg")));
+        setPanel(loadArtwork("tremolo_dark.svg"));
 
         // screws
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH * 1.5, 0)));
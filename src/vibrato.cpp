@@ -63,10 +63,12 @@ struct Vibrato : Module {
     float fmDepthParam;
     float invwetParam;
 
+    // lfo state, shared by all voices (the speed and depth CV are monophonic)
+    double sweep;
+    double sweepB;
+
     // state variables (as arrays in order to handle up to 16 polyphonic channels)
-    double p[16][16386]; //this is processed, not raw incoming samples
-    double sweep[16];
-    double sweepB[16];
+    rwlib::DelayBuffer<double, 16386> p[16]; //this is processed, not raw incoming samples
     int gcount[16];
     double airPrev[16];
     double airEven[16];
@@ -77,6 +79,8 @@ struct Vibrato : Module {
 
     // other variables, which do not need to be updated every cycle
     double overallscale;
+    rwlib::SilenceDetector silenceDetector;
+    DspStats dspStats;
     double speed;
     double depth;
     double speedB;
@@ -91,6 +95,11 @@ struct Vibrato : Module {
     // constants
     const double tupi = 3.141592653589793238 * 2.0;
 
+    // process kernel, specialised at compile time for the current quality setting
+    typedef void (Vibrato::*ProcessKernel)(const ProcessArgs& args);
+    ProcessKernel kernel;
+    int kernelQuality;
+
     Vibrato()
     {
         config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -101,6 +110,7 @@ struct Vibrato : Module {
         configParam(INVWET_PARAM, 0.f, 1.f, 0.5f, "Inv/Wet");
 
         quality = loadQuality();
+        kernelQuality = -1;
         onReset();
     }
 
@@ -114,11 +124,10 @@ struct Vibrato : Module {
         lastFmDepthParam = 0.0;
         lastInvwetParam = 0.0;
 
+        sweep = sweepB = 3.141592653589793238 / 2.0;
+
         for (int i = 0; i < 16; i++) {
-            for (int count = 0; count < 16385; count++) {
-                p[i][count] = 0.0;
-            }
-            sweep[i] = sweepB[i] = 3.141592653589793238 / 2.0;
+            p[i].clear();
             gcount[i] = 0;
 
             airPrev[i] = 0.0;
@@ -139,6 +148,9 @@ struct Vibrato : Module {
         overallscale = 1.0;
         overallscale /= 44100.0;
         overallscale *= sampleRate;
+
+        // tail: bounded by the delay buffer
+        silenceDetector.setTail(16386.0, sampleRate);
     }
 
     json_t* dataToJson() override
@@ -159,10 +171,40 @@ struct Vibrato : Module {
             quality = json_integer_value(qualityJ);
     }
 
+    void selectKernel()
+    {
+        kernel = (quality == HIGH) ? &Vibrato::processKernel<HIGH> : &Vibrato::processKernel<ECO>;
+        kernelQuality = quality;
+    }
+
     void process(const ProcessArgs& args) override
+    {
+        DspStats::Block statsBlock(dspStats, this, args); // times this sample while collecting
+
+        // skip the dsp once the inputs have been silent for longer than the tail
+        if (silenceDetector.process(isSilent(inputs[IN_INPUT]) && !outputs[EOC_OUTPUT].isConnected() && !outputs[EOC_FM_OUTPUT].isConnected())) {
+            dspStats.sleep();
+            clearOutputs(outputs);
+            return;
+        }
+
+        if (quality != kernelQuality) {
+            selectKernel();
+        }
+
+        (this->*kernel)(args);
+    }
+
+    template <int QUALITY>
+    void processKernel(const ProcessArgs& args)
     {
         if (outputs[OUT_OUTPUT].isConnected() || outputs[EOC_OUTPUT].isConnected() || outputs[EOC_FM_OUTPUT].isConnected()) {
 
+            // zero a little more of the delay memory left stale by the last reset
+            for (int i = 0; i < 16; i++) {
+                p[i].sweep();
+            }
+
             speedParam = params[SPEED_PARAM].getValue();
             speedParam += inputs[SPEED_CV_INPUT].getVoltage() / 5;
             speedParam = clamp(speedParam, 0.01f, 0.99f);
@@ -203,21 +245,45 @@ struct Vibrato : Module {
                 wet = (invwetParam * 2.0) - 1.0; //note: inv/dry/wet
             }
 
+            // tap offset, once for all voices
+            double offset = depth + (depth * sin(sweep));
+            int offsetInt = (int)floor(offset);
+            double offsetFrac = offset - offsetInt;
+
+            //still scrolling through the samples, remember
+            sweep += (speed + (speedB * sin(sweepB) * depthB));
+            sweepB += speedB;
+            if (sweep > tupi) {
+                sweep -= tupi;
+            }
+            if (sweep < 0.0) {
+                sweep += tupi;
+            } //through zero FM
+            if (sweepB > tupi) {
+                sweepB -= tupi;
+            }
+
             // number of polyphonic channels
             int numChannels = std::max(1, inputs[IN_INPUT].getChannels());
 
+            // all voices in at once, processed in place
+            PolyBuffer voices;
+            voices.read(inputs[IN_INPUT]);
+
             // for each poly channel
             for (int i = 0; i < numChannels; i++) {
 
                 // input
-                long double inputSample = inputs[IN_INPUT].getPolyVoltage(i);
+                long double inputSample = voices[i];
 
                 // pad gain
                 inputSample *= gainCut;
 
-                if (quality == HIGH) {
-                    if (fabs(inputSample) < 1.18e-37)
+                if (QUALITY == HIGH) {
+                    if (fabs(inputSample) < 1.18e-37) {
                         inputSample = fpd[i] * 1.18e-37;
+                        dspStats.denormalGuards++;
+                    }
                 }
 
                 double drySample = inputSample;
@@ -246,29 +312,17 @@ struct Vibrato : Module {
                     gcount[i] = 8192;
                 }
                 int count = gcount[i];
-                p[i][count + 8192] = p[i][count] = inputSample;
+                p[i].write(count, inputSample);
+                p[i].write(count + 8192, inputSample);
 
-                double offset = depth + (depth * sin(sweep[i]));
-                count += (int)floor(offset);
+                count += offsetInt;
 
-                inputSample = p[i][count] * (1.0 - (offset - floor(offset))); //less as value moves away from .0
-                inputSample += p[i][count + 1]; //we can assume always using this in one way or another?
-                inputSample += p[i][count + 2] * (offset - floor(offset)); //greater as value moves away from .0
-                inputSample -= ((p[i][count] - p[i][count + 1]) - (p[i][count + 1] - p[i][count + 2])) / 50.0; //interpolation hacks 'r us
+                inputSample = p[i].read(count) * (1.0 - offsetFrac); //less as value moves away from .0
+                inputSample += p[i].read(count + 1); //we can assume always using this in one way or another?
+                inputSample += p[i].read(count + 2) * offsetFrac; //greater as value moves away from .0
+                inputSample -= ((p[i].read(count) - p[i].read(count + 1)) - (p[i].read(count + 1) - p[i].read(count + 2))) / 50.0; //interpolation hacks 'r us
                 inputSample *= 0.5; // gain trim
 
-                //still scrolling through the samples, remember
-                sweep[i] += (speed + (speedB * sin(sweepB[i]) * depthB));
-                sweepB[i] += speedB;
-                if (sweep[i] > tupi) {
-                    sweep[i] -= tupi;
-                }
-                if (sweep[i] < 0.0) {
-                    sweep[i] += tupi;
-                } //through zero FM
-                if (sweepB[i] > tupi) {
-                    sweepB[i] -= tupi;
-                }
                 gcount[i]--;
 
                 //Inv/Dry/Wet control
@@ -276,7 +330,8 @@ struct Vibrato : Module {
                     inputSample = (inputSample * wet) + (drySample * (1.0 - fabs(wet)));
                 }
 
-                if (quality == HIGH) {
+                if (QUALITY == HIGH) {
+                    DspStats::Section ditherSection(dspStats, dspStats.ditherCycles);
                     //begin 32 bit stereo floating point dither
                     int expon;
                     frexpf((float)inputSample, &expon);
@@ -291,21 +346,22 @@ struct Vibrato : Module {
                 inputSample *= gainBoost;
 
                 // audio output
-                outputs[OUT_OUTPUT].setChannels(numChannels);
-                outputs[OUT_OUTPUT].setVoltage(inputSample, i);
+                voices[i] = inputSample;
             }
 
+            voices.write(outputs[OUT_OUTPUT]);
+
             // triggers
-            if (sweep[0] < 0.1) {
+            if (sweep < 0.1) {
                 eocPulse.trigger(1e-3);
             }
-            if (sweepB[0] < 0.1) {
+            if (sweepB < 0.1) {
                 eocFmPulse.trigger(1e-3);
             }
 
             // lights
-            lights[SPEED_LIGHT].setSmoothBrightness(fmaxf(0.0, (-sweep[0] / 5) + 1), args.sampleTime);
-            lights[SPEED_FM_LIGHT].setSmoothBrightness(fmaxf(0.0, (-sweepB[0] / 5) + 1), args.sampleTime);
+            lights[SPEED_LIGHT].setSmoothBrightness(fmaxf(0.0, (-sweep / 5) + 1), args.sampleTime);
+            lights[SPEED_FM_LIGHT].setSmoothBrightness(fmaxf(0.0, (-sweepB / 5) + 1), args.sampleTime);
 
             // trigger outputs
             outputs[EOC_OUTPUT].setVoltage((eocPulse.process(args.sampleTime) ? 10.0 : 0.0));
@@ -354,12 +410,18 @@ struct VibratoWidget : ModuleWidget {
         high->module = module;
         high->quality = 1;
         menu->addChild(high);
+
+        menu->addChild(new MenuSeparator()); // separator
+
+        DspStatsItem* dspStatsItem = createMenuItem<DspStatsItem>("DSP stats", RIGHT_ARROW);
+        dspStatsItem->stats = &module->dspStats;
+        menu->addChild(dspStatsItem);
     }
 
     VibratoWidget(Vibrato* module)
     {
         setModule(module);
-        setPanel(APP->window->loadSvg(asset::plugin(pluginInstance, "res/vibrato_dark.svg")));
+        setPanel(loadArtwork("vibrato_dark.svg"));
 
         // screws
         addChild(createWidget<ScrewBlack>(Vec(RACK_GRID_WIDTH, 0)));